@@ -0,0 +1,183 @@
+#include "action_log.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string_view>
+
+namespace app {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::string_view MAGIC = "GAMEACTS"sv;
+
+// Значение байта направления, означающее остановку
+constexpr uint8_t STOP_DIRECTION = 4;
+
+enum class RecordType : uint8_t {
+    SEED = 1,
+    JOIN,
+    MOVE,
+    TICK,
+    STATE_HASH,
+};
+
+template <typename... Fns>
+struct Overloaded : Fns... {
+    using Fns::operator()...;
+};
+
+}  // namespace
+
+ActionRecorder::ActionRecorder(std::ostream& out)
+    : out_{out} {
+    out_.write(MAGIC.data(), static_cast<std::streamsize>(MAGIC.size()));
+    WriteVarint(ACTION_LOG_VERSION);
+}
+
+void ActionRecorder::Record(const Action& action) {
+    std::visit(Overloaded{
+                   [this](const SeedAction& seed) {
+                       out_.put(static_cast<char>(RecordType::SEED));
+                       WriteVarint(seed.seed);
+                   },
+                   [this](const JoinAction& join) {
+                       out_.put(static_cast<char>(RecordType::JOIN));
+                       WriteString(*join.map_id);
+                       WriteString(join.dog_name);
+                   },
+                   [this](const MoveAction& move) {
+                       out_.put(static_cast<char>(RecordType::MOVE));
+                       WriteVarint(*move.session_id);
+                       WriteVarint(*move.dog_id);
+                       out_.put(static_cast<char>(move.direction ? static_cast<uint8_t>(*move.direction)
+                                                                 : STOP_DIRECTION));
+                       // Скорость сохраняется побитово, чтобы воспроизведение было точным
+                       WriteFixed64(std::bit_cast<uint64_t>(move.speed));
+                   },
+                   [this](const TickAction& tick) {
+                       out_.put(static_cast<char>(RecordType::TICK));
+                       WriteVarint(static_cast<uint64_t>(tick.delta.count()));
+                   },
+                   [this](const StateHashAction& state_hash) {
+                       out_.put(static_cast<char>(RecordType::STATE_HASH));
+                       WriteVarint(state_hash.hash);
+                   },
+               },
+               action);
+    ++record_count_;
+}
+
+void ActionRecorder::WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+        out_.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out_.put(static_cast<char>(value));
+}
+
+void ActionRecorder::WriteFixed64(uint64_t value) {
+    for (int byte = 0; byte < 8; ++byte) {
+        out_.put(static_cast<char>(value >> (byte * 8)));
+    }
+}
+
+void ActionRecorder::WriteString(const std::string& str) {
+    WriteVarint(str.size());
+    out_.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+ActionReader::ActionReader(std::istream& in)
+    : in_{in} {
+    char magic[MAGIC.size()];
+    if (!in_.read(magic, sizeof(magic)) || std::string_view{magic, sizeof(magic)} != MAGIC) {
+        throw std::runtime_error("Not an action log");
+    }
+    if (const auto version = ReadVarint(); version != ACTION_LOG_VERSION) {
+        throw std::runtime_error("Unsupported action log version "s + std::to_string(version));
+    }
+}
+
+std::optional<Action> ActionReader::Next() {
+    const int type = in_.get();
+    if (type == std::istream::traits_type::eof()) {
+        return std::nullopt;
+    }
+    switch (static_cast<RecordType>(type)) {
+        case RecordType::SEED:
+            return SeedAction{ReadVarint()};
+        case RecordType::JOIN: {
+            JoinAction join;
+            join.map_id = model::Map::Id{ReadString()};
+            join.dog_name = ReadString();
+            return join;
+        }
+        case RecordType::MOVE: {
+            MoveAction move;
+            move.session_id = model::GameSession::Id{static_cast<uint32_t>(ReadVarint())};
+            move.dog_id = model::Dog::Id{static_cast<uint32_t>(ReadVarint())};
+            const uint8_t direction = ReadByte();
+            if (direction > STOP_DIRECTION) {
+                throw std::runtime_error("Invalid direction in action log");
+            }
+            if (direction != STOP_DIRECTION) {
+                move.direction = static_cast<model::Direction>(direction);
+            }
+            move.speed = std::bit_cast<double>(ReadFixed64());
+            return move;
+        }
+        case RecordType::TICK:
+            return TickAction{std::chrono::milliseconds{static_cast<int64_t>(ReadVarint())}};
+        case RecordType::STATE_HASH:
+            return StateHashAction{ReadVarint()};
+    }
+    throw std::runtime_error("Unknown record type in action log");
+}
+
+uint8_t ActionReader::ReadByte() {
+    const int byte = in_.get();
+    if (byte == std::istream::traits_type::eof()) {
+        throw std::runtime_error("Truncated action log");
+    }
+    return static_cast<uint8_t>(byte);
+}
+
+uint64_t ActionReader::ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const uint8_t byte = ReadByte();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Invalid varint in action log");
+}
+
+uint64_t ActionReader::ReadFixed64() {
+    uint64_t value = 0;
+    for (int byte = 0; byte < 8; ++byte) {
+        value |= static_cast<uint64_t>(ReadByte()) << (byte * 8);
+    }
+    return value;
+}
+
+std::string ActionReader::ReadString() {
+    const uint64_t size = ReadVarint();
+    std::string str;
+    // Размер не доверяем заранее: строка растёт по мере чтения
+    constexpr size_t CHUNK = 4096;
+    while (str.size() < size) {
+        const size_t old_size = str.size();
+        const size_t chunk = static_cast<size_t>(std::min<uint64_t>(CHUNK, size - old_size));
+        str.resize(old_size + chunk);
+        if (!in_.read(str.data() + old_size, static_cast<std::streamsize>(chunk))) {
+            throw std::runtime_error("Truncated action log");
+        }
+    }
+    return str;
+}
+
+}  // namespace app
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <variant>
+
+#include "model.h"
+
+/*
+ * Журнал действий игроков для детерминированного воспроизведения симуляции.
+ *
+ * Журнал начинается с заголовка, за которым следуют записи: байт типа и поля
+ * записи. Целые числа хранятся в формате LEB128, поэтому типичная запись
+ * о такте занимает несколько байт, а о перемещении - чуть больше восьми байт
+ * скорости.
+ */
+namespace app {
+
+// Версия формата журнала. Увеличивается при любом изменении раскладки записей
+inline constexpr uint32_t ACTION_LOG_VERSION = 1;
+
+// Начальное состояние генератора случайных чисел симуляции
+struct SeedAction {
+    uint64_t seed = 0;
+};
+
+struct JoinAction {
+    model::Map::Id map_id{std::string{}};
+    std::string dog_name;
+};
+
+// Отсутствие направления означает остановку собаки
+struct MoveAction {
+    model::GameSession::Id session_id{0};
+    model::Dog::Id dog_id{0};
+    std::optional<model::Direction> direction;
+    double speed = 0;
+};
+
+struct TickAction {
+    std::chrono::milliseconds delta{0};
+};
+
+// Хеш состояния игры, с которым сверяется воспроизведение
+struct StateHashAction {
+    uint64_t hash = 0;
+};
+
+using Action = std::variant<SeedAction, JoinAction, MoveAction, TickAction, StateHashAction>;
+
+class ActionRecorder {
+public:
+    // Сразу записывает в out заголовок журнала
+    explicit ActionRecorder(std::ostream& out);
+
+    void Record(const Action& action);
+
+    size_t GetRecordCount() const noexcept {
+        return record_count_;
+    }
+
+private:
+    void WriteVarint(uint64_t value);
+    void WriteFixed64(uint64_t value);
+    void WriteString(const std::string& str);
+
+    std::ostream& out_;
+    size_t record_count_ = 0;
+};
+
+class ActionReader {
+public:
+    // Выбрасывает std::runtime_error, если заголовок журнала неверен
+    explicit ActionReader(std::istream& in);
+
+    // Возвращает nullopt в конце журнала.
+    // Выбрасывает std::runtime_error, если запись повреждена или обрезана
+    std::optional<Action> Next();
+
+private:
+    uint8_t ReadByte();
+    uint64_t ReadVarint();
+    uint64_t ReadFixed64();
+    std::string ReadString();
+
+    std::istream& in_;
+};
+
+}  // namespace app
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace model {
+
+// Номер такта игрового сеанса. Такт 0 - состояние до первого вызова Tick
+using TickNumber = uint64_t;
+
+/*
+ * Журнал изменений однотипных сущностей сеанса.
+ *
+ * Изменённые сущности хранятся в списке, упорядоченном по такту последнего
+ * изменения, поэтому перечисление изменённых после такта since стоит
+ * O(количество изменений), а не O(количество сущностей).
+ * Удаления хранятся ограниченное время (history_ticks тактов). Клиент, который
+ * запрашивает изменения с более раннего такта, должен получить полное состояние.
+ */
+template <typename Id, typename Hasher>
+class ChangeJournal {
+    struct Change {
+        Id id;
+        TickNumber tick;
+        // Порядковый номер изменения в журнале. В отличие от такта,
+        // различается у изменений, сделанных в пределах одного такта
+        uint64_t version;
+    };
+    using Changes = std::list<Change>;
+
+public:
+    explicit ChangeJournal(TickNumber history_ticks) noexcept
+        : history_ticks_{history_ticks} {
+    }
+
+    void MarkChanged(const Id& id, TickNumber tick) {
+        const uint64_t version = ++last_version_;
+        if (auto it = positions_.find(id); it != positions_.end()) {
+            it->second->tick = tick;
+            it->second->version = version;
+            changes_.splice(changes_.end(), changes_, it->second);
+        } else {
+            positions_.emplace(id, changes_.insert(changes_.end(), Change{id, tick, version}));
+        }
+    }
+
+    void MarkRemoved(const Id& id, TickNumber tick) {
+        if (auto it = positions_.find(id); it != positions_.end()) {
+            changes_.erase(it->second);
+            positions_.erase(it);
+        }
+        removals_.push_back(Change{id, tick, ++last_version_});
+    }
+
+    // Забывает удаления, которые вышли за пределы истории
+    void Prune(TickNumber current_tick) {
+        while (!removals_.empty() && removals_.front().tick + history_ticks_ < current_tick) {
+            removals_.pop_front();
+        }
+    }
+
+    // Можно ли построить разницу состояний относительно такта since
+    bool CanDiffSince(TickNumber since, TickNumber current_tick) const noexcept {
+        return since <= current_tick && since + history_ticks_ >= current_tick;
+    }
+
+    // Вызывает fn(id, tick) для сущностей, изменённых после такта since,
+    // начиная с самых свежих изменений
+    template <typename Fn>
+    void ForEachChangedSince(TickNumber since, Fn&& fn) const {
+        for (auto it = changes_.rbegin(); it != changes_.rend() && it->tick > since; ++it) {
+            fn(it->id, it->tick);
+        }
+    }
+
+    // Вызывает fn(id) для сущностей, удалённых после такта since
+    template <typename Fn>
+    void ForEachRemovedSince(TickNumber since, Fn&& fn) const {
+        for (auto it = removals_.rbegin(); it != removals_.rend() && it->tick > since; ++it) {
+            fn(it->id);
+        }
+    }
+
+    // Изменилась ли сущность после такта since
+    bool IsChangedSince(const Id& id, TickNumber since) const {
+        const auto it = positions_.find(id);
+        return it != positions_.end() && it->second->tick > since;
+    }
+
+    // Номер последнего изменения сущности. Позволяет понять, устарело ли
+    // закешированное представление сущности
+    uint64_t GetVersion(const Id& id) const {
+        const auto it = positions_.find(id);
+        return it == positions_.end() ? 0 : it->second->version;
+    }
+
+private:
+    TickNumber history_ticks_;
+    uint64_t last_version_ = 0;
+    Changes changes_;
+    std::unordered_map<Id, typename Changes::iterator, Hasher> positions_;
+    std::deque<Change> removals_;
+};
+
+}  // namespace model
@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace util {
+
+/*
+ * Домен эпох для безопасного освобождения памяти в lock-free структурах.
+ *
+ * Читатель входит в домен (Enter) перед обращением к разделяемым указателям
+ * и выходит из него при разрушении Guard. Вход и выход - это одна атомарная
+ * операция над счётчиком, поэтому читатели никогда не ждут.
+ *
+ * Писатель, отцепив объект от структуры, вызывает Synchronize и после возврата
+ * может удалить объект: все читатели, которые могли его видеть, к этому моменту
+ * покинули домен. Вызовы Synchronize должны быть сериализованы снаружи.
+ */
+class EpochDomain {
+    // Счётчики читателей разнесены по слотам, чтобы потоки не конкурировали
+    // за одну кеш-линию
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> readers[2] = {0, 0};
+    };
+
+    static constexpr size_t SLOT_COUNT = 64;
+
+public:
+    class Guard {
+    public:
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard() {
+            slot_.readers[parity_].fetch_sub(1, std::memory_order_release);
+        }
+
+    private:
+        friend class EpochDomain;
+
+        Guard(Slot& slot, unsigned parity) noexcept
+            : slot_{slot}
+            , parity_{parity} {
+        }
+
+        Slot& slot_;
+        unsigned parity_;
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    [[nodiscard]] Guard Enter() const noexcept {
+        Slot& slot = slots_[ThisThreadSlot()];
+        const auto parity = static_cast<unsigned>(epoch_.load(std::memory_order_acquire) & 1);
+        // seq_cst упорядочивает вход до последующего чтения разделяемых указателей
+        slot.readers[parity].fetch_add(1, std::memory_order_seq_cst);
+        return Guard{slot, parity};
+    }
+
+    // Дожидается, пока все читатели, вошедшие до вызова, покинут домен.
+    // Эпоха переключается дважды: читатель, прочитавший старую эпоху, но ещё не
+    // успевший увеличить счётчик, будет учтён во второй фазе.
+    void Synchronize() noexcept {
+        for (int phase = 0; phase < 2; ++phase) {
+            const auto old_parity = epoch_.fetch_add(1, std::memory_order_seq_cst) & 1;
+            while (CountReaders(old_parity) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    uint64_t CountReaders(uint64_t parity) const noexcept {
+        uint64_t count = 0;
+        for (const Slot& slot : slots_) {
+            count += slot.readers[parity].load(std::memory_order_seq_cst);
+        }
+        return count;
+    }
+
+    static size_t ThisThreadSlot() noexcept {
+        static std::atomic<size_t> next_slot{0};
+        thread_local const size_t slot
+            = next_slot.fetch_add(1, std::memory_order_relaxed) % SLOT_COUNT;
+        return slot;
+    }
+
+    std::atomic<uint64_t> epoch_{0};
+    mutable std::array<Slot, SLOT_COUNT> slots_;
+};
+
+}  // namespace util
@@ -0,0 +1,235 @@
+#include "game_cache.h"
+
+#include <bit>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace game_cache {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::string_view MAGIC = "GAMECACH"sv;
+
+// Формат хранит числа в порядке байтов little-endian и читает их без преобразований
+static_assert(std::endian::native == std::endian::little);
+
+class Writer {
+public:
+    explicit Writer(std::ostream& out)
+        : out_{out} {
+    }
+
+    template <typename T>
+    void Write(T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out_.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void Write(std::string_view str) {
+        Write(static_cast<uint32_t>(str.size()));
+        out_.write(str.data(), static_cast<std::streamsize>(str.size()));
+    }
+
+    void Write(model::Point point) {
+        Write(static_cast<int32_t>(point.x));
+        Write(static_cast<int32_t>(point.y));
+    }
+
+private:
+    std::ostream& out_;
+};
+
+class Reader {
+public:
+    Reader(const char* data, size_t size) noexcept
+        : data_{data}
+        , size_{size} {
+    }
+
+    template <typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string ReadString() {
+        const auto size = Read<uint32_t>();
+        return std::string(Take(size), size);
+    }
+
+    model::Point ReadPoint() {
+        const auto x = Read<int32_t>();
+        const auto y = Read<int32_t>();
+        return {x, y};
+    }
+
+    bool AtEnd() const noexcept {
+        return offset_ == size_;
+    }
+
+private:
+    const char* Take(size_t count) {
+        if (size_ - offset_ < count) {
+            throw std::out_of_range("Unexpected end of cache");
+        }
+        return data_ + std::exchange(offset_, offset_ + count);
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+void WriteMap(Writer& writer, const model::Map& map) {
+    writer.Write(std::string_view{*map.GetId()});
+    writer.Write(std::string_view{map.GetName()});
+
+    writer.Write(static_cast<uint64_t>(map.GetRoads().size()));
+    for (const auto& road : map.GetRoads()) {
+        writer.Write(road.GetStart());
+        writer.Write(road.GetEnd());
+    }
+
+    writer.Write(static_cast<uint64_t>(map.GetBuildings().size()));
+    for (const auto& building : map.GetBuildings()) {
+        const auto& bounds = building.GetBounds();
+        writer.Write(bounds.position);
+        writer.Write(static_cast<int32_t>(bounds.size.width));
+        writer.Write(static_cast<int32_t>(bounds.size.height));
+    }
+
+    writer.Write(static_cast<uint64_t>(map.GetOffices().size()));
+    for (const auto& office : map.GetOffices()) {
+        writer.Write(std::string_view{*office.GetId()});
+        writer.Write(office.GetPosition());
+        writer.Write(static_cast<int32_t>(office.GetOffset().dx));
+        writer.Write(static_cast<int32_t>(office.GetOffset().dy));
+    }
+}
+
+model::Map ReadMap(Reader& reader) {
+    model::Map::Id id{reader.ReadString()};
+    model::Map map{std::move(id), reader.ReadString()};
+
+    for (auto count = reader.Read<uint64_t>(); count > 0; --count) {
+        const auto start = reader.ReadPoint();
+        const auto end = reader.ReadPoint();
+        if (start.y == end.y) {
+            map.AddRoad(model::Road{model::Road::HORIZONTAL, start, end.x});
+        } else {
+            map.AddRoad(model::Road{model::Road::VERTICAL, start, end.y});
+        }
+    }
+
+    for (auto count = reader.Read<uint64_t>(); count > 0; --count) {
+        const auto position = reader.ReadPoint();
+        const auto width = reader.Read<int32_t>();
+        const auto height = reader.Read<int32_t>();
+        map.AddBuilding(model::Building{model::Rectangle{position, {width, height}}});
+    }
+
+    for (auto count = reader.Read<uint64_t>(); count > 0; --count) {
+        model::Office::Id office_id{reader.ReadString()};
+        const auto position = reader.ReadPoint();
+        const auto dx = reader.Read<int32_t>();
+        const auto dy = reader.Read<int32_t>();
+        map.AddOffice(model::Office{std::move(office_id), position, {dx, dy}});
+    }
+
+    return map;
+}
+
+}  // namespace
+
+SourceStamp SourceStamp::Of(const std::filesystem::path& source) {
+    return {static_cast<uint64_t>(std::filesystem::file_size(source)),
+            static_cast<int64_t>(
+                std::filesystem::last_write_time(source).time_since_epoch().count())};
+}
+
+bool Save(const model::Game& game, const std::filesystem::path& cache_path,
+          const SourceStamp& source) noexcept {
+    // Кеш пишется во временный файл и атомарно подменяет старый,
+    // чтобы параллельно стартующий сервер не прочитал его наполовину
+    auto temp_path = cache_path;
+    temp_path += ".tmp"sv;
+    try {
+        {
+            std::ofstream out{temp_path, std::ios::binary | std::ios::trunc};
+            out.exceptions(std::ios::failbit | std::ios::badbit);
+            Writer writer{out};
+            out.write(MAGIC.data(), MAGIC.size());
+            writer.Write(FORMAT_VERSION);
+            writer.Write(source.size);
+            writer.Write(source.modification_time);
+            writer.Write(static_cast<uint64_t>(game.GetMaxPlayersPerSession()));
+            // Отсутствующий радиус видимости записывается как 0
+            writer.Write(game.GetVisibilityRadius().value_or(0.0));
+            writer.Write(static_cast<uint64_t>(game.GetMaps().size()));
+            for (const auto& map : game.GetMaps()) {
+                WriteMap(writer, map);
+            }
+        }
+        std::filesystem::rename(temp_path, cache_path);
+        return true;
+    } catch (const std::exception&) {
+        std::error_code ec;
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+}
+
+std::optional<model::Game> Load(const std::filesystem::path& cache_path,
+                                const SourceStamp& source) {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(cache_path, ec)
+        || std::filesystem::file_size(cache_path, ec) < MAGIC.size()) {
+        return std::nullopt;
+    }
+
+    try {
+        boost::iostreams::mapped_file_source file{cache_path.string()};
+        if (std::string_view{file.data(), MAGIC.size()} != MAGIC) {
+            return std::nullopt;
+        }
+        Reader reader{file.data() + MAGIC.size(), file.size() - MAGIC.size()};
+        if (reader.Read<uint32_t>() != FORMAT_VERSION) {
+            return std::nullopt;
+        }
+        SourceStamp stamp;
+        stamp.size = reader.Read<uint64_t>();
+        stamp.modification_time = reader.Read<int64_t>();
+        if (stamp != source) {
+            return std::nullopt;
+        }
+
+        model::Game game;
+        game.SetMaxPlayersPerSession(static_cast<size_t>(reader.Read<uint64_t>()));
+        if (const auto radius = reader.Read<double>(); radius > 0) {
+            game.SetVisibilityRadius(radius);
+        }
+        for (auto count = reader.Read<uint64_t>(); count > 0; --count) {
+            game.AddMap(ReadMap(reader));
+        }
+        if (!reader.AtEnd()) {
+            return std::nullopt;
+        }
+        return game;
+    } catch (const std::exception&) {
+        // Повреждённый кеш не ошибка: игра будет загружена из JSON
+        return std::nullopt;
+    }
+}
+
+}  // namespace game_cache
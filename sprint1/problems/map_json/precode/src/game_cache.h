@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include "model.h"
+
+/*
+ * Бинарный кеш скомпилированной модели игры.
+ * Позволяет при повторном запуске загрузить карты одним отображением файла
+ * в память, минуя разбор JSON.
+ */
+namespace game_cache {
+
+// Версия формата. Увеличивается при любом изменении раскладки файла
+inline constexpr uint32_t FORMAT_VERSION = 2;
+
+// Идентифицирует версию исходного файла конфигурации
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t modification_time = 0;
+
+    static SourceStamp Of(const std::filesystem::path& source);
+
+    auto operator<=>(const SourceStamp&) const = default;
+};
+
+// Возвращает false, если записать кеш не удалось
+bool Save(const model::Game& game, const std::filesystem::path& cache_path,
+          const SourceStamp& source) noexcept;
+
+// Возвращает nullopt, если кеш отсутствует, повреждён, имеет другую версию формата
+// или построен по другой версии исходного файла
+std::optional<model::Game> Load(const std::filesystem::path& cache_path,
+                                const SourceStamp& source);
+
+}  // namespace game_cache
@@ -0,0 +1,340 @@
+#include "game_state_view.h"
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+#include <vector>
+
+namespace app {
+
+using namespace std::literals;
+
+namespace {
+
+void AppendNumber(std::string& out, double value) {
+    char buffer[32];
+    const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void AppendNumber(std::string& out, uint64_t value) {
+    char buffer[24];
+    const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void AppendPoint(std::string& out, double x, double y) {
+    out += '[';
+    AppendNumber(out, x);
+    out += ',';
+    AppendNumber(out, y);
+    out += ']';
+}
+
+std::string_view DirectionToString(model::Direction direction) noexcept {
+    switch (direction) {
+        case model::Direction::NORTH:
+            return "U"sv;
+        case model::Direction::SOUTH:
+            return "D"sv;
+        case model::Direction::WEST:
+            return "L"sv;
+        case model::Direction::EAST:
+            return "R"sv;
+    }
+    return ""sv;
+}
+
+// Дописывает в out JSON-объект, составленный из фрагментов "<id>":{...}
+template <typename Fragments>
+void AppendObject(std::string& out, std::string_view name, const Fragments& fragments) {
+    out += '"';
+    out += name;
+    out += "\":{"sv;
+    bool first = true;
+    for (const std::string* fragment : fragments) {
+        if (!std::exchange(first, false)) {
+            out += ',';
+        }
+        out += *fragment;
+    }
+    out += '}';
+}
+
+template <typename Ids>
+void AppendIdArray(std::string& out, std::string_view name, const Ids& ids) {
+    out += '"';
+    out += name;
+    out += "\":["sv;
+    bool first = true;
+    for (const uint32_t id : ids) {
+        if (!std::exchange(first, false)) {
+            out += ',';
+        }
+        AppendNumber(out, uint64_t{id});
+    }
+    out += ']';
+}
+
+// Возвращает по возрастанию идентификаторы сущностей сетки внутри области
+template <typename Grid>
+std::vector<uint32_t> FindInArea(const Grid& grid, const AreaOfInterest& area) {
+    std::vector<uint32_t> ids;
+    grid.ForEachInRadius(area.center, area.radius, [&ids](const auto& id, auto) {
+        ids.push_back(*id);
+    });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+/*
+ * Сравнивает сущности, видимые сейчас (current), с известными клиенту (known).
+ * Оба списка упорядочены по возрастанию. Вызывает on_visible для сущностей,
+ * которых клиент не видел или которые изменились, и on_hidden для сущностей,
+ * пропавших из области
+ */
+template <typename IsChanged, typename OnVisible, typename OnHidden>
+void DiffVisible(const std::vector<uint32_t>& known, const std::vector<uint32_t>& current,
+                 IsChanged&& is_changed, OnVisible&& on_visible, OnHidden&& on_hidden) {
+    size_t i = 0;
+    size_t j = 0;
+    while (i < known.size() || j < current.size()) {
+        if (j == current.size() || (i < known.size() && known[i] < current[j])) {
+            on_hidden(known[i++]);
+        } else if (i == known.size() || current[j] < known[i]) {
+            on_visible(current[j++]);
+        } else {
+            if (is_changed(current[j])) {
+                on_visible(current[j]);
+            }
+            ++i;
+            ++j;
+        }
+    }
+}
+
+}  // namespace
+
+std::string SessionStateView::Render(std::optional<model::TickNumber> since) {
+    const model::TickNumber tick = session_.GetTick();
+    const bool full = !since
+        || !session_.GetDogJournal().CanDiffSince(*since, tick)
+        || !session_.GetLostObjectJournal().CanDiffSince(*since, tick);
+
+    std::string out;
+    out += "{\"tick\":"sv;
+    AppendNumber(out, tick);
+    out += full ? ",\"full\":true,"sv : ",\"full\":false,"sv;
+    if (full) {
+        RenderFull(out);
+    } else {
+        RenderDiff(out, *since);
+    }
+    out += '}';
+    return out;
+}
+
+std::string SessionStateView::Render(std::optional<model::TickNumber> since, const AreaOfInterest& area,
+                                     ViewerState& viewer) {
+    const model::TickNumber tick = session_.GetTick();
+    // Разница строится относительно того, что клиент получил в прошлый раз.
+    // Если он запрашивает её с другого такта, его состояние неизвестно
+    const bool full = !since || viewer.tick != since;
+
+    std::string out;
+    out += "{\"tick\":"sv;
+    AppendNumber(out, tick);
+    out += full ? ",\"full\":true,"sv : ",\"full\":false,"sv;
+    RenderArea(out, full ? std::nullopt : since, area, viewer);
+    out += '}';
+    viewer.tick = tick;
+    return out;
+}
+
+std::string SessionStateView::RenderFor(std::optional<model::TickNumber> since, model::Dog::Id dog,
+                                        ViewerState& viewer) {
+    const auto& radius = session_.GetVisibilityRadius();
+    if (!radius) {
+        viewer = ViewerState{};
+        return Render(since);
+    }
+    return Render(since, AreaOfInterest{session_.GetDogs().at(dog).GetPosition(), *radius}, viewer);
+}
+
+void SessionStateView::RenderFull(std::string& out) {
+    std::vector<const std::string*> fragments;
+    fragments.reserve(session_.GetDogs().size());
+    for (const auto& [id, dog] : session_.GetDogs()) {
+        fragments.push_back(&GetDogFragment(dog));
+    }
+    AppendObject(out, "players"sv, fragments);
+    out += ',';
+
+    fragments.clear();
+    fragments.reserve(session_.GetLostObjects().size());
+    for (const auto& [id, object] : session_.GetLostObjects()) {
+        fragments.push_back(&GetLostObjectFragment(object));
+    }
+    AppendObject(out, "lostObjects"sv, fragments);
+
+    PruneFragments();
+}
+
+void SessionStateView::RenderDiff(std::string& out, model::TickNumber since) {
+    std::vector<const std::string*> fragments;
+    std::vector<uint32_t> removed;
+
+    session_.GetDogJournal().ForEachChangedSince(since, [&](const model::Dog::Id& id, auto) {
+        fragments.push_back(&GetDogFragment(session_.GetDogs().at(id)));
+    });
+    AppendObject(out, "players"sv, fragments);
+    out += ',';
+    session_.GetDogJournal().ForEachRemovedSince(since, [&](const model::Dog::Id& id) {
+        removed.push_back(*id);
+        dog_fragments_.erase(*id);
+    });
+    AppendIdArray(out, "removedPlayers"sv, removed);
+    out += ',';
+
+    fragments.clear();
+    removed.clear();
+    session_.GetLostObjectJournal().ForEachChangedSince(
+        since, [&](const model::LostObject::Id& id, auto) {
+            fragments.push_back(&GetLostObjectFragment(session_.GetLostObjects().at(id)));
+        });
+    AppendObject(out, "lostObjects"sv, fragments);
+    out += ',';
+    session_.GetLostObjectJournal().ForEachRemovedSince(
+        since, [&](const model::LostObject::Id& id) {
+            removed.push_back(*id);
+            lost_object_fragments_.erase(*id);
+        });
+    AppendIdArray(out, "removedLostObjects"sv, removed);
+}
+
+void SessionStateView::RenderArea(std::string& out, std::optional<model::TickNumber> since,
+                                  const AreaOfInterest& area, ViewerState& viewer) {
+    // Для полного состояния клиент считается ничего не видевшим
+    const std::vector<uint32_t> nothing;
+    std::vector<const std::string*> fragments;
+    std::vector<uint32_t> removed;
+
+    std::vector<uint32_t> dogs = FindInArea(session_.GetDogGrid(), area);
+    DiffVisible(
+        since ? viewer.dogs : nothing, dogs,
+        [&](uint32_t id) {
+            return session_.GetDogJournal().IsChangedSince(model::Dog::Id{id}, *since);
+        },
+        [&](uint32_t id) {
+            fragments.push_back(&GetDogFragment(session_.GetDogs().at(model::Dog::Id{id})));
+        },
+        [&removed](uint32_t id) {
+            removed.push_back(id);
+        });
+    AppendObject(out, "players"sv, fragments);
+    out += ',';
+    if (since) {
+        AppendIdArray(out, "removedPlayers"sv, removed);
+        out += ',';
+    }
+
+    fragments.clear();
+    removed.clear();
+    std::vector<uint32_t> lost_objects = FindInArea(session_.GetLostObjectGrid(), area);
+    DiffVisible(
+        since ? viewer.lost_objects : nothing, lost_objects,
+        [&](uint32_t id) {
+            return session_.GetLostObjectJournal().IsChangedSince(model::LostObject::Id{id}, *since);
+        },
+        [&](uint32_t id) {
+            fragments.push_back(&GetLostObjectFragment(session_.GetLostObjects().at(model::LostObject::Id{id})));
+        },
+        [&removed](uint32_t id) {
+            removed.push_back(id);
+        });
+    AppendObject(out, "lostObjects"sv, fragments);
+    if (since) {
+        out += ',';
+        AppendIdArray(out, "removedLostObjects"sv, removed);
+    }
+
+    viewer.dogs = std::move(dogs);
+    viewer.lost_objects = std::move(lost_objects);
+    PruneFragments();
+}
+
+void SessionStateView::PruneFragments() {
+    // Кеш не должен расти из-за удалённых сущностей
+    if (dog_fragments_.size() > session_.GetDogs().size()) {
+        std::erase_if(dog_fragments_, [this](const auto& item) {
+            return !session_.GetDogs().contains(model::Dog::Id{item.first});
+        });
+    }
+    if (lost_object_fragments_.size() > session_.GetLostObjects().size()) {
+        std::erase_if(lost_object_fragments_, [this](const auto& item) {
+            return !session_.GetLostObjects().contains(model::LostObject::Id{item.first});
+        });
+    }
+}
+
+const std::string& SessionStateView::GetDogFragment(const model::Dog& dog) {
+    const uint64_t version = session_.GetDogJournal().GetVersion(dog.GetId());
+    Fragment& fragment = dog_fragments_[*dog.GetId()];
+    if (fragment.version != version || fragment.json.empty()) {
+        std::string& json = fragment.json;
+        json.clear();
+        json += '"';
+        AppendNumber(json, uint64_t{*dog.GetId()});
+        json += "\":{\"pos\":"sv;
+        AppendPoint(json, dog.GetPosition().x, dog.GetPosition().y);
+        json += ",\"speed\":"sv;
+        AppendPoint(json, dog.GetSpeed().x, dog.GetSpeed().y);
+        json += ",\"dir\":\""sv;
+        json += DirectionToString(dog.GetDirection());
+        json += "\"}"sv;
+        fragment.version = version;
+    }
+    return fragment.json;
+}
+
+const std::string& SessionStateView::GetLostObjectFragment(const model::LostObject& object) {
+    const uint64_t version = session_.GetLostObjectJournal().GetVersion(object.id);
+    Fragment& fragment = lost_object_fragments_[*object.id];
+    if (fragment.version != version || fragment.json.empty()) {
+        std::string& json = fragment.json;
+        json.clear();
+        json += '"';
+        AppendNumber(json, uint64_t{*object.id});
+        json += "\":{\"type\":"sv;
+        AppendNumber(json, uint64_t{object.type});
+        json += ",\"pos\":"sv;
+        AppendPoint(json, object.position.x, object.position.y);
+        json += '}';
+        fragment.version = version;
+    }
+    return fragment.json;
+}
+
+std::optional<model::TickNumber> ParseSinceTick(std::string_view query) noexcept {
+    constexpr auto key = "since="sv;
+    while (!query.empty()) {
+        const auto end = query.find('&');
+        const auto param = query.substr(0, end);
+        if (param.starts_with(key)) {
+            const auto value = param.substr(key.size());
+            model::TickNumber tick = 0;
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), tick);
+            if (ec != std::errc{} || ptr != value.data() + value.size() || value.empty()) {
+                return std::nullopt;
+            }
+            return tick;
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        query.remove_prefix(end + 1);
+    }
+    return std::nullopt;
+}
+
+}  // namespace app
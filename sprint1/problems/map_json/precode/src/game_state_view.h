@@ -0,0 +1,94 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "model.h"
+
+namespace app {
+
+// Область видимости игрока: круг вокруг его собаки
+struct AreaOfInterest {
+    geom::Point2D center;
+    double radius = 0;
+
+    bool Contains(geom::Point2D point) const noexcept {
+        const double dx = point.x - center.x;
+        const double dy = point.y - center.y;
+        return dx * dx + dy * dy <= radius * radius;
+    }
+};
+
+// Сущности, которые клиент получил в последнем ответе с областью видимости.
+// Хранится отдельно для каждого клиента
+struct ViewerState {
+    // Такт последнего ответа. nullopt - клиент ещё не получал состояние области
+    std::optional<model::TickNumber> tick;
+    // Идентификаторы видимых сущностей по возрастанию
+    std::vector<uint32_t> dogs;
+    std::vector<uint32_t> lost_objects;
+};
+
+/*
+ * Формирует тело ответа /api/v1/game/state для одного игрового сеанса.
+ *
+ * Полное состояние содержит всех собак и все предметы. Разница с такта since
+ * содержит только сущности, изменённые после него, и идентификаторы удалённых.
+ * Если такт since слишком старый, вместо разницы возвращается полное состояние
+ * с признаком "full": true.
+ *
+ * С областью видимости в ответ попадают только сущности внутри неё. Разница
+ * строится относительно того, что клиент получил в прошлый раз (ViewerState):
+ * сущность, оказавшаяся в области, присылается, даже если не менялась,
+ * а покинувшая область - попадает в список удалённых. Сущности ищутся по сетке
+ * сеанса, поэтому стоимость ответа зависит от числа видимых сущностей,
+ * а не от всех в сеансе.
+ *
+ * JSON-представление каждой сущности кешируется и перестраивается, только когда
+ * сущность изменилась. Методы должны вызываться на strand сеанса.
+ */
+class SessionStateView {
+public:
+    explicit SessionStateView(const model::GameSession& session) noexcept
+        : session_{session} {
+    }
+
+    // Состояние всей карты
+    std::string Render(std::optional<model::TickNumber> since = std::nullopt);
+
+    // Состояние области area. Разница строится, только если since совпадает
+    // с тактом предыдущего ответа этому клиенту, иначе возвращается полное
+    // состояние области. viewer обновляется по содержимому ответа
+    std::string Render(std::optional<model::TickNumber> since, const AreaOfInterest& area, ViewerState& viewer);
+
+    // Состояние области видимости собаки dog с радиусом GameSession::GetVisibilityRadius.
+    // Если радиус не задан, возвращается состояние всей карты
+    std::string RenderFor(std::optional<model::TickNumber> since, model::Dog::Id dog, ViewerState& viewer);
+
+private:
+    struct Fragment {
+        uint64_t version = 0;
+        std::string json;
+    };
+
+    void RenderFull(std::string& out);
+    void RenderDiff(std::string& out, model::TickNumber since);
+    void RenderArea(std::string& out, std::optional<model::TickNumber> since, const AreaOfInterest& area,
+                    ViewerState& viewer);
+    // Удаляет из кеша представления удалённых сущностей
+    void PruneFragments();
+
+    const std::string& GetDogFragment(const model::Dog& dog);
+    const std::string& GetLostObjectFragment(const model::LostObject& object);
+
+    const model::GameSession& session_;
+    std::unordered_map<uint32_t, Fragment> dog_fragments_;
+    std::unordered_map<uint32_t, Fragment> lost_object_fragments_;
+};
+
+// Извлекает значение параметра since из строки запроса вида "since=42&..."
+std::optional<model::TickNumber> ParseSinceTick(std::string_view query) noexcept;
+
+}  // namespace app
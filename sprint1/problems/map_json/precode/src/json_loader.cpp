@@ -1,13 +1,382 @@
 #include "json_loader.h"
 
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/json/basic_parser_impl.hpp>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "game_cache.h"
+
 namespace json_loader {
 
+namespace json = boost::json;
+using namespace std::literals;
+
+namespace {
+
+/*
+ * Обработчик событий json::basic_parser, который строит объекты модели прямо
+ * по ходу разбора, не создавая промежуточного DOM-дерева.
+ * Неизвестные ключи и вложенные в них значения пропускаются.
+ */
+class GameConfigHandler {
+    enum class Context {
+        ROOT,
+        MAPS,
+        MAP,
+        ROADS,
+        ROAD,
+        BUILDINGS,
+        BUILDING,
+        OFFICES,
+        OFFICE,
+        SKIPPED,
+    };
+
+    // Поля дороги, здания или офиса, которые прочитаны из текущего JSON-объекта
+    struct ElementFields {
+        std::optional<int> x0, y0, x1, y1;
+        std::optional<int> x, y, w, h;
+        std::optional<int> offset_x, offset_y;
+        std::optional<std::string> id;
+
+        std::optional<int>* FindIntField(std::string_view key) noexcept {
+            static constexpr std::pair<std::string_view, std::optional<int> ElementFields::*>
+                FIELDS[] = {
+                    {"x0"sv, &ElementFields::x0},
+                    {"y0"sv, &ElementFields::y0},
+                    {"x1"sv, &ElementFields::x1},
+                    {"y1"sv, &ElementFields::y1},
+                    {"x"sv, &ElementFields::x},
+                    {"y"sv, &ElementFields::y},
+                    {"w"sv, &ElementFields::w},
+                    {"h"sv, &ElementFields::h},
+                    {"offsetX"sv, &ElementFields::offset_x},
+                    {"offsetY"sv, &ElementFields::offset_y},
+                };
+            for (const auto& [name, field] : FIELDS) {
+                if (name == key) {
+                    return &(this->*field);
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    struct MapFields {
+        std::optional<std::string> id;
+        std::optional<std::string> name;
+        std::vector<model::Road> roads;
+        std::vector<model::Building> buildings;
+        std::vector<model::Office> offices;
+    };
+
+public:
+    constexpr static std::size_t max_object_size = std::size_t(-1);
+    constexpr static std::size_t max_array_size = std::size_t(-1);
+    constexpr static std::size_t max_key_size = std::size_t(-1);
+    constexpr static std::size_t max_string_size = std::size_t(-1);
+
+    model::Game& GetGame() noexcept {
+        return game_;
+    }
+
+    // Исключение, выброшенное при построении модели во время разбора
+    std::exception_ptr GetError() const noexcept {
+        return error_;
+    }
+
+    bool on_document_begin(json::error_code&) {
+        return true;
+    }
+
+    bool on_document_end(json::error_code&) {
+        return true;
+    }
+
+    bool on_object_begin(json::error_code&) {
+        if (stack_.empty()) {
+            stack_.push_back(Context::ROOT);
+            return true;
+        }
+        switch (stack_.back()) {
+            case Context::MAPS:
+                map_ = MapFields{};
+                stack_.push_back(Context::MAP);
+                break;
+            case Context::ROADS:
+                element_ = ElementFields{};
+                stack_.push_back(Context::ROAD);
+                break;
+            case Context::BUILDINGS:
+                element_ = ElementFields{};
+                stack_.push_back(Context::BUILDING);
+                break;
+            case Context::OFFICES:
+                element_ = ElementFields{};
+                stack_.push_back(Context::OFFICE);
+                break;
+            default:
+                stack_.push_back(Context::SKIPPED);
+        }
+        return true;
+    }
+
+    bool on_object_end(std::size_t, json::error_code& ec) {
+        const Context context = stack_.back();
+        stack_.pop_back();
+        return Guarded(ec, [this, context] {
+            switch (context) {
+                case Context::MAP:
+                    game_.AddMap(BuildMap());
+                    break;
+                case Context::ROAD:
+                    map_.roads.push_back(BuildRoad());
+                    break;
+                case Context::BUILDING:
+                    map_.buildings.push_back(BuildBuilding());
+                    break;
+                case Context::OFFICE:
+                    map_.offices.push_back(BuildOffice());
+                    break;
+                default:
+                    break;
+            }
+        });
+    }
+
+    bool on_array_begin(json::error_code&) {
+        Context context = Context::SKIPPED;
+        if (!stack_.empty() && stack_.back() == Context::ROOT && key_ == "maps"sv) {
+            context = Context::MAPS;
+        } else if (!stack_.empty() && stack_.back() == Context::MAP) {
+            if (key_ == "roads"sv) {
+                context = Context::ROADS;
+            } else if (key_ == "buildings"sv) {
+                context = Context::BUILDINGS;
+            } else if (key_ == "offices"sv) {
+                context = Context::OFFICES;
+            }
+        }
+        stack_.push_back(context);
+        return true;
+    }
+
+    bool on_array_end(std::size_t, json::error_code&) {
+        stack_.pop_back();
+        return true;
+    }
+
+    bool on_key_part(json::string_view s, std::size_t, json::error_code&) {
+        key_buffer_.append(s.data(), s.size());
+        return true;
+    }
+
+    bool on_key(json::string_view s, std::size_t, json::error_code&) {
+        key_buffer_.append(s.data(), s.size());
+        key_.swap(key_buffer_);
+        key_buffer_.clear();
+        return true;
+    }
+
+    bool on_string_part(json::string_view s, std::size_t, json::error_code&) {
+        string_buffer_.append(s.data(), s.size());
+        return true;
+    }
+
+    bool on_string(json::string_view s, std::size_t, json::error_code&) {
+        string_buffer_.append(s.data(), s.size());
+        if (IsIn(Context::MAP) && (key_ == "id"sv || key_ == "name"sv)) {
+            (key_ == "id"sv ? map_.id : map_.name) = string_buffer_;
+        } else if (IsIn(Context::OFFICE) && key_ == "id"sv) {
+            element_.id = string_buffer_;
+        }
+        string_buffer_.clear();
+        return true;
+    }
+
+    bool on_number_part(json::string_view, json::error_code&) {
+        return true;
+    }
+
+    bool on_int64(std::int64_t value, json::string_view, json::error_code& ec) {
+        return Guarded(ec, [this, value] {
+            OnInteger(value);
+        });
+    }
+
+    bool on_uint64(std::uint64_t value, json::string_view, json::error_code& ec) {
+        return Guarded(ec, [this, value] {
+            if (value > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                throw std::out_of_range("Integer value is out of range");
+            }
+            OnInteger(static_cast<std::int64_t>(value));
+        });
+    }
+
+    bool on_double(double value, json::string_view, json::error_code& ec) {
+        return Guarded(ec, [this, value] {
+            OnReal(value);
+        });
+    }
+
+    bool on_bool(bool, json::error_code&) {
+        return true;
+    }
+
+    bool on_null(json::error_code&) {
+        return true;
+    }
+
+    bool on_comment_part(json::string_view, json::error_code&) {
+        return true;
+    }
+
+    bool on_comment(json::string_view, json::error_code&) {
+        return true;
+    }
+
+private:
+    bool IsIn(Context context) const noexcept {
+        return !stack_.empty() && stack_.back() == context;
+    }
+
+    void OnReal(double value) {
+        if (IsIn(Context::ROOT) && key_ == "visibilityRadius"sv) {
+            if (!(value > 0)) {
+                throw std::out_of_range("visibilityRadius must be positive");
+            }
+            game_.SetVisibilityRadius(value);
+        }
+    }
+
+    void OnInteger(std::int64_t value) {
+        if (IsIn(Context::ROOT) && key_ == "visibilityRadius"sv) {
+            OnReal(static_cast<double>(value));
+        } else if (IsIn(Context::ROOT) && key_ == "maxPlayersPerSession"sv) {
+            if (value < 0) {
+                throw std::out_of_range("maxPlayersPerSession must not be negative");
+            }
+            game_.SetMaxPlayersPerSession(static_cast<size_t>(value));
+        } else if (IsIn(Context::ROAD) || IsIn(Context::BUILDING) || IsIn(Context::OFFICE)) {
+            if (auto* field = element_.FindIntField(key_)) {
+                if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+                    throw std::out_of_range("Coordinate is out of range");
+                }
+                *field = static_cast<int>(value);
+            }
+        }
+    }
+
+    template <typename Fn>
+    bool Guarded(json::error_code& ec, Fn&& fn) {
+        try {
+            fn();
+            return true;
+        } catch (...) {
+            error_ = std::current_exception();
+            ec = json::error::exception;
+            return false;
+        }
+    }
+
+    template <typename T>
+    static T Required(const std::optional<T>& field, std::string_view what) {
+        if (!field) {
+            throw std::runtime_error("Missing "s + std::string{what});
+        }
+        return *field;
+    }
+
+    model::Road BuildRoad() const {
+        const model::Point start{Required(element_.x0, "road x0"sv),
+                                 Required(element_.y0, "road y0"sv)};
+        if (element_.x1) {
+            return model::Road{model::Road::HORIZONTAL, start, *element_.x1};
+        }
+        return model::Road{model::Road::VERTICAL, start, Required(element_.y1, "road y1"sv)};
+    }
+
+    model::Building BuildBuilding() const {
+        return model::Building{model::Rectangle{
+            {Required(element_.x, "building x"sv), Required(element_.y, "building y"sv)},
+            {Required(element_.w, "building w"sv), Required(element_.h, "building h"sv)}}};
+    }
+
+    model::Office BuildOffice() const {
+        return model::Office{
+            model::Office::Id{Required(element_.id, "office id"sv)},
+            {Required(element_.x, "office x"sv), Required(element_.y, "office y"sv)},
+            {Required(element_.offset_x, "office offsetX"sv),
+             Required(element_.offset_y, "office offsetY"sv)}};
+    }
+
+    model::Map BuildMap() {
+        model::Map map{model::Map::Id{Required(map_.id, "map id"sv)},
+                       Required(map_.name, "map name"sv)};
+        for (const auto& road : map_.roads) {
+            map.AddRoad(road);
+        }
+        for (const auto& building : map_.buildings) {
+            map.AddBuilding(building);
+        }
+        for (auto& office : map_.offices) {
+            map.AddOffice(std::move(office));
+        }
+        map_ = MapFields{};
+        return map;
+    }
+
+    model::Game game_;
+    std::exception_ptr error_;
+
+    std::vector<Context> stack_;
+    std::string key_;
+    std::string key_buffer_;
+    std::string string_buffer_;
+    MapFields map_;
+    ElementFields element_;
+};
+
+}  // namespace
+
 model::Game LoadGame(const std::filesystem::path& json_path) {
-    // Загрузить содержимое файла json_path, например, в виде строки
-    // Распарсить строку как JSON, используя boost::json::parse
-    // Загрузить модель игры из файла
-    model::Game game;
+    // Файл отображается в память, а парсер читает его напрямую, без копирования в строку
+    boost::iostreams::mapped_file_source file{json_path.string()};
+
+    json::basic_parser<GameConfigHandler> parser{json::parse_options{}};
+    json::error_code ec;
+    const size_t consumed = parser.write_some(false, file.data(), file.size(), ec);
+    if (ec) {
+        if (auto error = parser.handler().GetError()) {
+            std::rethrow_exception(error);
+        }
+        throw std::runtime_error("Failed to parse "s + json_path.string() + ": "s + ec.message());
+    }
+    // basic_parser останавливается после первого значения и не считает ошибкой данные за ним.
+    // Пробелы после значения он может и не прочитать, поэтому они допускаются явно
+    const std::string_view rest = std::string_view{file.data(), file.size()}.substr(consumed);
+    if (rest.find_first_not_of(" \t\n\r"sv) != std::string_view::npos) {
+        throw std::runtime_error("Unexpected data after the document in "s + json_path.string());
+    }
+
+    return std::move(parser.handler().GetGame());
+}
+
+model::Game LoadGame(const std::filesystem::path& json_path,
+                     const std::filesystem::path& cache_path) {
+    const auto source = game_cache::SourceStamp::Of(json_path);
+    if (auto cached = game_cache::Load(cache_path, source)) {
+        return std::move(*cached);
+    }
 
+    model::Game game = LoadGame(json_path);
+    // Кеш лишь ускоряет следующий запуск, поэтому ошибка его записи не фатальна
+    game_cache::Save(game, cache_path, source);
     return game;
 }
 
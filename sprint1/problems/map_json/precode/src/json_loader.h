@@ -8,4 +8,9 @@ namespace json_loader {
 
 model::Game LoadGame(const std::filesystem::path& json_path);
 
+// Загружает игру из бинарного кеша cache_path, если он построен по текущей версии
+// json_path. Иначе разбирает JSON и перестраивает кеш.
+model::Game LoadGame(const std::filesystem::path& json_path,
+                     const std::filesystem::path& cache_path);
+
 }  // namespace json_loader
@@ -28,13 +28,15 @@ void RunWorkers(unsigned n, const Fn& fn) {
 }  // namespace
 
 int main(int argc, const char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: game_server <game-config-json>"sv << std::endl;
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: game_server <game-config-json> [<game-cache-file>]"sv << std::endl;
         return EXIT_FAILURE;
     }
     try {
-        // 1. Загружаем карту из файла и построить модель игры
-        model::Game game = json_loader::LoadGame(argv[1]);
+        // 1. Загружаем карту из файла и построить модель игры.
+        // Если указан файл кеша, повторные запуски загружают модель из него
+        model::Game game = argc == 3 ? json_loader::LoadGame(argv[1], argv[2])
+                                     : json_loader::LoadGame(argv[1]);
 
         // 2. Инициализируем io_context
         const unsigned num_threads = std::thread::hardware_concurrency();
@@ -1,5 +1,7 @@
 #include "model.h"
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 namespace model {
@@ -21,6 +23,80 @@ void Map::AddOffice(Office office) {
     }
 }
 
+void Map::AddRoad(const Road& road) {
+    const double length = std::abs(road.GetEnd().x - road.GetStart().x)
+                        + std::abs(road.GetEnd().y - road.GetStart().y);
+    road_length_prefix_.push_back(GetRoadsLength() + length);
+    try {
+        roads_.emplace_back(road);
+    } catch (...) {
+        // Длины дорог должны соответствовать самим дорогам
+        road_length_prefix_.pop_back();
+        throw;
+    }
+}
+
+geom::Point2D Map::GetRandomRoadPoint(double random) const {
+    if (roads_.empty()) {
+        throw std::logic_error("Map has no roads");
+    }
+    const double total_length = GetRoadsLength();
+    if (total_length == 0) {
+        const auto index = std::min(static_cast<size_t>(random * roads_.size()), roads_.size() - 1);
+        const Point start = roads_[index].GetStart();
+        return {static_cast<double>(start.x), static_cast<double>(start.y)};
+    }
+
+    const double distance = random * total_length;
+    const auto it = std::upper_bound(road_length_prefix_.begin(), road_length_prefix_.end(), distance);
+    // random < 1, но из-за округления distance может оказаться равным длине дорог
+    const size_t index = std::min(static_cast<size_t>(it - road_length_prefix_.begin()), roads_.size() - 1);
+    const double road_begin = index == 0 ? 0 : road_length_prefix_[index - 1];
+    const double road_length = road_length_prefix_[index] - road_begin;
+    const double offset = std::clamp(distance - road_begin, 0.0, road_length);
+
+    const Road& road = roads_[index];
+    const geom::Point2D start{static_cast<double>(road.GetStart().x), static_cast<double>(road.GetStart().y)};
+    if (road.IsHorizontal()) {
+        return {start.x + (road.GetEnd().x >= road.GetStart().x ? offset : -offset), start.y};
+    }
+    return {start.x, start.y + (road.GetEnd().y >= road.GetStart().y ? offset : -offset)};
+}
+
+std::vector<geom::Point2D> Map::GetRandomRoadPoints(size_t count, const RandomGenerator& random) const {
+    std::vector<geom::Point2D> points;
+    points.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        points.push_back(GetRandomRoadPoint(random()));
+    }
+    return points;
+}
+
+geom::Point2D Map::MoveAlongRoads(geom::Point2D from, geom::Point2D to) const noexcept {
+    // Дорога - прямоугольник шириной 2 * ROAD_HALF_WIDTH вокруг её осевой линии
+    constexpr double ROAD_HALF_WIDTH = 0.4;
+
+    std::optional<geom::Point2D> best;
+    double best_distance = -1;
+    for (const Road& road : roads_) {
+        const double min_x = std::min(road.GetStart().x, road.GetEnd().x) - ROAD_HALF_WIDTH;
+        const double max_x = std::max(road.GetStart().x, road.GetEnd().x) + ROAD_HALF_WIDTH;
+        const double min_y = std::min(road.GetStart().y, road.GetEnd().y) - ROAD_HALF_WIDTH;
+        const double max_y = std::max(road.GetStart().y, road.GetEnd().y) + ROAD_HALF_WIDTH;
+        if (from.x < min_x || from.x > max_x || from.y < min_y || from.y > max_y) {
+            continue;
+        }
+        const geom::Point2D reached{std::clamp(to.x, min_x, max_x), std::clamp(to.y, min_y, max_y)};
+        const double distance = std::abs(reached.x - from.x) + std::abs(reached.y - from.y);
+        if (distance > best_distance) {
+            best = reached;
+            best_distance = distance;
+        }
+    }
+    // Точка вне дорог может двигаться без ограничений
+    return best.value_or(to);
+}
+
 void Game::AddMap(Map map) {
     const size_t index = maps_.size();
     if (auto [it, inserted] = map_id_to_index_.emplace(map.GetId(), index); !inserted) {
@@ -35,4 +111,128 @@ void Game::AddMap(Map map) {
     }
 }
 
+Dog& GameSession::AddDog(std::string name) {
+    const auto& roads = map_.GetRoads();
+    const geom::Point2D spawn = roads.empty()
+        ? geom::Point2D{}
+        : geom::Point2D{static_cast<double>(roads.front().GetStart().x),
+                        static_cast<double>(roads.front().GetStart().y)};
+    return AddDog(std::move(name), spawn);
+}
+
+Dog& GameSession::AddDog(std::string name, geom::Point2D spawn) {
+    const Dog::Id id{next_dog_id_};
+    Dog& dog = dogs_.emplace(id, Dog{id, std::move(name), spawn}).first->second;
+    ++next_dog_id_;
+    dog_journal_.MarkChanged(id, GetPendingTick());
+    dog_grid_.Insert(id, spawn);
+    return dog;
+}
+
+Dog* GameSession::FindDog(Dog::Id id) noexcept {
+    const auto it = dogs_.find(id);
+    return it == dogs_.end() ? nullptr : &it->second;
+}
+
+void GameSession::MoveDog(Dog& dog, std::optional<Direction> direction, double speed) {
+    if (!direction) {
+        dog.SetSpeed({});
+    } else {
+        dog.SetDirection(*direction);
+        switch (*direction) {
+            case Direction::NORTH:
+                dog.SetSpeed({0, -speed});
+                break;
+            case Direction::SOUTH:
+                dog.SetSpeed({0, speed});
+                break;
+            case Direction::WEST:
+                dog.SetSpeed({-speed, 0});
+                break;
+            case Direction::EAST:
+                dog.SetSpeed({speed, 0});
+                break;
+        }
+    }
+    dog_journal_.MarkChanged(dog.GetId(), GetPendingTick());
+}
+
+const LostObject& GameSession::AddLostObject(unsigned type, geom::Point2D position) {
+    const LostObject::Id id{next_lost_object_id_};
+    const LostObject& object
+        = lost_objects_.emplace(id, LostObject{id, type, position}).first->second;
+    ++next_lost_object_id_;
+    lost_object_journal_.MarkChanged(id, GetPendingTick());
+    lost_object_grid_.Insert(id, position);
+    return object;
+}
+
+bool GameSession::RemoveLostObject(LostObject::Id id) {
+    if (lost_objects_.erase(id) == 0) {
+        return false;
+    }
+    lost_object_journal_.MarkRemoved(id, GetPendingTick());
+    lost_object_grid_.Remove(id);
+    return true;
+}
+
+void GameSession::Tick(std::chrono::milliseconds delta) {
+    ++tick_;
+    const double seconds = std::chrono::duration<double>{delta}.count();
+    for (auto& [id, dog] : dogs_) {
+        const auto& speed = dog.GetSpeed();
+        if (speed == geom::Vec2D{}) {
+            continue;
+        }
+        const geom::Point2D target = dog.GetPosition() + speed * seconds;
+        const geom::Point2D reached = map_.MoveAlongRoads(dog.GetPosition(), target);
+        dog.SetPosition(reached);
+        dog_grid_.Move(id, reached);
+        if (reached != target) {
+            // Собака упёрлась в край дороги
+            dog.SetSpeed({});
+        }
+        dog_journal_.MarkChanged(id, tick_);
+    }
+    dog_journal_.Prune(tick_);
+    lost_object_journal_.Prune(tick_);
+}
+
+void Game::Tick(std::chrono::milliseconds delta) {
+    for (const auto& session : sessions_) {
+        session->Tick(delta);
+    }
+}
+
+GameSession* Game::FindSessionForJoin(const Map::Id& map_id) {
+    const Map* map = FindMap(map_id);
+    if (!map) {
+        return nullptr;
+    }
+
+    auto& map_sessions = map_id_to_sessions_[map_id];
+    GameSession* least_loaded = nullptr;
+    for (GameSession* session : map_sessions) {
+        if (session->GetDogCount() < max_players_per_session_
+            && (!least_loaded || session->GetDogCount() < least_loaded->GetDogCount())) {
+            least_loaded = session;
+        }
+    }
+    if (least_loaded) {
+        return least_loaded;
+    }
+
+    const GameSession::Id id{static_cast<uint32_t>(sessions_.size())};
+    GameSession* session = sessions_.emplace_back(std::make_unique<GameSession>(id, *map)).get();
+    session->SetVisibilityRadius(visibility_radius_);
+    try {
+        map_sessions.push_back(session);
+    } catch (...) {
+        // Сеанс, не попавший в список сеансов карты, не должен остаться в игре
+        sessions_.pop_back();
+        throw;
+    }
+    return session;
+}
+
 }  // namespace model
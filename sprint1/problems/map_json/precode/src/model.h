@@ -1,8 +1,18 @@
 #pragma once
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "change_journal.h"
+#include "geom.h"
+#include "spatial_grid.h"
 #include "tagged.h"
 
 namespace model {
@@ -145,9 +155,7 @@ public:
         return offices_;
     }
 
-    void AddRoad(const Road& road) {
-        roads_.emplace_back(road);
-    }
+    void AddRoad(const Road& road);
 
     void AddBuilding(const Building& building) {
         buildings_.emplace_back(building);
@@ -155,21 +163,236 @@ public:
 
     void AddOffice(Office office);
 
+    // Возвращает значения в диапазоне [0, 1)
+    using RandomGenerator = std::function<double()>;
+
+    // Суммарная длина осевых линий дорог
+    double GetRoadsLength() const noexcept {
+        return road_length_prefix_.empty() ? 0 : road_length_prefix_.back();
+    }
+
+    // Возвращает точку на осевой линии дорог. Точки распределены равномерно по длине
+    // дорог, если random равномерно распределено в [0, 1). Выполняется за O(log n)
+    // от числа дорог. Если все дороги нулевой длины, выбирается начало дороги.
+    // Карта должна содержать хотя бы одну дорогу
+    geom::Point2D GetRandomRoadPoint(double random) const;
+
+    // Возвращает count случайных точек на дорогах, например для массового появления трофеев
+    std::vector<geom::Point2D> GetRandomRoadPoints(size_t count, const RandomGenerator& random) const;
+
+    // Перемещает точку из from в to, не выходя за пределы дорог.
+    // Если перемещение упёрлось в край дороги, возвращает точку остановки.
+    geom::Point2D MoveAlongRoads(geom::Point2D from, geom::Point2D to) const noexcept;
+
 private:
     using OfficeIdToIndex = std::unordered_map<Office::Id, size_t, util::TaggedHasher<Office::Id>>;
 
     Id id_;
     std::string name_;
     Roads roads_;
+    // road_length_prefix_[i] - суммарная длина дорог с номерами от 0 до i
+    std::vector<double> road_length_prefix_;
     Buildings buildings_;
 
     OfficeIdToIndex warehouse_id_to_index_;
     Offices offices_;
 };
 
+enum class Direction {
+    NORTH,
+    EAST,
+    WEST,
+    SOUTH,
+};
+
+class Dog {
+public:
+    using Id = util::Tagged<uint32_t, Dog>;
+
+    Dog(Id id, std::string name, geom::Point2D pos) noexcept
+        : id_{id}
+        , name_{std::move(name)}
+        , position_{pos} {
+    }
+
+    const Id& GetId() const noexcept {
+        return id_;
+    }
+
+    const std::string& GetName() const noexcept {
+        return name_;
+    }
+
+    const geom::Point2D& GetPosition() const noexcept {
+        return position_;
+    }
+
+    const geom::Vec2D& GetSpeed() const noexcept {
+        return speed_;
+    }
+
+    Direction GetDirection() const noexcept {
+        return direction_;
+    }
+
+    void SetPosition(geom::Point2D position) noexcept {
+        position_ = position;
+    }
+
+    void SetSpeed(geom::Vec2D speed) noexcept {
+        speed_ = speed;
+    }
+
+    void SetDirection(Direction direction) noexcept {
+        direction_ = direction;
+    }
+
+private:
+    Id id_;
+    std::string name_;
+    geom::Point2D position_;
+    geom::Vec2D speed_;
+    Direction direction_{Direction::NORTH};
+};
+
+// Потерянный предмет, лежащий на карте
+struct LostObject {
+    using Id = util::Tagged<uint32_t, LostObject>;
+
+    Id id;
+    unsigned type = 0;
+    geom::Point2D position;
+};
+
+/*
+ * Игровой сеанс на карте. Несколько сеансов могут работать на одной карте:
+ * карта неизменяема и используется ими совместно, а собаки у каждого сеанса свои.
+ * Сеансы независимы друг от друга, поэтому сервер может обслуживать каждый
+ * из них на собственном strand.
+ */
+class GameSession {
+public:
+    using Id = util::Tagged<uint32_t, GameSession>;
+    // map не инвалидирует ссылки на собак при добавлении и удалении других собак
+    // и перечисляет их в порядке идентификаторов
+    using Dogs = std::map<Dog::Id, Dog>;
+    using LostObjects = std::map<LostObject::Id, LostObject>;
+    using DogJournal = ChangeJournal<Dog::Id, util::TaggedHasher<Dog::Id>>;
+    using LostObjectJournal = ChangeJournal<LostObject::Id, util::TaggedHasher<LostObject::Id>>;
+    using DogGrid = SpatialGrid<Dog::Id, util::TaggedHasher<Dog::Id>>;
+    using LostObjectGrid = SpatialGrid<LostObject::Id, util::TaggedHasher<LostObject::Id>>;
+
+    // Сколько тактов хранится история удалений для построения разницы состояний
+    static constexpr TickNumber DEFAULT_HISTORY_TICKS = 1000;
+    // Размер ячейки сетки, по которой ищутся сущности в области видимости
+    static constexpr double GRID_CELL_SIZE = 10.0;
+
+    GameSession(Id id, const Map& map, TickNumber history_ticks = DEFAULT_HISTORY_TICKS) noexcept
+        : id_{id}
+        , map_{map}
+        , dog_journal_{history_ticks}
+        , dog_grid_{GRID_CELL_SIZE}
+        , lost_object_journal_{history_ticks}
+        , lost_object_grid_{GRID_CELL_SIZE} {
+    }
+
+    GameSession(const GameSession&) = delete;
+    GameSession& operator=(const GameSession&) = delete;
+
+    const Id& GetId() const noexcept {
+        return id_;
+    }
+
+    const Map& GetMap() const noexcept {
+        return map_;
+    }
+
+    const Dogs& GetDogs() const noexcept {
+        return dogs_;
+    }
+
+    size_t GetDogCount() const noexcept {
+        return dogs_.size();
+    }
+
+    const LostObjects& GetLostObjects() const noexcept {
+        return lost_objects_;
+    }
+
+    TickNumber GetTick() const noexcept {
+        return tick_;
+    }
+
+    const DogJournal& GetDogJournal() const noexcept {
+        return dog_journal_;
+    }
+
+    const LostObjectJournal& GetLostObjectJournal() const noexcept {
+        return lost_object_journal_;
+    }
+
+    const DogGrid& GetDogGrid() const noexcept {
+        return dog_grid_;
+    }
+
+    const LostObjectGrid& GetLostObjectGrid() const noexcept {
+        return lost_object_grid_;
+    }
+
+    // Радиус области видимости игрока по умолчанию. nullopt - видна вся карта
+    const std::optional<double>& GetVisibilityRadius() const noexcept {
+        return visibility_radius_;
+    }
+
+    void SetVisibilityRadius(std::optional<double> radius) noexcept {
+        visibility_radius_ = radius;
+    }
+
+    // Добавляет собаку в начало первой дороги карты
+    Dog& AddDog(std::string name);
+    Dog& AddDog(std::string name, geom::Point2D spawn);
+    Dog* FindDog(Dog::Id id) noexcept;
+
+    // Задаёт направление и скорость движения собаки. nullopt останавливает собаку
+    void MoveDog(Dog& dog, std::optional<Direction> direction, double speed);
+
+    const LostObject& AddLostObject(unsigned type, geom::Point2D position);
+    bool RemoveLostObject(LostObject::Id id);
+
+    // Продвигает время сеанса на delta и увеличивает номер такта
+    void Tick(std::chrono::milliseconds delta);
+
+private:
+    // Изменения, сделанные между тактами, помечаются следующим тактом:
+    // клиент, получивший состояние такта N, увидит их в разнице с такта N
+    TickNumber GetPendingTick() const noexcept {
+        return tick_ + 1;
+    }
+
+    Id id_;
+    const Map& map_;
+    TickNumber tick_ = 0;
+    std::optional<double> visibility_radius_;
+
+    Dogs dogs_;
+    uint32_t next_dog_id_ = 0;
+    DogJournal dog_journal_;
+    DogGrid dog_grid_;
+
+    LostObjects lost_objects_;
+    uint32_t next_lost_object_id_ = 0;
+    LostObjectJournal lost_object_journal_;
+    LostObjectGrid lost_object_grid_;
+};
+
 class Game {
 public:
-    using Maps = std::vector<Map>;
+    // Сеансы ссылаются на свои карты, поэтому карты хранятся в деке:
+    // добавление новой карты не перемещает уже добавленные
+    using Maps = std::deque<Map>;
+    using Sessions = std::vector<std::unique_ptr<GameSession>>;
+
+    static constexpr size_t UNLIMITED_PLAYERS = std::numeric_limits<size_t>::max();
 
     void AddMap(Map map);
 
@@ -184,12 +407,52 @@ public:
         return nullptr;
     }
 
+    // Максимальное количество игроков в одном сеансе. Когда все сеансы карты
+    // заполнены, для новых игроков открывается ещё один сеанс на той же карте.
+    void SetMaxPlayersPerSession(size_t max_players) noexcept {
+        max_players_per_session_ = max_players == 0 ? UNLIMITED_PLAYERS : max_players;
+    }
+
+    size_t GetMaxPlayersPerSession() const noexcept {
+        return max_players_per_session_;
+    }
+
+    // Радиус области видимости игроков в новых сеансах. nullopt - видна вся карта
+    void SetVisibilityRadius(std::optional<double> radius) noexcept {
+        visibility_radius_ = radius;
+    }
+
+    const std::optional<double>& GetVisibilityRadius() const noexcept {
+        return visibility_radius_;
+    }
+
+    // Возвращает наименее загруженный сеанс карты, в котором есть свободное место,
+    // при необходимости открывая новый. Возвращает nullptr, если карта не найдена.
+    GameSession* FindSessionForJoin(const Map::Id& map_id);
+
+    const Sessions& GetSessions() const noexcept {
+        return sessions_;
+    }
+
+    GameSession* FindSession(GameSession::Id id) noexcept {
+        return *id < sessions_.size() ? sessions_[*id].get() : nullptr;
+    }
+
+    // Продвигает время всех сеансов на delta
+    void Tick(std::chrono::milliseconds delta);
+
 private:
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
+    using MapIdToSessions = std::unordered_map<Map::Id, std::vector<GameSession*>, MapIdHasher>;
 
-    std::vector<Map> maps_;
+    Maps maps_;
     MapIdToIndex map_id_to_index_;
+
+    size_t max_players_per_session_ = UNLIMITED_PLAYERS;
+    std::optional<double> visibility_radius_;
+    Sessions sessions_;
+    MapIdToSessions map_id_to_sessions_;
 };
 
 }  // namespace model
@@ -0,0 +1,270 @@
+#pragma once
+#include <atomic>
+#include <compare>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "epoch.h"
+
+namespace app {
+
+// Токен игрока - 128-битное значение, которое клиент передаёт в виде 32 hex-цифр
+struct Token {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    constexpr auto operator<=>(const Token&) const = default;
+};
+
+namespace detail {
+
+constexpr int HexDigitValue(char c) noexcept {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+constexpr std::optional<uint64_t> ParseHex64(std::string_view hex) noexcept {
+    uint64_t value = 0;
+    for (const char c : hex) {
+        const int digit = HexDigitValue(c);
+        if (digit < 0) {
+            return std::nullopt;
+        }
+        value = (value << 4) | static_cast<uint64_t>(digit);
+    }
+    return value;
+}
+
+}  // namespace detail
+
+inline constexpr size_t TOKEN_HEX_LENGTH = 32;
+
+// Разбирает токен из ровно 32 hex-цифр, не выделяя память
+constexpr std::optional<Token> ParseToken(std::string_view hex) noexcept {
+    if (hex.size() != TOKEN_HEX_LENGTH) {
+        return std::nullopt;
+    }
+    const auto hi = detail::ParseHex64(hex.substr(0, TOKEN_HEX_LENGTH / 2));
+    const auto lo = detail::ParseHex64(hex.substr(TOKEN_HEX_LENGTH / 2));
+    if (!hi || !lo) {
+        return std::nullopt;
+    }
+    return Token{*hi, *lo};
+}
+
+// Извлекает токен из значения заголовка "Authorization: Bearer <token>"
+constexpr std::optional<Token> ParseBearerToken(std::string_view authorization) noexcept {
+    constexpr std::string_view prefix = "Bearer ";
+    if (!authorization.starts_with(prefix)) {
+        return std::nullopt;
+    }
+    return ParseToken(authorization.substr(prefix.size()));
+}
+
+struct TokenHasher {
+    size_t operator()(const Token& token) const noexcept {
+        // Токены генерируются случайно, поэтому достаточно перемешать половины
+        uint64_t h = token.hi ^ (token.lo * 0x9E3779B97F4A7C15ull);
+        h ^= h >> 32;
+        return static_cast<size_t>(h);
+    }
+};
+
+/*
+ * Конкурентная хеш-таблица "токен -> значение".
+ *
+ * Поиск не захватывает мьютексов и не ждёт других потоков: читатель входит
+ * в домен эпох и проходит по цепочке корзины. Вставка и удаление (вход игрока
+ * в игру и выход из неё) происходят гораздо реже и сериализуются мьютексом.
+ * Удалённые узлы и старые массивы корзин освобождаются только после того,
+ * как их гарантированно перестали читать.
+ */
+template <typename Value>
+class ConcurrentTokenTable {
+    struct Node {
+        Node(Token token, Value value, Node* next)
+            : token{token}
+            , value{std::move(value)}
+            , next{next} {
+        }
+
+        const Token token;
+        const Value value;
+        std::atomic<Node*> next;
+    };
+
+    struct Buckets {
+        explicit Buckets(size_t count)
+            : mask{count - 1}
+            , heads{std::make_unique<std::atomic<Node*>[]>(count)} {
+        }
+
+        Buckets(const Buckets&) = delete;
+        Buckets& operator=(const Buckets&) = delete;
+
+        ~Buckets() {
+            for (size_t i = 0; i <= mask; ++i) {
+                for (Node* node = heads[i].load(std::memory_order_relaxed); node;) {
+                    delete std::exchange(node, node->next.load(std::memory_order_relaxed));
+                }
+            }
+        }
+
+        std::atomic<Node*>& HeadFor(const Token& token) const noexcept {
+            return heads[TokenHasher{}(token) & mask];
+        }
+
+        size_t Count() const noexcept {
+            return mask + 1;
+        }
+
+        const size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> heads;
+    };
+
+    static constexpr size_t INITIAL_BUCKET_COUNT = 64;
+    // Столько отцепленных узлов копится перед ожиданием читателей
+    static constexpr size_t RETIRE_BATCH_SIZE = 64;
+
+public:
+    ConcurrentTokenTable()
+        : buckets_{new Buckets{INITIAL_BUCKET_COUNT}} {
+    }
+
+    ConcurrentTokenTable(const ConcurrentTokenTable&) = delete;
+    ConcurrentTokenTable& operator=(const ConcurrentTokenTable&) = delete;
+
+    ~ConcurrentTokenTable() {
+        for (Node* node : retired_nodes_) {
+            delete node;
+        }
+        delete buckets_.load(std::memory_order_relaxed);
+    }
+
+    // Возвращает копию значения, связанного с токеном. Не блокируется.
+    std::optional<Value> Find(const Token& token) const {
+        std::optional<Value> result;
+        Visit(token, [&result](const Value& value) {
+            result.emplace(value);
+        });
+        return result;
+    }
+
+    // Вызывает fn(const Value&) для найденного значения, не копируя его.
+    // Ссылка действительна только внутри fn.
+    template <typename Fn>
+    bool Visit(const Token& token, Fn&& fn) const {
+        const auto guard = epoch_.Enter();
+        const Buckets* buckets = buckets_.load(std::memory_order_seq_cst);
+        for (const Node* node = buckets->HeadFor(token).load(std::memory_order_acquire); node;
+             node = node->next.load(std::memory_order_acquire)) {
+            if (node->token == token) {
+                std::forward<Fn>(fn)(node->value);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Возвращает false, если токен уже есть в таблице
+    bool Insert(const Token& token, Value value) {
+        std::lock_guard lock{write_mutex_};
+        if (FindLocked(token)) {
+            return false;
+        }
+        if (size_ + 1 > buckets_.load(std::memory_order_relaxed)->Count()) {
+            Rehash();
+        }
+        auto& head = buckets_.load(std::memory_order_relaxed)->HeadFor(token);
+        head.store(new Node{token, std::move(value), head.load(std::memory_order_relaxed)},
+                   std::memory_order_release);
+        ++size_;
+        return true;
+    }
+
+    // Возвращает false, если токена нет в таблице
+    bool Erase(const Token& token) {
+        std::lock_guard lock{write_mutex_};
+        std::atomic<Node*>* link = &buckets_.load(std::memory_order_relaxed)->HeadFor(token);
+        for (Node* node = link->load(std::memory_order_relaxed); node;
+             node = link->load(std::memory_order_relaxed)) {
+            if (node->token == token) {
+                // Читатели, стоящие на node, продолжат обход по его next
+                link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+                --size_;
+                Retire(node);
+                return true;
+            }
+            link = &node->next;
+        }
+        return false;
+    }
+
+    size_t Size() const {
+        std::lock_guard lock{write_mutex_};
+        return size_;
+    }
+
+private:
+    Node* FindLocked(const Token& token) const noexcept {
+        const auto& head = buckets_.load(std::memory_order_relaxed)->HeadFor(token);
+        for (Node* node = head.load(std::memory_order_relaxed); node;
+             node = node->next.load(std::memory_order_relaxed)) {
+            if (node->token == token) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    // Строит вдвое больший массив корзин из копий узлов и публикует его.
+    // Старый массив вместе с узлами удаляется после ухода читателей.
+    void Rehash() {
+        const Buckets* old_buckets = buckets_.load(std::memory_order_relaxed);
+        auto new_buckets = std::make_unique<Buckets>(old_buckets->Count() * 2);
+        for (size_t i = 0; i < old_buckets->Count(); ++i) {
+            for (const Node* node = old_buckets->heads[i].load(std::memory_order_relaxed); node;
+                 node = node->next.load(std::memory_order_relaxed)) {
+                auto& head = new_buckets->HeadFor(node->token);
+                head.store(new Node{node->token, node->value, head.load(std::memory_order_relaxed)},
+                           std::memory_order_relaxed);
+            }
+        }
+        buckets_.store(new_buckets.release(), std::memory_order_seq_cst);
+        epoch_.Synchronize();
+        delete old_buckets;
+    }
+
+    void Retire(Node* node) {
+        retired_nodes_.push_back(node);
+        if (retired_nodes_.size() >= RETIRE_BATCH_SIZE) {
+            epoch_.Synchronize();
+            for (Node* retired : retired_nodes_) {
+                delete retired;
+            }
+            retired_nodes_.clear();
+        }
+    }
+
+    mutable util::EpochDomain epoch_;
+    std::atomic<Buckets*> buckets_;
+
+    mutable std::mutex write_mutex_;
+    size_t size_ = 0;
+    std::vector<Node*> retired_nodes_;
+};
+
+}  // namespace app
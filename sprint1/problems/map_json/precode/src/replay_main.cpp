@@ -0,0 +1,54 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "json_loader.h"
+#include "simulation.h"
+
+using namespace std::literals;
+
+/*
+ * Воспроизводит журнал действий над моделью игры с максимальной скоростью,
+ * без HTTP-сервера и таймеров. Сообщает скорость симуляции в тактах в секунду
+ * и сверяет состояние игры с хешами, сохранёнными в журнале.
+ */
+int main(int argc, const char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: game_replay <game-config-json> <action-log>"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        model::Game game = json_loader::LoadGame(argv[1]);
+
+        std::ifstream log{argv[2], std::ios::binary};
+        if (!log) {
+            std::cerr << "Failed to open "sv << argv[2] << std::endl;
+            return EXIT_FAILURE;
+        }
+        app::ActionReader reader{log};
+
+        const auto start = std::chrono::steady_clock::now();
+        const app::ReplayResult result = app::Replay(game, reader);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Actions: "sv << result.actions << '\n'
+                  << "Ticks: "sv << result.ticks << '\n'
+                  << "Elapsed: "sv << elapsed.count() << " s\n"sv;
+        if (elapsed.count() > 0) {
+            std::cout << "Ticks per second: "sv << result.ticks / elapsed.count() << '\n';
+        }
+        std::cout << "Final state hash: "sv << std::hex << result.final_hash << std::dec << '\n';
+        if (result.failed_actions > 0) {
+            std::cerr << result.failed_actions << " actions could not be applied"sv << std::endl;
+        }
+        if (result.first_mismatch) {
+            std::cerr << "State hash mismatch at record "sv << *result.first_mismatch << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Verified state hashes: "sv << result.verified_hashes << std::endl;
+        return result.failed_actions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,169 @@
+#include "simulation.h"
+
+#include <bit>
+#include <stdexcept>
+
+namespace app {
+
+namespace {
+
+// FNV-1a
+class StateHasher {
+public:
+    void Add(uint64_t value) noexcept {
+        for (int byte = 0; byte < 8; ++byte) {
+            hash_ ^= (value >> (byte * 8)) & 0xFF;
+            hash_ *= 0x100000001B3ULL;
+        }
+    }
+
+    void Add(double value) noexcept {
+        Add(std::bit_cast<uint64_t>(value));
+    }
+
+    uint64_t Get() const noexcept {
+        return hash_;
+    }
+
+private:
+    uint64_t hash_ = 0xCBF29CE484222325ULL;
+};
+
+}  // namespace
+
+uint64_t HashGameState(const model::Game& game) noexcept {
+    StateHasher hasher;
+    hasher.Add(static_cast<uint64_t>(game.GetSessions().size()));
+    // Сеансы хранятся в порядке идентификаторов, собаки и предметы - в std::map
+    for (const auto& session : game.GetSessions()) {
+        hasher.Add(static_cast<uint64_t>(*session->GetId()));
+        hasher.Add(session->GetTick());
+        hasher.Add(static_cast<uint64_t>(session->GetDogs().size()));
+        for (const auto& [id, dog] : session->GetDogs()) {
+            hasher.Add(static_cast<uint64_t>(*id));
+            hasher.Add(dog.GetPosition().x);
+            hasher.Add(dog.GetPosition().y);
+            hasher.Add(dog.GetSpeed().x);
+            hasher.Add(dog.GetSpeed().y);
+            hasher.Add(static_cast<uint64_t>(dog.GetDirection()));
+        }
+        hasher.Add(static_cast<uint64_t>(session->GetLostObjects().size()));
+        for (const auto& [id, object] : session->GetLostObjects()) {
+            hasher.Add(static_cast<uint64_t>(*id));
+            hasher.Add(static_cast<uint64_t>(object.type));
+            hasher.Add(object.position.x);
+            hasher.Add(object.position.y);
+        }
+    }
+    return hasher.Get();
+}
+
+Simulation::Simulation(model::Game& game, uint64_t seed, ActionRecorder* recorder)
+    : game_{game}
+    , random_{seed}
+    , recorder_{recorder} {
+    if (recorder_) {
+        recorder_->Record(SeedAction{seed});
+    }
+}
+
+double Simulation::NextRandom() {
+    // Старшие 53 бита образуют мантиссу числа из [0, 1)
+    return static_cast<double>(random_() >> 11) * 0x1.0p-53;
+}
+
+std::optional<Simulation::JoinResult> Simulation::Join(const model::Map::Id& map_id,
+                                                       std::string dog_name) {
+    model::GameSession* session = game_.FindSessionForJoin(map_id);
+    if (!session) {
+        return std::nullopt;
+    }
+    if (recorder_) {
+        recorder_->Record(JoinAction{map_id, dog_name});
+    }
+    // Число берётся из генератора и для карты без дорог, чтобы не зависеть от карты
+    const double random = NextRandom();
+    const model::Dog& dog = session->GetMap().GetRoads().empty()
+        ? session->AddDog(std::move(dog_name))
+        : session->AddDog(std::move(dog_name), session->GetMap().GetRandomRoadPoint(random));
+    return JoinResult{session->GetId(), dog.GetId()};
+}
+
+bool Simulation::Move(model::GameSession::Id session_id, model::Dog::Id dog_id,
+                      std::optional<model::Direction> direction, double speed) {
+    model::GameSession* session = game_.FindSession(session_id);
+    model::Dog* dog = session ? session->FindDog(dog_id) : nullptr;
+    if (!dog) {
+        return false;
+    }
+    if (recorder_) {
+        recorder_->Record(MoveAction{session_id, dog_id, direction, speed});
+    }
+    session->MoveDog(*dog, direction, speed);
+    return true;
+}
+
+void Simulation::Tick(std::chrono::milliseconds delta) {
+    if (recorder_) {
+        recorder_->Record(TickAction{delta});
+    }
+    game_.Tick(delta);
+    ++tick_count_;
+}
+
+uint64_t Simulation::RecordStateHash() {
+    const uint64_t hash = HashGameState(game_);
+    if (recorder_) {
+        recorder_->Record(StateHashAction{hash});
+    }
+    return hash;
+}
+
+bool Simulation::Apply(const Action& action) {
+    if (const auto* seed = std::get_if<SeedAction>(&action)) {
+        random_.seed(seed->seed);
+        if (recorder_) {
+            recorder_->Record(*seed);
+        }
+        return true;
+    }
+    if (const auto* join = std::get_if<JoinAction>(&action)) {
+        return Join(join->map_id, join->dog_name).has_value();
+    }
+    if (const auto* move = std::get_if<MoveAction>(&action)) {
+        return Move(move->session_id, move->dog_id, move->direction, move->speed);
+    }
+    if (const auto* tick = std::get_if<TickAction>(&action)) {
+        Tick(tick->delta);
+        return true;
+    }
+    RecordStateHash();
+    return true;
+}
+
+ReplayResult Replay(model::Game& game, ActionReader& reader) {
+    auto first = reader.Next();
+    if (!first || !std::holds_alternative<SeedAction>(*first)) {
+        throw std::runtime_error("Action log must start with a seed");
+    }
+    Simulation simulation{game, std::get<SeedAction>(*first).seed};
+
+    ReplayResult result;
+    result.actions = 1;
+    while (auto action = reader.Next()) {
+        if (const auto* expected = std::get_if<StateHashAction>(&*action)) {
+            if (HashGameState(game) != expected->hash && !result.first_mismatch) {
+                result.first_mismatch = result.actions;
+            }
+            ++result.verified_hashes;
+        } else if (!simulation.Apply(*action)) {
+            ++result.failed_actions;
+        }
+        ++result.actions;
+    }
+    result.ticks = simulation.GetTickCount();
+    result.final_hash = HashGameState(game);
+    return result;
+}
+
+}  // namespace app
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+
+#include "action_log.h"
+#include "model.h"
+
+namespace app {
+
+// Хеш состояния всех сеансов игры: положения, скорости и направления собак
+// и предметы на картах. Не зависит от порядка вставки сущностей в контейнеры
+uint64_t HashGameState(const model::Game& game) noexcept;
+
+/*
+ * Детерминированный источник действий над моделью игры без HTTP и таймеров.
+ *
+ * Все случайные решения симуляции (например, точка появления собаки) принимаются
+ * генератором, инициализированным seed. Поэтому одинаковый seed и одинаковая
+ * последовательность действий приводят к одинаковому состоянию игры.
+ * Если задан recorder, каждое действие дописывается в журнал.
+ */
+class Simulation {
+public:
+    struct JoinResult {
+        model::GameSession::Id session_id;
+        model::Dog::Id dog_id;
+    };
+
+    Simulation(model::Game& game, uint64_t seed, ActionRecorder* recorder = nullptr);
+
+    // Возвращает nullopt, если карта не найдена
+    std::optional<JoinResult> Join(const model::Map::Id& map_id, std::string dog_name);
+
+    // Возвращает false, если сеанс или собака не найдены
+    bool Move(model::GameSession::Id session_id, model::Dog::Id dog_id,
+              std::optional<model::Direction> direction, double speed);
+
+    void Tick(std::chrono::milliseconds delta);
+
+    // Записывает в журнал хеш текущего состояния для проверки при воспроизведении
+    uint64_t RecordStateHash();
+
+    // Применяет действие из журнала. SeedAction перезапускает генератор.
+    // Возвращает false, если действие не удалось применить
+    bool Apply(const Action& action);
+
+    uint64_t GetTickCount() const noexcept {
+        return tick_count_;
+    }
+
+private:
+    // Случайное число из [0, 1), не зависящее от реализации стандартной библиотеки
+    double NextRandom();
+
+    model::Game& game_;
+    std::mt19937_64 random_;
+    ActionRecorder* recorder_;
+    uint64_t tick_count_ = 0;
+};
+
+// Результат воспроизведения журнала действий
+struct ReplayResult {
+    uint64_t actions = 0;
+    uint64_t ticks = 0;
+    uint64_t failed_actions = 0;
+    uint64_t verified_hashes = 0;
+    // Номер первой записи хеша, не совпавшей с состоянием игры
+    std::optional<uint64_t> first_mismatch;
+    uint64_t final_hash = 0;
+};
+
+// Воспроизводит журнал над игрой game. Журнал должен начинаться с SeedAction.
+// Выбрасывает std::runtime_error, если журнал повреждён
+ReplayResult Replay(model::Game& game, ActionReader& reader);
+
+}  // namespace app
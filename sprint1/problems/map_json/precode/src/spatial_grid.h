@@ -0,0 +1,139 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "geom.h"
+
+namespace model {
+
+/*
+ * Равномерная сетка для поиска сущностей рядом с точкой.
+ *
+ * Каждая сущность хранится в ячейке, содержащей её позицию. При перемещении
+ * сущность перекладывается в другую ячейку, только если сменилась ячейка,
+ * поэтому обновление стоит O(1). Поиск в круге просматривает лишь ячейки,
+ * пересекающие описанный вокруг круга квадрат.
+ */
+template <typename Id, typename Hasher>
+class SpatialGrid {
+    struct Entry {
+        Id id;
+        geom::Point2D position;
+    };
+
+    struct Location {
+        int64_t cell;
+        size_t index;
+    };
+
+public:
+    explicit SpatialGrid(double cell_size) noexcept
+        : cell_size_{cell_size} {
+    }
+
+    void Insert(const Id& id, geom::Point2D position) {
+        const int64_t cell = CellOf(position);
+        auto& entries = cells_[cell];
+        locations_.insert_or_assign(id, Location{cell, entries.size()});
+        entries.push_back(Entry{id, position});
+    }
+
+    void Move(const Id& id, geom::Point2D position) {
+        const auto it = locations_.find(id);
+        if (it == locations_.end()) {
+            Insert(id, position);
+            return;
+        }
+        Location& location = it->second;
+        const int64_t cell = CellOf(position);
+        if (cell == location.cell) {
+            cells_[cell][location.index].position = position;
+            return;
+        }
+        RemoveFromCell(location);
+        auto& entries = cells_[cell];
+        location = Location{cell, entries.size()};
+        entries.push_back(Entry{id, position});
+    }
+
+    void Remove(const Id& id) {
+        if (const auto it = locations_.find(id); it != locations_.end()) {
+            RemoveFromCell(it->second);
+            locations_.erase(it);
+        }
+    }
+
+    size_t Size() const noexcept {
+        return locations_.size();
+    }
+
+    // Вызывает fn(id, position) для сущностей на расстоянии не больше radius от center
+    template <typename Fn>
+    void ForEachInRadius(geom::Point2D center, double radius, Fn&& fn) const {
+        const double sq_radius = radius * radius;
+        const auto visit_cell = [&](const std::vector<Entry>& entries) {
+            for (const Entry& entry : entries) {
+                const double dx = entry.position.x - center.x;
+                const double dy = entry.position.y - center.y;
+                if (dx * dx + dy * dy <= sq_radius) {
+                    fn(entry.id, entry.position);
+                }
+            }
+        };
+
+        const int64_t min_x = CellCoord(center.x - radius);
+        const int64_t max_x = CellCoord(center.x + radius);
+        const int64_t min_y = CellCoord(center.y - radius);
+        const int64_t max_y = CellCoord(center.y + radius);
+        // Для очень большого радиуса дешевле перебрать непустые ячейки
+        const double area_cells = double(max_x - min_x + 1) * double(max_y - min_y + 1);
+        if (area_cells > static_cast<double>(cells_.size())) {
+            for (const auto& [cell, entries] : cells_) {
+                visit_cell(entries);
+            }
+            return;
+        }
+        for (int64_t cx = min_x; cx <= max_x; ++cx) {
+            for (int64_t cy = min_y; cy <= max_y; ++cy) {
+                if (const auto it = cells_.find(CellKey(cx, cy)); it != cells_.end()) {
+                    visit_cell(it->second);
+                }
+            }
+        }
+    }
+
+private:
+    int64_t CellCoord(double coord) const noexcept {
+        return static_cast<int64_t>(std::floor(coord / cell_size_));
+    }
+
+    static int64_t CellKey(int64_t cx, int64_t cy) noexcept {
+        return (cx << 32) ^ (cy & 0xFFFFFFFF);
+    }
+
+    int64_t CellOf(geom::Point2D position) const noexcept {
+        return CellKey(CellCoord(position.x), CellCoord(position.y));
+    }
+
+    // Удаляет запись из ячейки, перемещая на её место последнюю запись ячейки
+    void RemoveFromCell(const Location& location) {
+        auto cell_it = cells_.find(location.cell);
+        auto& entries = cell_it->second;
+        if (location.index + 1 != entries.size()) {
+            entries[location.index] = entries.back();
+            locations_.at(entries[location.index].id).index = location.index;
+        }
+        entries.pop_back();
+        if (entries.empty()) {
+            cells_.erase(cell_it);
+        }
+    }
+
+    double cell_size_;
+    std::unordered_map<int64_t, std::vector<Entry>> cells_;
+    std::unordered_map<Id, Location, Hasher> locations_;
+};
+
+}  // namespace model
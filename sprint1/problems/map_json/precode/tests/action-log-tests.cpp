@@ -0,0 +1,133 @@
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <string>
+
+#include "../src/simulation.h"
+
+using namespace std::literals;
+
+namespace {
+
+model::Game MakeGame() {
+    model::Game game;
+    game.SetMaxPlayersPerSession(2);
+    model::Map map{model::Map::Id{"map1"s}, "Map 1"s};
+    map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 40});
+    map.AddRoad(model::Road{model::Road::VERTICAL, {40, 0}, 30});
+    map.AddRoad(model::Road{model::Road::HORIZONTAL, {40, 30}, 0});
+    game.AddMap(std::move(map));
+    return game;
+}
+
+// Разыгрывает партию из нескольких сеансов, записывая её в out
+uint64_t Play(model::Game& game, uint64_t seed, std::ostream& out) {
+    app::ActionRecorder recorder{out};
+    app::Simulation simulation{game, seed, &recorder};
+    const model::Map::Id map_id{"map1"s};
+    constexpr model::Direction DIRECTIONS[] = {model::Direction::EAST, model::Direction::SOUTH,
+                                               model::Direction::WEST, model::Direction::NORTH};
+    std::vector<app::Simulation::JoinResult> players;
+    for (int tick = 0; tick < 100; ++tick) {
+        if (tick % 10 == 0) {
+            players.push_back(*simulation.Join(map_id, "Dog "s + std::to_string(tick)));
+        }
+        for (size_t i = 0; i < players.size(); ++i) {
+            if ((tick + i) % 7 == 0) {
+                simulation.Move(players[i].session_id, players[i].dog_id, DIRECTIONS[(tick + i) % 4], 2.5);
+            } else if ((tick + i) % 13 == 0) {
+                simulation.Move(players[i].session_id, players[i].dog_id, std::nullopt, 0);
+            }
+        }
+        simulation.Tick(std::chrono::milliseconds{50 + tick % 3 * 25});
+        if (tick % 25 == 24) {
+            simulation.RecordStateHash();
+        }
+    }
+    return simulation.RecordStateHash();
+}
+
+}  // namespace
+
+SCENARIO("Action recording and replay") {
+    GIVEN("a recorded game") {
+        auto game = MakeGame();
+        std::stringstream log;
+        const uint64_t recorded_hash = Play(game, 42, log);
+        REQUIRE(game.GetSessions().size() == 5);
+
+        WHEN("the log is replayed on a fresh game") {
+            auto replayed = MakeGame();
+            app::ActionReader reader{log};
+            const auto result = app::Replay(replayed, reader);
+
+            THEN("the final state matches the recorded one") {
+                CHECK(result.ticks == 100);
+                CHECK(result.failed_actions == 0);
+                CHECK(result.verified_hashes == 5);
+                CHECK_FALSE(result.first_mismatch);
+                CHECK(result.final_hash == recorded_hash);
+                CHECK(app::HashGameState(replayed) == app::HashGameState(game));
+            }
+        }
+
+        WHEN("the same actions are played with another seed") {
+            auto other = MakeGame();
+            std::stringstream other_log;
+            THEN("dogs appear at other places") {
+                CHECK(Play(other, 43, other_log) != recorded_hash);
+            }
+        }
+
+        WHEN("the log is replayed on a game that diverges") {
+            auto diverged = MakeGame();
+            diverged.FindSessionForJoin(model::Map::Id{"map1"s})->AddLostObject(0, {1, 0});
+            app::ActionReader reader{log};
+            const auto result = app::Replay(diverged, reader);
+
+            THEN("the first hash record reports a mismatch") {
+                REQUIRE(result.first_mismatch);
+                CHECK(result.final_hash != recorded_hash);
+            }
+        }
+    }
+
+    GIVEN("a log that is not an action log") {
+        std::stringstream log{"GAMECACH"s};
+        THEN("the reader rejects it") {
+            CHECK_THROWS_AS(app::ActionReader{log}, std::runtime_error);
+        }
+    }
+
+    GIVEN("a truncated log") {
+        std::stringstream log;
+        {
+            app::ActionRecorder recorder{log};
+            recorder.Record(app::MoveAction{model::GameSession::Id{1u}, model::Dog::Id{2u},
+                                            model::Direction::WEST, 1.5});
+        }
+        auto data = log.str();
+        data.pop_back();
+        std::stringstream truncated{data};
+        app::ActionReader reader{truncated};
+        THEN("reading the record throws") {
+            CHECK_THROWS_AS(reader.Next(), std::runtime_error);
+        }
+    }
+
+    GIVEN("a move record") {
+        std::stringstream log;
+        app::ActionRecorder recorder{log};
+        recorder.Record(app::MoveAction{model::GameSession::Id{1u}, model::Dog::Id{300u}, std::nullopt, 0.1});
+        app::ActionReader reader{log};
+        THEN("it round-trips exactly") {
+            const auto action = reader.Next();
+            REQUIRE(action);
+            const auto& move = std::get<app::MoveAction>(*action);
+            CHECK(*move.session_id == 1u);
+            CHECK(*move.dog_id == 300u);
+            CHECK_FALSE(move.direction);
+            CHECK(move.speed == 0.1);
+            CHECK_FALSE(reader.Next());
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "../src/game_cache.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+model::Game MakeGame() {
+    model::Game game;
+    game.SetMaxPlayersPerSession(8);
+    game.SetVisibilityRadius(25.5);
+
+    model::Map map1{model::Map::Id{"map1"s}, "Map 1"s};
+    map1.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 40});
+    map1.AddRoad(model::Road{model::Road::VERTICAL, {40, 0}, 30});
+    map1.AddBuilding(model::Building{{{5, 5}, {30, 20}}});
+    map1.AddOffice(model::Office{model::Office::Id{"o0"s}, {40, 30}, {5, -1}});
+    game.AddMap(std::move(map1));
+
+    game.AddMap(model::Map{model::Map::Id{"empty"s}, "Пустая карта"s});
+    return game;
+}
+
+void CheckEqual(const model::Game& expected, const model::Game& actual) {
+    CHECK(expected.GetMaxPlayersPerSession() == actual.GetMaxPlayersPerSession());
+    CHECK(expected.GetVisibilityRadius() == actual.GetVisibilityRadius());
+    REQUIRE(expected.GetMaps().size() == actual.GetMaps().size());
+    for (size_t i = 0; i < expected.GetMaps().size(); ++i) {
+        const auto& e = expected.GetMaps()[i];
+        const auto& a = actual.GetMaps()[i];
+        CHECK(e.GetId() == a.GetId());
+        CHECK(e.GetName() == a.GetName());
+        REQUIRE(e.GetRoads().size() == a.GetRoads().size());
+        for (size_t j = 0; j < e.GetRoads().size(); ++j) {
+            CHECK(e.GetRoads()[j].GetStart().x == a.GetRoads()[j].GetStart().x);
+            CHECK(e.GetRoads()[j].GetStart().y == a.GetRoads()[j].GetStart().y);
+            CHECK(e.GetRoads()[j].GetEnd().x == a.GetRoads()[j].GetEnd().x);
+            CHECK(e.GetRoads()[j].GetEnd().y == a.GetRoads()[j].GetEnd().y);
+        }
+        REQUIRE(e.GetBuildings().size() == a.GetBuildings().size());
+        for (size_t j = 0; j < e.GetBuildings().size(); ++j) {
+            const auto& eb = e.GetBuildings()[j].GetBounds();
+            const auto& ab = a.GetBuildings()[j].GetBounds();
+            CHECK(eb.position.x == ab.position.x);
+            CHECK(eb.position.y == ab.position.y);
+            CHECK(eb.size.width == ab.size.width);
+            CHECK(eb.size.height == ab.size.height);
+        }
+        REQUIRE(e.GetOffices().size() == a.GetOffices().size());
+        for (size_t j = 0; j < e.GetOffices().size(); ++j) {
+            const auto& eo = e.GetOffices()[j];
+            const auto& ao = a.GetOffices()[j];
+            CHECK(eo.GetId() == ao.GetId());
+            CHECK(eo.GetPosition().x == ao.GetPosition().x);
+            CHECK(eo.GetPosition().y == ao.GetPosition().y);
+            CHECK(eo.GetOffset().dx == ao.GetOffset().dx);
+            CHECK(eo.GetOffset().dy == ao.GetOffset().dy);
+        }
+    }
+}
+
+struct Fixture {
+    Fixture() {
+        fs::create_directories(dir);
+    }
+
+    ~Fixture() {
+        fs::remove_all(dir);
+    }
+
+    fs::path dir = fs::temp_directory_path() / "game_cache_tests";
+    fs::path cache = dir / "config.cache";
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "Binary game cache") {
+    GIVEN("a game") {
+        const auto game = MakeGame();
+        const game_cache::SourceStamp stamp{1234, 5678};
+
+        WHEN("it is saved to cache") {
+            REQUIRE(game_cache::Save(game, cache, stamp));
+
+            THEN("it is restored for the same source") {
+                const auto restored = game_cache::Load(cache, stamp);
+                REQUIRE(restored.has_value());
+                CheckEqual(game, *restored);
+            }
+
+            THEN("it is ignored for another source") {
+                CHECK_FALSE(game_cache::Load(cache, {1234, 5679}));
+                CHECK_FALSE(game_cache::Load(cache, {1235, 5678}));
+            }
+
+            THEN("truncated cache is ignored") {
+                fs::resize_file(cache, fs::file_size(cache) - 1);
+                CHECK_FALSE(game_cache::Load(cache, stamp));
+            }
+        }
+
+        WHEN("cache does not exist") {
+            THEN("nothing is loaded") {
+                CHECK_FALSE(game_cache::Load(dir / "missing.cache", stamp));
+            }
+        }
+
+        WHEN("cache has wrong format") {
+            std::ofstream{cache} << "not a cache at all"s;
+            THEN("nothing is loaded") {
+                CHECK_FALSE(game_cache::Load(cache, stamp));
+            }
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "../src/model.h"
+
+using namespace std::literals;
+
+namespace {
+
+model::Map MakeMap(std::string id) {
+    model::Map map{model::Map::Id{id}, "Map "s + id};
+    map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 40});
+    return map;
+}
+
+}  // namespace
+
+SCENARIO("Game session sharding") {
+    GIVEN("a game with two maps and limited sessions") {
+        model::Game game;
+        game.AddMap(MakeMap("map1"s));
+        game.AddMap(MakeMap("map2"s));
+        game.SetMaxPlayersPerSession(2);
+        const model::Map::Id map1{"map1"s};
+
+        WHEN("a map is unknown") {
+            THEN("no session is returned") {
+                CHECK(game.FindSessionForJoin(model::Map::Id{"map3"s}) == nullptr);
+                CHECK(game.GetSessions().empty());
+            }
+        }
+
+        WHEN("players join one map") {
+            for (int i = 0; i < 5; ++i) {
+                auto* session = game.FindSessionForJoin(map1);
+                REQUIRE(session != nullptr);
+                session->AddDog("dog"s + std::to_string(i));
+            }
+
+            THEN("new sessions are opened on the same map object") {
+                const auto& sessions = game.GetSessions();
+                REQUIRE(sessions.size() == 3);
+                for (const auto& session : sessions) {
+                    CHECK(&session->GetMap() == game.FindMap(map1));
+                    CHECK(session->GetDogCount() <= 2);
+                }
+                CHECK(sessions[2]->GetDogCount() == 1);
+            }
+
+            AND_WHEN("more maps are added afterwards") {
+                const model::Map* map = game.FindMap(map1);
+                for (int i = 0; i < 100; ++i) {
+                    game.AddMap(MakeMap("extra"s + std::to_string(i)));
+                }
+                THEN("sessions still refer to their map") {
+                    CHECK(game.FindMap(map1) == map);
+                    for (const auto& session : game.GetSessions()) {
+                        CHECK(&session->GetMap() == map);
+                        CHECK(*session->GetMap().GetId() == "map1"s);
+                    }
+                }
+            }
+
+            AND_WHEN("players of another map join") {
+                auto* session = game.FindSessionForJoin(model::Map::Id{"map2"s});
+                THEN("they get a session of their own map") {
+                    REQUIRE(session != nullptr);
+                    CHECK(*session->GetMap().GetId() == "map2"s);
+                    CHECK(session->GetDogCount() == 0);
+                }
+            }
+        }
+
+        WHEN("sessions have free places") {
+            auto* first = game.FindSessionForJoin(map1);
+            first->AddDog("a"s);
+            first->AddDog("b"s);
+            auto* second = game.FindSessionForJoin(map1);
+            second->AddDog("c"s);
+
+            THEN("the least loaded session is chosen") {
+                CHECK(first != second);
+                CHECK(game.FindSessionForJoin(map1) == second);
+            }
+        }
+    }
+
+    GIVEN("a game without session limit") {
+        model::Game game;
+        game.AddMap(MakeMap("map1"s));
+        const model::Map::Id map1{"map1"s};
+        for (int i = 0; i < 100; ++i) {
+            game.FindSessionForJoin(map1)->AddDog("dog"s);
+        }
+        THEN("all players share one session") {
+            REQUIRE(game.GetSessions().size() == 1);
+            CHECK(game.GetSessions().front()->GetDogCount() == 100);
+        }
+    }
+}
+
+SCENARIO("Random points on roads") {
+    GIVEN("a map with a long and a short road") {
+        model::Map map{model::Map::Id{"map"s}, "Map"s};
+        map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 30});
+        map.AddRoad(model::Road{model::Road::VERTICAL, {5, 20}, 10});
+        map.AddRoad(model::Road{model::Road::HORIZONTAL, {7, 7}, 7});
+
+        THEN("the network length is the sum of road lengths") {
+            CHECK(map.GetRoadsLength() == 40);
+        }
+
+        WHEN("a point is drawn by a fraction of the network length") {
+            THEN("it lies on the road covering that distance") {
+                CHECK(map.GetRandomRoadPoint(0) == geom::Point2D{0, 0});
+                CHECK(map.GetRandomRoadPoint(0.5) == geom::Point2D{20, 0});
+                CHECK(map.GetRandomRoadPoint(0.75) == geom::Point2D{5, 20});
+                // Вертикальная дорога идёт от y = 20 к y = 10
+                CHECK(map.GetRandomRoadPoint(0.875) == geom::Point2D{5, 15});
+                CHECK(map.GetRandomRoadPoint(std::nextafter(1.0, 0.0)).y > 10);
+            }
+        }
+
+        WHEN("many points are drawn") {
+            double random = 0;
+            const auto points = map.GetRandomRoadPoints(4000, [&random] {
+                random += 1.0 / 4000;
+                return random - 1.0 / 8000;
+            });
+
+            THEN("roads get points in proportion to their length") {
+                REQUIRE(points.size() == 4000);
+                const auto on_first_road = std::count_if(points.begin(), points.end(), [](const auto& point) {
+                    return point.y == 0;
+                });
+                CHECK(on_first_road == 3000);
+            }
+        }
+    }
+
+    GIVEN("a map without roads") {
+        model::Map map{model::Map::Id{"empty"s}, "Empty"s};
+        THEN("a point cannot be drawn") {
+            CHECK_THROWS_AS(map.GetRandomRoadPoint(0.5), std::logic_error);
+        }
+    }
+}
@@ -0,0 +1,223 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+#include "../src/game_state_view.h"
+
+using namespace std::literals;
+
+namespace {
+
+model::Map MakeMap() {
+    model::Map map{model::Map::Id{"map1"s}, "Map 1"s};
+    map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 40});
+    return map;
+}
+
+}  // namespace
+
+SCENARIO("Session state rendering") {
+    GIVEN("a session with a dog and a lost object") {
+        const auto map = MakeMap();
+        model::GameSession session{model::GameSession::Id{0u}, map, 10};
+        app::SessionStateView view{session};
+        auto& dog = session.AddDog("Pluto"s);
+        session.AddLostObject(1, {10, 0});
+        session.Tick(0ms);
+
+        THEN("full state contains every entity") {
+            CHECK(view.Render()
+                  == R"({"tick":1,"full":true,"players":{"0":{"pos":[0,0],"speed":[0,0],"dir":"U"}},)"
+                     R"("lostObjects":{"0":{"type":1,"pos":[10,0]}}})"s);
+        }
+
+        WHEN("nothing changes") {
+            THEN("diff is empty") {
+                CHECK(view.Render(1)
+                      == R"({"tick":1,"full":false,"players":{},"removedPlayers":[],)"
+                         R"("lostObjects":{},"removedLostObjects":[]})"s);
+            }
+        }
+
+        WHEN("the dog moves and the lost object is removed") {
+            view.Render();
+            session.MoveDog(dog, model::Direction::EAST, 2.0);
+            session.Tick(1000ms);
+            session.RemoveLostObject(model::LostObject::Id{0u});
+
+            THEN("diff contains only changed and removed entities") {
+                CHECK(view.Render(1)
+                      == R"({"tick":2,"full":false,"players":{"0":{"pos":[2,0],"speed":[2,0],"dir":"R"}},)"
+                         R"("removedPlayers":[],"lostObjects":{},"removedLostObjects":[0]})"s);
+            }
+
+            THEN("cached fragments are refreshed after changes within a tick") {
+                view.Render(1);
+                session.MoveDog(dog, std::nullopt, 0.0);
+                CHECK(view.Render(2).find(R"("speed":[0,0])"s) != std::string::npos);
+            }
+        }
+
+        WHEN("the dog reaches the end of the road") {
+            session.MoveDog(dog, model::Direction::WEST, 5.0);
+            session.Tick(1000ms);
+            THEN("it stops at the road edge") {
+                CHECK(dog.GetPosition() == geom::Point2D{-0.4, 0});
+                CHECK(dog.GetSpeed() == geom::Vec2D{});
+            }
+        }
+
+        WHEN("requested tick is too old or from the future") {
+            for (int i = 0; i < 20; ++i) {
+                session.Tick(100ms);
+            }
+            THEN("full state is returned") {
+                CHECK(view.Render(0).find(R"("full":true)"s) != std::string::npos);
+                CHECK(view.Render(100).find(R"("full":true)"s) != std::string::npos);
+                CHECK(view.Render(15).find(R"("full":false)"s) != std::string::npos);
+            }
+        }
+    }
+}
+
+SCENARIO("Since parameter parsing") {
+    CHECK(app::ParseSinceTick("since=42"sv) == 42u);
+    CHECK(app::ParseSinceTick("a=1&since=7&b=2"sv) == 7u);
+    CHECK_FALSE(app::ParseSinceTick(""sv));
+    CHECK_FALSE(app::ParseSinceTick("since="sv));
+    CHECK_FALSE(app::ParseSinceTick("since=-1"sv));
+    CHECK_FALSE(app::ParseSinceTick("since=12x"sv));
+    CHECK_FALSE(app::ParseSinceTick("nosince=1"sv));
+}
+
+SCENARIO("Area of interest filtering") {
+    GIVEN("a session with entities spread along a long road") {
+        model::Map map{model::Map::Id{"map1"s}, "Map 1"s};
+        map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 1000});
+        model::GameSession session{model::GameSession::Id{0u}, map};
+        app::SessionStateView view{session};
+
+        auto& near_dog = session.AddDog("near"s);
+        auto& far_dog = session.AddDog("far"s);
+        session.MoveDog(far_dog, model::Direction::EAST, 500.0);
+        session.Tick(1000ms);
+        session.MoveDog(far_dog, std::nullopt, 0.0);
+        for (int x = 0; x <= 1000; x += 100) {
+            session.AddLostObject(0, {static_cast<double>(x), 0});
+        }
+        session.Tick(0ms);
+
+        const app::AreaOfInterest area{near_dog.GetPosition(), 150.0};
+        app::ViewerState viewer;
+        const std::string visible_state
+            = R"({"tick":2,"full":true,"players":{"0":{"pos":[0,0],"speed":[0,0],"dir":"U"}},)"
+              R"("lostObjects":{"0":{"type":0,"pos":[0,0]},"1":{"type":0,"pos":[100,0]}}})"s;
+
+        THEN("full state contains only visible entities") {
+            CHECK(view.Render(std::nullopt, area, viewer) == visible_state);
+            CHECK(viewer.tick == 2u);
+            CHECK(viewer.dogs == std::vector<uint32_t>{0});
+            CHECK(viewer.lost_objects == std::vector<uint32_t>{0, 1});
+        }
+
+        THEN("grid contains every entity") {
+            CHECK(session.GetDogGrid().Size() == 2);
+            CHECK(session.GetLostObjectGrid().Size() == 11);
+        }
+
+        WHEN("a dog the viewer has never seen moves out of view") {
+            view.Render(std::nullopt, area, viewer);
+            session.MoveDog(far_dog, model::Direction::WEST, 1.0);
+            session.Tick(1000ms);
+            THEN("it is not reported") {
+                CHECK(view.Render(2, area, viewer)
+                      == R"({"tick":3,"full":false,"players":{},"removedPlayers":[],)"
+                         R"("lostObjects":{},"removedLostObjects":[]})"s);
+            }
+        }
+
+        WHEN("a dog comes into view") {
+            view.Render(std::nullopt, area, viewer);
+            session.MoveDog(far_dog, model::Direction::WEST, 400.0);
+            session.Tick(1000ms);
+            THEN("it is included in the diff") {
+                CHECK(view.Render(2, area, viewer).find(R"("1":{"pos":[100,0])"s) != std::string::npos);
+            }
+        }
+
+        WHEN("the area moves over entities that do not change") {
+            view.Render(std::nullopt, area, viewer);
+            const app::AreaOfInterest moved{{300, 0}, 150.0};
+            THEN("entities entering the area are sent and those leaving it are removed") {
+                CHECK(view.Render(2, moved, viewer)
+                      == R"({"tick":2,"full":false,"players":{},"removedPlayers":[0],)"
+                         R"("lostObjects":{"2":{"type":0,"pos":[200,0]},"3":{"type":0,"pos":[300,0]},)"
+                         R"("4":{"type":0,"pos":[400,0]}},"removedLostObjects":[0,1]})"s);
+                CHECK(view.Render(2, moved, viewer)
+                      == R"({"tick":2,"full":false,"players":{},"removedPlayers":[],)"
+                         R"("lostObjects":{},"removedLostObjects":[]})"s);
+            }
+        }
+
+        WHEN("the client asks for a diff from a tick it was not sent") {
+            view.Render(std::nullopt, area, viewer);
+            THEN("full state of the area is returned") {
+                CHECK(view.Render(1, area, viewer) == visible_state);
+            }
+        }
+
+        WHEN("the session has a visibility radius") {
+            session.SetVisibilityRadius(150.0);
+            THEN("the area is centered on the viewer's dog") {
+                CHECK(view.RenderFor(std::nullopt, near_dog.GetId(), viewer) == visible_state);
+            }
+
+            AND_WHEN("the viewer's dog walks toward stationary loot") {
+                view.RenderFor(std::nullopt, near_dog.GetId(), viewer);
+                session.MoveDog(near_dog, model::Direction::EAST, 300.0);
+                session.Tick(1000ms);
+                THEN("the loot it approaches is sent") {
+                    CHECK(view.RenderFor(2, near_dog.GetId(), viewer)
+                          == R"({"tick":3,"full":false,"players":{"0":{"pos":[300,0],"speed":[300,0],"dir":"R"}},)"
+                             R"("removedPlayers":[],"lostObjects":{"2":{"type":0,"pos":[200,0]},)"
+                             R"("3":{"type":0,"pos":[300,0]},"4":{"type":0,"pos":[400,0]}},)"
+                             R"("removedLostObjects":[0,1]})"s);
+                }
+            }
+        }
+
+        WHEN("the session has no visibility radius") {
+            THEN("the whole map is rendered for the viewer") {
+                CHECK(view.RenderFor(std::nullopt, near_dog.GetId(), viewer) == view.Render());
+            }
+        }
+    }
+}
+
+SCENARIO("Spatial grid") {
+    using Grid = model::SpatialGrid<model::Dog::Id, util::TaggedHasher<model::Dog::Id>>;
+    Grid grid{1.0};
+    for (uint32_t i = 0; i < 100; ++i) {
+        grid.Insert(model::Dog::Id{i}, {i * 0.5 - 25, -0.25 * i});
+    }
+    const auto count_in = [&grid](geom::Point2D center, double radius) {
+        size_t count = 0;
+        grid.ForEachInRadius(center, radius, [&count](auto, auto) {
+            ++count;
+        });
+        return count;
+    };
+
+    CHECK(count_in({0, 0}, 1e9) == 100);
+    CHECK(count_in({-25, 0}, 0.1) == 1);
+
+    for (uint32_t i = 0; i < 100; i += 2) {
+        grid.Move(model::Dog::Id{i}, {1000, 1000});
+    }
+    for (uint32_t i = 1; i < 100; i += 4) {
+        grid.Remove(model::Dog::Id{i});
+    }
+    CHECK(grid.Size() == 75);
+    CHECK(count_in({1000, 1000}, 0.5) == 50);
+    CHECK(count_in({0, 0}, 1e9) == 75);
+}
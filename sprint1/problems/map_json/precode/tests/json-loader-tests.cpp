@@ -0,0 +1,153 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "../src/json_loader.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Записывает конфигурацию во временный файл и загружает из него игру
+model::Game LoadFromString(std::string_view json) {
+    const fs::path path = fs::temp_directory_path() / "json-loader-tests.json";
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out << json;
+    }
+    try {
+        model::Game game = json_loader::LoadGame(path);
+        fs::remove(path);
+        return game;
+    } catch (...) {
+        fs::remove(path);
+        throw;
+    }
+}
+
+constexpr std::string_view FULL_CONFIG = R"({
+    "defaultDogSpeed": 3.0,
+    "lootGeneratorConfig": {"period": 5.0, "probability": 0.5, "maps": [{"id": "ignored"}]},
+    "maxPlayersPerSession": 4,
+    "visibilityRadius": 12.5,
+    "maps": [
+        {
+            "id": "map1",
+            "name": "Map 1",
+            "lootTypes": [{"name": "key", "scale": 0.03}],
+            "meta": {"id": "wrong", "name": "wrong", "roads": [{"x0": 1}]},
+            "roads": [
+                {"x0": 0, "y0": 0, "x1": 40},
+                {"x0": 40, "y0": 0, "y1": 30, "extra": {"x1": 99}}
+            ],
+            "buildings": [
+                {"x": 5, "y": 5, "w": 30, "h": 20}
+            ],
+            "offices": [
+                {"id": "o0", "x": 40, "y": 30, "offsetX": 5, "offsetY": -1, "tags": ["id", "x"]}
+            ]
+        },
+        {"id": "map2", "name": "Пустая карта"}
+    ]
+})";
+
+}  // namespace
+
+SCENARIO("Game config loading") {
+    GIVEN("a config with all supported keys and some unknown ones") {
+        const model::Game game = LoadFromString(FULL_CONFIG);
+
+        THEN("game settings are read") {
+            CHECK(game.GetMaxPlayersPerSession() == 4);
+            CHECK(game.GetVisibilityRadius() == 12.5);
+        }
+
+        THEN("maps are read in order") {
+            REQUIRE(game.GetMaps().size() == 2);
+            CHECK(*game.GetMaps()[0].GetId() == "map1"s);
+            CHECK(game.GetMaps()[0].GetName() == "Map 1"s);
+            CHECK(*game.GetMaps()[1].GetId() == "map2"s);
+            CHECK(game.GetMaps()[1].GetName() == "Пустая карта"s);
+            CHECK(game.GetMaps()[1].GetRoads().empty());
+        }
+
+        THEN("roads keep their direction, and keys of nested unknown objects are ignored") {
+            const auto& roads = game.GetMaps()[0].GetRoads();
+            REQUIRE(roads.size() == 2);
+            CHECK(roads[0].IsHorizontal());
+            CHECK(roads[0].GetStart().x == 0);
+            CHECK(roads[0].GetEnd().x == 40);
+            CHECK(roads[1].IsVertical());
+            CHECK(roads[1].GetStart().x == 40);
+            CHECK(roads[1].GetEnd().y == 30);
+        }
+
+        THEN("buildings and offices are read") {
+            const auto& map = game.GetMaps()[0];
+            REQUIRE(map.GetBuildings().size() == 1);
+            const auto& bounds = map.GetBuildings()[0].GetBounds();
+            CHECK(bounds.position.x == 5);
+            CHECK(bounds.position.y == 5);
+            CHECK(bounds.size.width == 30);
+            CHECK(bounds.size.height == 20);
+
+            REQUIRE(map.GetOffices().size() == 1);
+            const auto& office = map.GetOffices()[0];
+            CHECK(*office.GetId() == "o0"s);
+            CHECK(office.GetPosition().x == 40);
+            CHECK(office.GetPosition().y == 30);
+            CHECK(office.GetOffset().dx == 5);
+            CHECK(office.GetOffset().dy == -1);
+        }
+    }
+
+    GIVEN("a config without optional keys") {
+        const model::Game game = LoadFromString(R"({"maps": [{"id": "m", "name": "M"}]})");
+        THEN("defaults are used") {
+            CHECK(game.GetMaxPlayersPerSession() == model::Game::UNLIMITED_PLAYERS);
+            CHECK_FALSE(game.GetVisibilityRadius().has_value());
+            CHECK(game.GetMaps().size() == 1);
+        }
+    }
+
+    GIVEN("configs with missing required fields") {
+        THEN("loading fails") {
+            CHECK_THROWS_AS(LoadFromString(R"({"maps": [{"name": "M"}]})"), std::runtime_error);
+            CHECK_THROWS_AS(LoadFromString(R"({"maps": [{"id": "m"}]})"), std::runtime_error);
+            CHECK_THROWS_AS(LoadFromString(R"({"maps": [{"id": "m", "name": "M", "roads": [{"x0": 0, "y0": 0}]}]})"),
+                            std::runtime_error);
+            CHECK_THROWS_AS(LoadFromString(R"({"maps": [{"id": "m", "name": "M", "buildings": [{"x": 0, "y": 0, "w": 1}]}]})"),
+                            std::runtime_error);
+            CHECK_THROWS_AS(
+                LoadFromString(R"({"maps": [{"id": "m", "name": "M", "offices": [{"id": "o", "x": 0, "y": 0, "offsetX": 1}]}]})"),
+                std::runtime_error);
+        }
+    }
+
+    GIVEN("configs with invalid values") {
+        THEN("loading fails") {
+            CHECK_THROWS(LoadFromString(R"({"maxPlayersPerSession": -1, "maps": []})"));
+            CHECK_THROWS(LoadFromString(R"({"visibilityRadius": 0, "maps": []})"));
+            CHECK_THROWS(LoadFromString(R"({"maps": [{"id": "m", "name": "M", "roads": [{"x0": 3000000000, "y0": 0, "x1": 1}]}]})"));
+            CHECK_THROWS(LoadFromString(R"({"maps": [{"id": "m", "name": "M", "offices": [
+                {"id": "o", "x": 0, "y": 0, "offsetX": 1, "offsetY": 1},
+                {"id": "o", "x": 1, "y": 1, "offsetX": 1, "offsetY": 1}]}]})"));
+        }
+    }
+
+    GIVEN("malformed JSON") {
+        THEN("loading fails") {
+            CHECK_THROWS_AS(LoadFromString(R"({"maps": [{"id": "m", "name": "M"})"), std::runtime_error);
+            CHECK_THROWS_AS(LoadFromString(R"({"maps": [}])"), std::runtime_error);
+            CHECK_THROWS_AS(LoadFromString(R"({"maps": []} {"maps": []})"), std::runtime_error);
+            CHECK_THROWS_AS(LoadFromString(R"({"maps": []} garbage)"), std::runtime_error);
+        }
+
+        THEN("trailing whitespace is accepted") {
+            CHECK(LoadFromString("{\"maps\": []}\n  \n").GetMaps().empty());
+            CHECK(LoadFromString("{\"maps\": []}\r\n\t").GetMaps().empty());
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/player_tokens.h"
+
+using namespace std::literals;
+
+namespace {
+
+app::Token MakeToken(uint64_t n) {
+    return app::Token{n * 0x9E3779B97F4A7C15ull, n};
+}
+
+}  // namespace
+
+SCENARIO("Token parsing") {
+    using app::ParseBearerToken;
+    using app::ParseToken;
+    using app::Token;
+
+    GIVEN("a valid hex token") {
+        const auto hex = "0123456789abcdefFEDCBA9876543210"sv;
+        THEN("it is decoded into two 64-bit halves") {
+            const auto token = ParseToken(hex);
+            REQUIRE(token.has_value());
+            CHECK(token->hi == 0x0123456789abcdefull);
+            CHECK(token->lo == 0xfedcba9876543210ull);
+        }
+        THEN("it is extracted from Bearer authorization") {
+            CHECK(ParseBearerToken("Bearer "s + std::string{hex}) == ParseToken(hex));
+        }
+    }
+
+    GIVEN("an invalid token") {
+        THEN("it is rejected") {
+            CHECK_FALSE(ParseToken(""sv));
+            CHECK_FALSE(ParseToken("0123456789abcdef0123456789abcde"sv));
+            CHECK_FALSE(ParseToken("0123456789abcdef0123456789abcdef0"sv));
+            CHECK_FALSE(ParseToken("0123456789abcdef0123456789abcdeg"sv));
+            CHECK_FALSE(ParseBearerToken("0123456789abcdef0123456789abcdef"sv));
+            CHECK_FALSE(ParseBearerToken("bearer 0123456789abcdef0123456789abcdef"sv));
+        }
+    }
+}
+
+SCENARIO("Concurrent token table") {
+    using Table = app::ConcurrentTokenTable<int>;
+
+    GIVEN("a table") {
+        Table table;
+
+        WHEN("tokens are inserted") {
+            constexpr int COUNT = 1000;
+            for (int i = 0; i < COUNT; ++i) {
+                REQUIRE(table.Insert(MakeToken(i), i));
+            }
+
+            THEN("every token is found after rehashing") {
+                CHECK(table.Size() == COUNT);
+                for (int i = 0; i < COUNT; ++i) {
+                    CHECK(table.Find(MakeToken(i)) == i);
+                }
+                CHECK_FALSE(table.Find(MakeToken(COUNT)));
+            }
+
+            THEN("duplicate tokens are rejected") {
+                CHECK_FALSE(table.Insert(MakeToken(1), -1));
+                CHECK(table.Find(MakeToken(1)) == 1);
+            }
+
+            AND_WHEN("tokens are erased") {
+                for (int i = 0; i < COUNT; i += 2) {
+                    REQUIRE(table.Erase(MakeToken(i)));
+                }
+                THEN("only remaining tokens are found") {
+                    CHECK(table.Size() == COUNT / 2);
+                    CHECK_FALSE(table.Erase(MakeToken(0)));
+                    for (int i = 0; i < COUNT; ++i) {
+                        CHECK(table.Find(MakeToken(i)).has_value() == (i % 2 == 1));
+                    }
+                }
+            }
+        }
+
+        WHEN("readers run concurrently with writers") {
+            constexpr int STABLE_COUNT = 100;
+            for (int i = 0; i < STABLE_COUNT; ++i) {
+                table.Insert(MakeToken(i), i);
+            }
+
+            std::atomic_bool stop{false};
+            std::atomic_int errors{0};
+            std::vector<std::jthread> readers;
+            for (int r = 0; r < 4; ++r) {
+                readers.emplace_back([&] {
+                    while (!stop) {
+                        for (int i = 0; i < STABLE_COUNT; ++i) {
+                            if (table.Find(MakeToken(i)) != i) {
+                                ++errors;
+                            }
+                        }
+                    }
+                });
+            }
+            for (int i = STABLE_COUNT; i < STABLE_COUNT + 5000; ++i) {
+                table.Insert(MakeToken(i), i);
+                table.Erase(MakeToken(i - 1 > STABLE_COUNT ? i - 1 : i));
+            }
+            stop = true;
+            readers.clear();
+
+            THEN("stable tokens are always visible") {
+                CHECK(errors == 0);
+            }
+        }
+    }
+}
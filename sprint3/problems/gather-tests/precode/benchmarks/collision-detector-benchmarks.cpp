@@ -0,0 +1,357 @@
+#include "../src/collision_detector.h"
+#include "../src/gathering_engine.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+
+/*
+ * Нагрузочные тесты детектора столкновений.
+ *
+ * Все наборы данных строятся генератором с фиксированным зерном, а параметры
+ * набора входят в имя теста, поэтому результаты запусков в формате JSON
+ * (--benchmark_format=json) можно сравнивать между версиями детектора,
+ * например утилитой compare.py из Google Benchmark.
+ *
+ * Счётчики:
+ *   time_per_pair     - время в секундах на одну пару собиратель-предмет,
+ *                       как если бы проверялись все пары;
+ *   events_per_second - найденные события сбора в секунду.
+ */
+
+namespace {
+
+using namespace collision_detector;
+
+class VectorItemGathererProvider : public ItemGathererProvider {
+public:
+    VectorItemGathererProvider(std::vector<Item> items, std::vector<Gatherer> gatherers)
+        : items_(std::move(items))
+        , gatherers_(std::move(gatherers)) {
+    }
+
+    size_t ItemsCount() const override {
+        return items_.size();
+    }
+    Item GetItem(size_t idx) const override {
+        return items_[idx];
+    }
+    size_t GatherersCount() const override {
+        return gatherers_.size();
+    }
+    Gatherer GetGatherer(size_t idx) const override {
+        return gatherers_[idx];
+    }
+
+private:
+    std::vector<Item> items_;
+    std::vector<Gatherer> gatherers_;
+};
+
+enum class Layout {
+    // Предметы и собиратели равномерно разбросаны по карте
+    UNIFORM,
+    // Предметы и собиратели сосредоточены вокруг нескольких точек карты
+    CLUSTERED,
+};
+
+// Длина перемещения собирателя за такт
+constexpr double SHORT_MOVE = 1.0;
+constexpr double LONG_MOVE = 50.0;
+
+constexpr double GATHERER_WIDTH = 0.6;
+constexpr double ITEM_WIDTH = 0.0;
+
+struct Workload {
+    size_t item_count;
+    size_t gatherer_count;
+    Layout layout;
+    double max_move;
+};
+
+/*
+ * Строит набор данных. Сторона карты растёт как квадратный корень из числа
+ * предметов, чтобы плотность предметов, а значит и доля подобранных, не зависела
+ * от размера набора. Собиратели движутся вдоль осей, как собаки по дорогам.
+ */
+VectorItemGathererProvider MakeWorld(const Workload& workload) {
+    constexpr size_t CLUSTER_COUNT = 16;
+    std::mt19937_64 rng{42};
+
+    const double world_size = std::max(100.0, std::sqrt(static_cast<double>(workload.item_count)) * 10);
+    std::uniform_real_distribution<double> coord{0, world_size};
+    std::vector<geom::Point2D> cluster_centers;
+    for (size_t i = 0; i < CLUSTER_COUNT; ++i) {
+        cluster_centers.emplace_back(coord(rng), coord(rng));
+    }
+    std::uniform_int_distribution<size_t> cluster{0, CLUSTER_COUNT - 1};
+    std::normal_distribution<double> spread{0, world_size / 50};
+
+    const auto random_point = [&]() -> geom::Point2D {
+        if (workload.layout == Layout::UNIFORM) {
+            return {coord(rng), coord(rng)};
+        }
+        const geom::Point2D center = cluster_centers[cluster(rng)];
+        return {center.x + spread(rng), center.y + spread(rng)};
+    };
+
+    std::vector<Item> items;
+    items.reserve(workload.item_count);
+    for (size_t i = 0; i < workload.item_count; ++i) {
+        items.push_back({random_point(), ITEM_WIDTH});
+    }
+
+    std::uniform_real_distribution<double> move{workload.max_move / 2, workload.max_move};
+    std::bernoulli_distribution coin;
+    std::vector<Gatherer> gatherers;
+    gatherers.reserve(workload.gatherer_count);
+    for (size_t i = 0; i < workload.gatherer_count; ++i) {
+        const geom::Point2D start = random_point();
+        const double distance = coin(rng) ? move(rng) : -move(rng);
+        const geom::Point2D end =
+            coin(rng) ? geom::Point2D{start.x + distance, start.y} : geom::Point2D{start.x, start.y + distance};
+        gatherers.push_back({start, end, GATHERER_WIDTH});
+    }
+    return {std::move(items), std::move(gatherers)};
+}
+
+Workload WorkloadFromArgs(const benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    return {size, size, state.range(1) ? Layout::CLUSTERED : Layout::UNIFORM,
+            state.range(2) ? LONG_MOVE : SHORT_MOVE};
+}
+
+void SetCounters(benchmark::State& state, size_t pairs_per_iteration, size_t events_per_iteration) {
+    const auto iterations = static_cast<double>(state.iterations());
+    state.counters["time_per_pair"] =
+        benchmark::Counter(iterations * static_cast<double>(pairs_per_iteration),
+                           benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["events_per_second"] =
+        benchmark::Counter(iterations * static_cast<double>(events_per_iteration), benchmark::Counter::kIsRate);
+}
+
+// Полный перебор пар с поэлементным доступом через виртуальные функции
+size_t CountCollectedPairs(const ItemGathererProvider& provider) {
+    size_t collected = 0;
+    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
+        const Gatherer gatherer = provider.GetGatherer(g);
+        for (size_t i = 0; i < provider.ItemsCount(); ++i) {
+            const Item item = provider.GetItem(i);
+            const auto result = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+            collected += result.IsCollected(gatherer.width + item.width);
+        }
+    }
+    return collected;
+}
+
+// Полный перебор пар по непрерывным массивам
+size_t CountCollectedPairs(const SpanItemGathererProvider& provider) {
+    const ItemsSpan items = provider.GetItems();
+    const GatherersSpan gatherers = provider.GetGatherers();
+    size_t collected = 0;
+    for (size_t g = 0; g < gatherers.size(); ++g) {
+        const geom::Point2D start{gatherers.start_x[g], gatherers.start_y[g]};
+        const geom::Point2D end{gatherers.end_x[g], gatherers.end_y[g]};
+        for (size_t i = 0; i < items.size(); ++i) {
+            const auto result = TryCollectPoint(start, end, {items.x[i], items.y[i]});
+            collected += result.IsCollected(gatherers.width[g] + items.width[i]);
+        }
+    }
+    return collected;
+}
+
+void BM_FindGatherEvents(benchmark::State& state) {
+    const Workload workload = WorkloadFromArgs(state);
+    const auto buffer = GatheringBuffer::From(MakeWorld(workload));
+    size_t events = 0;
+    for (auto _ : state) {
+        const auto result = FindGatherEvents(buffer);
+        events = result.size();
+        benchmark::DoNotOptimize(result.data());
+    }
+    SetCounters(state, workload.item_count * workload.gatherer_count, events);
+}
+
+void BM_FindGatherEventsSequential(benchmark::State& state) {
+    const Workload workload = WorkloadFromArgs(state);
+    const auto buffer = GatheringBuffer::From(MakeWorld(workload));
+    size_t events = 0;
+    for (auto _ : state) {
+        const auto result = FindGatherEvents(buffer, {.max_threads = 1});
+        events = result.size();
+        benchmark::DoNotOptimize(result.data());
+    }
+    SetCounters(state, workload.item_count * workload.gatherer_count, events);
+}
+
+// Доступ к данным через поэлементный интерфейс с копированием в буфер
+void BM_FindGatherEventsVirtualProvider(benchmark::State& state) {
+    const Workload workload = WorkloadFromArgs(state);
+    const auto provider = MakeWorld(workload);
+    size_t events = 0;
+    for (auto _ : state) {
+        const auto result = FindGatherEvents(provider);
+        events = result.size();
+        benchmark::DoNotOptimize(result.data());
+    }
+    SetCounters(state, workload.item_count * workload.gatherer_count, events);
+}
+
+void BM_AllPairsVirtualProvider(benchmark::State& state) {
+    const Workload workload = WorkloadFromArgs(state);
+    const auto provider = MakeWorld(workload);
+    size_t events = 0;
+    for (auto _ : state) {
+        events = CountCollectedPairs(provider);
+        benchmark::DoNotOptimize(events);
+    }
+    SetCounters(state, workload.item_count * workload.gatherer_count, events);
+}
+
+void BM_AllPairsSpanProvider(benchmark::State& state) {
+    const Workload workload = WorkloadFromArgs(state);
+    const auto buffer = GatheringBuffer::From(MakeWorld(workload));
+    size_t events = 0;
+    for (auto _ : state) {
+        events = CountCollectedPairs(buffer);
+        benchmark::DoNotOptimize(events);
+    }
+    SetCounters(state, workload.item_count * workload.gatherer_count, events);
+}
+
+void BM_FindGatherEventsThreads(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    const auto threads = static_cast<size_t>(state.range(1));
+    const auto buffer = GatheringBuffer::From(MakeWorld({size, size, Layout::UNIFORM, SHORT_MOVE}));
+    size_t events = 0;
+    for (auto _ : state) {
+        const auto result = FindGatherEvents(buffer, {.max_threads = threads});
+        events = result.size();
+        benchmark::DoNotOptimize(result.data());
+    }
+    SetCounters(state, size * size, events);
+}
+
+// Такт, в котором двигается лишь каждый сотый собиратель, а предметов
+// появляется и исчезает немного. Движок не перестраивает сетку с нуля
+void BM_GatheringEngineTick(benchmark::State& state) {
+    const Workload workload = WorkloadFromArgs(state);
+    const auto world = GatheringBuffer::From(MakeWorld(workload));
+    const ItemsSpan items = world.GetItems();
+    const GatherersSpan gatherers = world.GetGatherers();
+
+    GatheringEngine engine{{}, LONG_MOVE / 2};
+    std::vector<GatheringEngine::ItemId> ids;
+    for (size_t i = 0; i < items.size(); ++i) {
+        ids.push_back(engine.AddItem({{items.x[i], items.y[i]}, items.width[i]}));
+    }
+
+    size_t events = 0;
+    size_t tick = 0;
+    for (auto _ : state) {
+        for (size_t g = tick % 100; g < gatherers.size(); g += 100) {
+            engine.MoveGatherer(g, {gatherers.start_x[g], gatherers.start_y[g]},
+                                {gatherers.end_x[g], gatherers.end_y[g]}, gatherers.width[g]);
+        }
+        const auto result = engine.Tick();
+        events = result.gathering.size();
+        // Один предмет исчезает и появляется заново
+        const size_t replaced = tick % ids.size();
+        engine.RemoveItem(ids[replaced]);
+        ids[replaced] = engine.AddItem({{items.x[replaced], items.y[replaced]}, items.width[replaced]});
+        ++tick;
+    }
+    SetCounters(state, workload.item_count * workload.gatherer_count, events);
+}
+
+// Один собиратель проверяет все предметы набора
+template <void (*Kernel)(geom::Point2D, geom::Point2D, double, const ItemsSpan&, CollectedItems&)>
+void BM_TryCollectPoints(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    // Предметы густо лежат вокруг отрезка, чтобы часть из них подбиралась
+    std::mt19937_64 rng{42};
+    std::uniform_real_distribution<double> coord{0, 10};
+    GatheringBuffer buffer;
+    for (size_t i = 0; i < size; ++i) {
+        buffer.AddItem({{coord(rng), coord(rng)}, ITEM_WIDTH});
+    }
+    CollectedItems hits;
+    for (auto _ : state) {
+        hits.clear();
+        Kernel({0, 5}, {10, 5}, GATHERER_WIDTH, buffer.GetItems(), hits);
+        benchmark::DoNotOptimize(hits.ids.data());
+    }
+    SetCounters(state, size, hits.size());
+}
+
+// Проверка по одной точке, как до появления пакетной версии
+void BM_TryCollectPoint(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    std::mt19937_64 rng{42};
+    std::uniform_real_distribution<double> coord{0, 10};
+    std::vector<geom::Point2D> points;
+    for (size_t i = 0; i < size; ++i) {
+        points.emplace_back(coord(rng), coord(rng));
+    }
+    size_t collected = 0;
+    for (auto _ : state) {
+        collected = 0;
+        for (const auto& point : points) {
+            collected += TryCollectPoint({0, 5}, {10, 5}, point).IsCollected(GATHERER_WIDTH + ITEM_WIDTH);
+        }
+        benchmark::DoNotOptimize(collected);
+    }
+    SetCounters(state, size, collected);
+}
+
+// Размер набора: от 10 до 1M предметов и собирателей
+const std::vector<int64_t> SIZES = {10, 100, 1'000, 10'000, 100'000, 1'000'000};
+// Полный перебор пар на больших наборах длится слишком долго
+const std::vector<int64_t> ALL_PAIRS_SIZES = {10, 100, 1'000, 10'000};
+
+void WorkloadArgs(benchmark::internal::Benchmark* benchmark, const std::vector<int64_t>& sizes) {
+    benchmark->ArgNames({"n", "clustered", "long_moves"})
+        ->ArgsProduct({sizes, {0, 1}, {0, 1}})
+        ->Unit(benchmark::kMicrosecond);
+}
+
+}  // namespace
+
+BENCHMARK(BM_FindGatherEvents)->Apply([](auto* b) {
+    WorkloadArgs(b, SIZES);
+})->UseRealTime();
+BENCHMARK(BM_FindGatherEventsSequential)->Apply([](auto* b) {
+    WorkloadArgs(b, SIZES);
+});
+BENCHMARK(BM_FindGatherEventsVirtualProvider)->Apply([](auto* b) {
+    WorkloadArgs(b, SIZES);
+});
+BENCHMARK(BM_AllPairsVirtualProvider)->Apply([](auto* b) {
+    WorkloadArgs(b, ALL_PAIRS_SIZES);
+});
+BENCHMARK(BM_AllPairsSpanProvider)->Apply([](auto* b) {
+    WorkloadArgs(b, ALL_PAIRS_SIZES);
+});
+BENCHMARK(BM_GatheringEngineTick)->Apply([](auto* b) {
+    WorkloadArgs(b, SIZES);
+});
+BENCHMARK(BM_FindGatherEventsThreads)
+    ->ArgNames({"n", "threads"})
+    ->ArgsProduct({{10'000, 100'000, 1'000'000}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_TryCollectPoint)->ArgName("n")->RangeMultiplier(10)->Range(10, 1'000'000);
+BENCHMARK_TEMPLATE(BM_TryCollectPoints, TryCollectPointsScalar)->ArgName("n")->RangeMultiplier(10)->Range(10, 1'000'000);
+BENCHMARK_TEMPLATE(BM_TryCollectPoints, TryCollectPoints)->ArgName("n")->RangeMultiplier(10)->Range(10, 1'000'000);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    // Результаты векторной и скалярной реализации нельзя сравнивать между собой
+    benchmark::AddCustomContext("collect_kernel", HasVectorCollectKernel() ? "avx2" : "scalar");
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -1,32 +1,443 @@
-#include "collision_detector.h"
-#include <cassert>
-
-namespace collision_detector {
-
-CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c) {
-    // Проверим, что перемещение ненулевое.
-    // Тут приходится использовать строгое равенство, а не приближённое,
-    // пскольку при сборе заказов придётся учитывать перемещение даже на небольшое
-    // расстояние.
-    assert(b.x != a.x || b.y != a.y);
-    const double u_x = c.x - a.x;
-    const double u_y = c.y - a.y;
-    const double v_x = b.x - a.x;
-    const double v_y = b.y - a.y;
-    const double u_dot_v = u_x * v_x + u_y * v_y;
-    const double u_len2 = u_x * u_x + u_y * u_y;
-    const double v_len2 = v_x * v_x + v_y * v_y;
-    const double proj_ratio = u_dot_v / v_len2;
-    const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / v_len2;
-
-    return CollectionResult(sq_distance, proj_ratio);
-}
-
-// В задании на разработку тестов реализовывать следующую функцию не нужно -
-// она будет линковаться извне.
-/*
-std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
-}
-*/
-
+#include "collision_detector.h"
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define COLLISION_DETECTOR_HAS_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+namespace collision_detector {
+
+CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c) {
+    // Проверим, что перемещение ненулевое.
+    // Тут приходится использовать строгое равенство, а не приближённое,
+    // пскольку при сборе заказов придётся учитывать перемещение даже на небольшое
+    // расстояние.
+    assert(b.x != a.x || b.y != a.y);
+    const double u_x = c.x - a.x;
+    const double u_y = c.y - a.y;
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const double u_dot_v = u_x * v_x + u_y * v_y;
+    const double u_len2 = u_x * u_x + u_y * u_y;
+    const double v_len2 = v_x * v_x + v_y * v_y;
+    const double proj_ratio = u_dot_v / v_len2;
+    const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / v_len2;
+
+    return CollectionResult(sq_distance, proj_ratio);
+}
+
+GatheringBuffer GatheringBuffer::From(const ItemGathererProvider& provider) {
+    GatheringBuffer buffer;
+    buffer.Reserve(provider.ItemsCount(), provider.GatherersCount());
+    for (size_t idx = 0; idx < provider.ItemsCount(); ++idx) {
+        buffer.AddItem(provider.GetItem(idx));
+    }
+    for (size_t idx = 0; idx < provider.GatherersCount(); ++idx) {
+        buffer.AddGatherer(provider.GetGatherer(idx));
+    }
+    return buffer;
+}
+
+void GatheringBuffer::Reserve(size_t items, size_t gatherers) {
+    item_x_.reserve(items);
+    item_y_.reserve(items);
+    item_width_.reserve(items);
+    start_x_.reserve(gatherers);
+    start_y_.reserve(gatherers);
+    end_x_.reserve(gatherers);
+    end_y_.reserve(gatherers);
+    gatherer_width_.reserve(gatherers);
+}
+
+void GatheringBuffer::AddItem(const Item& item) {
+    item_x_.push_back(item.position.x);
+    item_y_.push_back(item.position.y);
+    item_width_.push_back(item.width);
+}
+
+void GatheringBuffer::AddGatherer(const Gatherer& gatherer) {
+    start_x_.push_back(gatherer.start_pos.x);
+    start_y_.push_back(gatherer.start_pos.y);
+    end_x_.push_back(gatherer.end_pos.x);
+    end_y_.push_back(gatherer.end_pos.y);
+    gatherer_width_.push_back(gatherer.width);
+}
+
+void GatheringBuffer::Clear() noexcept {
+    for (auto* column : {&item_x_, &item_y_, &item_width_, &start_x_, &start_y_, &end_x_, &end_y_,
+                         &gatherer_width_}) {
+        column->clear();
+    }
+}
+
+void TryCollectPointsScalar(geom::Point2D a, geom::Point2D b, double gatherer_width,
+                            const ItemsSpan& items, CollectedItems& out) {
+    for (size_t idx = 0; idx < items.size(); ++idx) {
+        const auto result = TryCollectPoint(a, b, {items.x[idx], items.y[idx]});
+        if (result.IsCollected(gatherer_width + items.width[idx])) {
+            out.ids.push_back(idx);
+            out.sq_distances.push_back(result.sq_distance);
+            out.proj_ratios.push_back(result.proj_ratio);
+        }
+    }
+}
+
+#ifdef COLLISION_DETECTOR_HAS_AVX2_KERNEL
+
+namespace {
+
+// Повторяет вычисления TryCollectPoint и IsCollected операция в операцию.
+// FMA не используется, иначе округление разошлось бы со скалярной версией
+__attribute__((target("avx2"))) void TryCollectPointsAvx2(geom::Point2D a, geom::Point2D b,
+                                                          double gatherer_width, const ItemsSpan& items,
+                                                          CollectedItems& out) {
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const double v_len2 = v_x * v_x + v_y * v_y;
+
+    const __m256d a_x4 = _mm256_set1_pd(a.x);
+    const __m256d a_y4 = _mm256_set1_pd(a.y);
+    const __m256d v_x4 = _mm256_set1_pd(v_x);
+    const __m256d v_y4 = _mm256_set1_pd(v_y);
+    const __m256d v_len2_4 = _mm256_set1_pd(v_len2);
+    const __m256d width4 = _mm256_set1_pd(gatherer_width);
+    const __m256d zero4 = _mm256_setzero_pd();
+    const __m256d one4 = _mm256_set1_pd(1.0);
+
+    const size_t count = items.size();
+    size_t idx = 0;
+    for (; idx + 4 <= count; idx += 4) {
+        const __m256d u_x = _mm256_sub_pd(_mm256_loadu_pd(items.x.data() + idx), a_x4);
+        const __m256d u_y = _mm256_sub_pd(_mm256_loadu_pd(items.y.data() + idx), a_y4);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(u_x, v_x4), _mm256_mul_pd(u_y, v_y4));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(u_x, u_x), _mm256_mul_pd(u_y, u_y));
+        const __m256d proj_ratio = _mm256_div_pd(u_dot_v, v_len2_4);
+        const __m256d sq_distance =
+            _mm256_sub_pd(u_len2, _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), v_len2_4));
+        const __m256d radius = _mm256_add_pd(width4, _mm256_loadu_pd(items.width.data() + idx));
+
+        const __m256d collected = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(proj_ratio, zero4, _CMP_GE_OQ),
+                          _mm256_cmp_pd(proj_ratio, one4, _CMP_LE_OQ)),
+            _mm256_cmp_pd(sq_distance, _mm256_mul_pd(radius, radius), _CMP_LE_OQ));
+
+        int mask = _mm256_movemask_pd(collected);
+        if (mask == 0) {
+            continue;
+        }
+        alignas(32) double sq_distances[4];
+        alignas(32) double proj_ratios[4];
+        _mm256_store_pd(sq_distances, sq_distance);
+        _mm256_store_pd(proj_ratios, proj_ratio);
+        while (mask != 0) {
+            const int lane = __builtin_ctz(static_cast<unsigned>(mask));
+            out.ids.push_back(idx + lane);
+            out.sq_distances.push_back(sq_distances[lane]);
+            out.proj_ratios.push_back(proj_ratios[lane]);
+            mask &= mask - 1;
+        }
+    }
+
+    if (idx < count) {
+        const size_t first_tail = out.size();
+        TryCollectPointsScalar(a, b, gatherer_width,
+                               {items.x.subspan(idx), items.y.subspan(idx), items.width.subspan(idx)}, out);
+        for (size_t hit = first_tail; hit < out.size(); ++hit) {
+            out.ids[hit] += idx;
+        }
+    }
+}
+
+}  // namespace
+
+#endif
+
+bool HasVectorCollectKernel() noexcept {
+#ifdef COLLISION_DETECTOR_HAS_AVX2_KERNEL
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+#else
+    return false;
+#endif
+}
+
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, double gatherer_width, const ItemsSpan& items,
+                      CollectedItems& out) {
+    assert(b.x != a.x || b.y != a.y);
+#ifdef COLLISION_DETECTOR_HAS_AVX2_KERNEL
+    if (HasVectorCollectKernel()) {
+        TryCollectPointsAvx2(a, b, gatherer_width, items, out);
+        return;
+    }
+#endif
+    TryCollectPointsScalar(a, b, gatherer_width, items, out);
+}
+
+BoundingBox GetCollectBounds(geom::Point2D a, geom::Point2D b, double radius) noexcept {
+    // Запас на погрешность вычисления sq_distance, чтобы широкая фаза
+    // не отбросила предмет, который точная проверка сочла бы подобранным
+    const double magnitude = std::max({std::abs(a.x), std::abs(a.y), std::abs(b.x), std::abs(b.y)});
+    const double reach = radius * (1 + 1e-9) + magnitude * 1e-12;
+    return {{std::min(a.x, b.x) - reach, std::min(a.y, b.y) - reach},
+            {std::max(a.x, b.x) + reach, std::max(a.y, b.y) + reach}};
+}
+
+namespace {
+
+// Первый корень уравнения |d + t * v|^2 = radius^2 на отрезке [0, 1] при условии,
+// что в момент 0 расстояние больше radius
+std::optional<double> FirstApproach(geom::Vec2D d, geom::Vec2D v, double radius) noexcept {
+    const double c = d.x * d.x + d.y * d.y - radius * radius;
+    const double a = v.x * v.x + v.y * v.y;
+    if (c <= 0 || a == 0) {
+        return std::nullopt;
+    }
+    const double b = d.x * v.x + d.y * v.y;
+    const double discriminant = b * b - a * c;
+    if (b >= 0 || discriminant < 0) {
+        return std::nullopt;
+    }
+    const double time = (-b - std::sqrt(discriminant)) / a;
+    if (time < 0 || time > 1) {
+        return std::nullopt;
+    }
+    return time;
+}
+
+}  // namespace
+
+std::optional<ContactEvent> TryContact(const Gatherer& a, const Gatherer& b) noexcept {
+    // Движение a относительно b
+    const geom::Vec2D d{a.start_pos.x - b.start_pos.x, a.start_pos.y - b.start_pos.y};
+    const geom::Vec2D v{(a.end_pos.x - a.start_pos.x) - (b.end_pos.x - b.start_pos.x),
+                        (a.end_pos.y - a.start_pos.y) - (b.end_pos.y - b.start_pos.y)};
+    const auto time = FirstApproach(d, v, a.width + b.width);
+    if (!time) {
+        return std::nullopt;
+    }
+    // Наибольшее сближение происходит в точке проекции на прямую движения
+    const double v_len2 = v.x * v.x + v.y * v.y;
+    const double closest = std::clamp(-(d.x * v.x + d.y * v.y) / v_len2, 0.0, 1.0);
+    const double x = d.x + closest * v.x;
+    const double y = d.y + closest * v.y;
+    return ContactEvent{0, 0, x * x + y * y, *time};
+}
+
+std::optional<double> TryEnterZone(const Gatherer& gatherer, const Zone& zone) noexcept {
+    const geom::Vec2D d{gatherer.start_pos.x - zone.center.x, gatherer.start_pos.y - zone.center.y};
+    const geom::Vec2D v{gatherer.end_pos.x - gatherer.start_pos.x, gatherer.end_pos.y - gatherer.start_pos.y};
+    return FirstApproach(d, v, zone.radius + gatherer.width);
+}
+
+namespace {
+
+/*
+ * Равномерная сетка предметов для широкой фазы поиска столкновений.
+ *
+ * Предмет c может быть подобран собирателем, только если он лежит внутри
+ * ограничивающего прямоугольника отрезка перемещения, расширенного на сумму
+ * ширин. Поэтому точную проверку достаточно выполнить лишь для предметов из
+ * ячеек, которые этот прямоугольник пересекает.
+ *
+ * Предметы переупорядочены по ячейкам, так что предметы одной ячейки лежат
+ * в столбцах подряд и проверяются пакетно.
+ */
+class ItemGrid {
+public:
+    ItemGrid(const ItemsSpan& items, double cell_size)
+        : cell_size_{cell_size} {
+        std::vector<std::pair<int64_t, size_t>> keys;
+        keys.reserve(items.size());
+        for (size_t idx = 0; idx < items.size(); ++idx) {
+            keys.emplace_back(CellKey(CellCoord(items.x[idx]), CellCoord(items.y[idx])), idx);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        ids_.reserve(items.size());
+        x_.reserve(items.size());
+        y_.reserve(items.size());
+        width_.reserve(items.size());
+        for (size_t pos = 0; pos < keys.size(); ++pos) {
+            const auto [key, idx] = keys[pos];
+            if (pos == 0 || keys[pos - 1].first != key) {
+                cells_.emplace(key, CellRange{pos, pos});
+            }
+            ++cells_[key].end;
+            ids_.push_back(idx);
+            x_.push_back(items.x[idx]);
+            y_.push_back(items.y[idx]);
+            width_.push_back(items.width[idx]);
+        }
+    }
+
+    // Вызывает fn(cell_items, cell_ids) для ячеек, пересекающих прямоугольник.
+    // cell_ids[i] - номер предмета cell_items[i] в исходном массиве.
+    // Возвращает false, не вызывая fn, если ячеек больше, чем непустых ячеек сетки
+    template <typename Fn>
+    bool ForEachCellInBox(geom::Point2D min, geom::Point2D max, Fn&& fn) const {
+        const int64_t min_x = CellCoord(min.x);
+        const int64_t max_x = CellCoord(max.x);
+        const int64_t min_y = CellCoord(min.y);
+        const int64_t max_y = CellCoord(max.y);
+        if (double(max_x - min_x + 1) * double(max_y - min_y + 1) > double(cells_.size())) {
+            return false;
+        }
+        for (int64_t cx = min_x; cx <= max_x; ++cx) {
+            for (int64_t cy = min_y; cy <= max_y; ++cy) {
+                if (const auto it = cells_.find(CellKey(cx, cy)); it != cells_.end()) {
+                    const auto [begin, end] = it->second;
+                    const size_t size = end - begin;
+                    fn(ItemsSpan{std::span{x_}.subspan(begin, size), std::span{y_}.subspan(begin, size),
+                                 std::span{width_}.subspan(begin, size)},
+                       std::span{ids_}.subspan(begin, size));
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    struct CellRange {
+        size_t begin;
+        size_t end;
+    };
+
+    int64_t CellCoord(double coord) const noexcept {
+        return static_cast<int64_t>(std::floor(coord / cell_size_));
+    }
+
+    static int64_t CellKey(int64_t cx, int64_t cy) noexcept {
+        return (cx << 32) ^ (cy & 0xFFFFFFFF);
+    }
+
+    double cell_size_;
+    std::unordered_map<int64_t, CellRange> cells_;
+    std::vector<size_t> ids_;
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> width_;
+};
+
+// Размер ячейки выбирается порядка среднего перемещения собирателя, но не меньше
+// радиуса сбора, чтобы прямоугольник типичного отрезка покрывал несколько ячеек
+double ChooseCellSize(const GatherersSpan& gatherers, double max_item_width) {
+    double extent_sum = 0;
+    double max_width = 0;
+    for (size_t idx = 0; idx < gatherers.size(); ++idx) {
+        extent_sum += std::max(std::abs(gatherers.end_x[idx] - gatherers.start_x[idx]),
+                               std::abs(gatherers.end_y[idx] - gatherers.start_y[idx]));
+        max_width = std::max(max_width, gatherers.width[idx]);
+    }
+    const double mean_extent = gatherers.size() == 0 ? 0 : extent_sum / gatherers.size();
+    const double cell_size = std::max(mean_extent, 2 * (max_width + max_item_width));
+    return cell_size > 0 && std::isfinite(cell_size) ? cell_size : 1.0;
+}
+
+// Находит события собирателей с номерами [first, last) и упорядочивает их
+std::vector<GatheringEvent> FindGatherEventsInRange(const ItemGrid& grid, const ItemsSpan& items,
+                                                    double max_item_width, const GatherersSpan& gatherers,
+                                                    size_t first, size_t last) {
+    std::vector<GatheringEvent> events;
+    CollectedItems hits;
+
+    for (size_t gatherer_id = first; gatherer_id < last; ++gatherer_id) {
+        const geom::Point2D start{gatherers.start_x[gatherer_id], gatherers.start_y[gatherer_id]};
+        const geom::Point2D end{gatherers.end_x[gatherer_id], gatherers.end_y[gatherer_id]};
+        const double width = gatherers.width[gatherer_id];
+        // Собиратель, который не двигался, ничего не подбирает
+        if (start.x == end.x && start.y == end.y) {
+            continue;
+        }
+
+        const auto collect = [&](const ItemsSpan& candidates, std::span<const size_t> ids) {
+            hits.clear();
+            TryCollectPoints(start, end, width, candidates, hits);
+            for (size_t hit = 0; hit < hits.size(); ++hit) {
+                const size_t item_id = ids.empty() ? hits.ids[hit] : ids[hits.ids[hit]];
+                events.push_back({item_id, gatherer_id, hits.sq_distances[hit], hits.proj_ratios[hit]});
+            }
+        };
+
+        const auto [min, max] = GetCollectBounds(start, end, width + max_item_width);
+        if (!grid.ForEachCellInBox(min, max, collect)) {
+            // Прямоугольник покрывает больше ячеек, чем заполнено в сетке
+            collect(items, {});
+        }
+    }
+
+    // Порядок событий не должен зависеть от обхода сетки
+    std::sort(events.begin(), events.end(), GatheringEventLess);
+    return events;
+}
+
+}  // namespace
+
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
+    return FindGatherEvents(provider, GatheringParallelism{});
+}
+
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider,
+                                             const GatheringParallelism& parallelism) {
+    return FindGatherEvents(GatheringBuffer::From(provider), parallelism);
+}
+
+std::vector<GatheringEvent> FindGatherEvents(const SpanItemGathererProvider& provider,
+                                             const GatheringParallelism& parallelism) {
+    const ItemsSpan items = provider.GetItems();
+    const GatherersSpan gatherers = provider.GetGatherers();
+    assert(items.y.size() == items.size() && items.width.size() == items.size());
+    assert(gatherers.start_y.size() == gatherers.size() && gatherers.end_x.size() == gatherers.size()
+           && gatherers.end_y.size() == gatherers.size() && gatherers.width.size() == gatherers.size());
+
+    if (items.size() == 0 || gatherers.size() == 0) {
+        return {};
+    }
+
+    const double max_item_width = *std::max_element(items.width.begin(), items.width.end());
+    const ItemGrid grid{items, ChooseCellSize(gatherers, max_item_width)};
+
+    // hardware_concurrency обращается к системе, поэтому вычисляется однажды
+    static const size_t hardware_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t max_threads = parallelism.max_threads != 0 ? parallelism.max_threads : hardware_threads;
+    const size_t thread_count = std::clamp<size_t>(
+        gatherers.size() / std::max<size_t>(parallelism.min_gatherers_per_thread, 1), 1, max_threads);
+    if (thread_count == 1) {
+        return FindGatherEventsInRange(grid, items, max_item_width, gatherers, 0, gatherers.size());
+    }
+
+    // Каждый поток обрабатывает свой непрерывный диапазон собирателей.
+    // Первый диапазон обрабатывает вызывающий поток
+    const auto range_begin = [&](size_t part) {
+        return gatherers.size() * part / thread_count;
+    };
+    std::vector<std::future<std::vector<GatheringEvent>>> parts;
+    parts.reserve(thread_count - 1);
+    for (size_t part = 1; part < thread_count; ++part) {
+        parts.push_back(std::async(std::launch::async, FindGatherEventsInRange, std::cref(grid),
+                                   std::cref(items), max_item_width, std::cref(gatherers),
+                                   range_begin(part), range_begin(part + 1)));
+    }
+    std::vector<GatheringEvent> events =
+        FindGatherEventsInRange(grid, items, max_item_width, gatherers, 0, range_begin(1));
+
+    // Каждая часть уже упорядочена, а ключ (time, gatherer_id, item_id) уникален,
+    // поэтому результат слияния совпадает с последовательным поиском
+    for (auto& part : parts) {
+        const std::vector<GatheringEvent> part_events = part.get();
+        const auto middle = static_cast<std::ptrdiff_t>(events.size());
+        events.insert(events.end(), part_events.begin(), part_events.end());
+        std::inplace_merge(events.begin(), events.begin() + middle, events.end(), GatheringEventLess);
+    }
+    return events;
+}
+
 }  // namespace collision_detector
\ No newline at end of file
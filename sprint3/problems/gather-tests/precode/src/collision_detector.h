@@ -1,59 +1,242 @@
-#pragma once
-
-#include "geom.h"
-
-#include <algorithm>
-#include <vector>
-
-namespace collision_detector {
-
-struct CollectionResult {
-    bool IsCollected(double collect_radius) const {
-        return proj_ratio >= 0 && proj_ratio <= 1 && sq_distance <= collect_radius * collect_radius;
-    }
-
-    // квадрат расстояния до точки
-    double sq_distance;
-
-    // доля пройденного отрезка
-    double proj_ratio;
-};
-
-// Движемся из точки a в точку b и пытаемся подобрать точку c.
-// Эта функция реализована в уроке.
-CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c);
-
-struct Item {
-    geom::Point2D position;
-    double width;
-};
-
-struct Gatherer {
-    geom::Point2D start_pos;
-    geom::Point2D end_pos;
-    double width;
-};
-
-class ItemGathererProvider {
-protected:
-    ~ItemGathererProvider() = default;
-
-public:
-    virtual size_t ItemsCount() const = 0;
-    virtual Item GetItem(size_t idx) const = 0;
-    virtual size_t GatherersCount() const = 0;
-    virtual Gatherer GetGatherer(size_t idx) const = 0;
-};
-
-struct GatheringEvent {
-    size_t item_id;
-    size_t gatherer_id;
-    double sq_distance;
-    double time;
-};
-
-// Эту функцию вам нужно будет реализовать в соответствующем задании.
-// При проверке ваших тестов она не нужна - функция будет линковаться снаружи.
-std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
-
+#pragma once
+
+#include "geom.h"
+
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace collision_detector {
+
+struct CollectionResult {
+    bool IsCollected(double collect_radius) const {
+        return proj_ratio >= 0 && proj_ratio <= 1 && sq_distance <= collect_radius * collect_radius;
+    }
+
+    // квадрат расстояния до точки
+    double sq_distance;
+
+    // доля пройденного отрезка
+    double proj_ratio;
+};
+
+// Движемся из точки a в точку b и пытаемся подобрать точку c.
+// Эта функция реализована в уроке.
+CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c);
+
+struct Item {
+    geom::Point2D position;
+    double width;
+};
+
+struct Gatherer {
+    geom::Point2D start_pos;
+    geom::Point2D end_pos;
+    double width;
+};
+
+class ItemGathererProvider {
+protected:
+    ~ItemGathererProvider() = default;
+
+public:
+    virtual size_t ItemsCount() const = 0;
+    virtual Item GetItem(size_t idx) const = 0;
+    virtual size_t GatherersCount() const = 0;
+    virtual Gatherer GetGatherer(size_t idx) const = 0;
+};
+
+/*
+ * Предметы в виде структуры массивов: i-й предмет лежит в точке (x[i], y[i])
+ * и имеет ширину width[i]. Все массивы одной длины.
+ */
+struct ItemsSpan {
+    std::span<const double> x;
+    std::span<const double> y;
+    std::span<const double> width;
+
+    size_t size() const noexcept {
+        return x.size();
+    }
+};
+
+// Собиратели в виде структуры массивов. Все массивы одной длины
+struct GatherersSpan {
+    std::span<const double> start_x;
+    std::span<const double> start_y;
+    std::span<const double> end_x;
+    std::span<const double> end_y;
+    std::span<const double> width;
+
+    size_t size() const noexcept {
+        return start_x.size();
+    }
+};
+
+/*
+ * Поставщик предметов и собирателей, который отдаёт их непрерывными массивами.
+ * В отличие от ItemGathererProvider, детектор получает все данные двумя вызовами
+ * и обходит их без косвенных вызовов и копирования структур.
+ * Массивы должны оставаться неизменными, пока идёт поиск событий.
+ */
+class SpanItemGathererProvider {
+protected:
+    ~SpanItemGathererProvider() = default;
+
+public:
+    virtual ItemsSpan GetItems() const = 0;
+    virtual GatherersSpan GetGatherers() const = 0;
+};
+
+// Хранит предметы и собирателей в виде структуры массивов
+class GatheringBuffer final : public SpanItemGathererProvider {
+public:
+    // Копирует данные поставщика с поэлементным интерфейсом
+    static GatheringBuffer From(const ItemGathererProvider& provider);
+
+    void Reserve(size_t items, size_t gatherers);
+    void AddItem(const Item& item);
+    void AddGatherer(const Gatherer& gatherer);
+    void Clear() noexcept;
+
+    ItemsSpan GetItems() const override {
+        return {item_x_, item_y_, item_width_};
+    }
+
+    GatherersSpan GetGatherers() const override {
+        return {start_x_, start_y_, end_x_, end_y_, gatherer_width_};
+    }
+
+private:
+    std::vector<double> item_x_;
+    std::vector<double> item_y_;
+    std::vector<double> item_width_;
+
+    std::vector<double> start_x_;
+    std::vector<double> start_y_;
+    std::vector<double> end_x_;
+    std::vector<double> end_y_;
+    std::vector<double> gatherer_width_;
+};
+
+// Предметы, подобранные при пакетной проверке: номер предмета в переданном
+// массиве и результат TryCollectPoint для него
+struct CollectedItems {
+    std::vector<size_t> ids;
+    std::vector<double> sq_distances;
+    std::vector<double> proj_ratios;
+
+    size_t size() const noexcept {
+        return ids.size();
+    }
+
+    void clear() noexcept {
+        ids.clear();
+        sq_distances.clear();
+        proj_ratios.clear();
+    }
+};
+
+// Движемся из точки a в точку b и пытаемся подобрать каждый из предметов items.
+// Дописывает в out предметы, для которых IsCollected(gatherer_width + width)
+// истинно, в порядке возрастания номера. Результаты совпадают с TryCollectPoint
+// бит в бит. На процессорах с AVX2 за одну итерацию проверяются четыре предмета.
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, double gatherer_width, const ItemsSpan& items,
+                      CollectedItems& out);
+
+// Прямоугольник, выровненный по осям
+struct BoundingBox {
+    geom::Point2D min;
+    geom::Point2D max;
+};
+
+// Прямоугольник, вне которого собиратель, движущийся из a в b, не может подобрать
+// предмет: ограничивающий прямоугольник отрезка, расширенный на radius - сумму
+// ширины собирателя и наибольшей ширины предметов. Включает небольшой запас
+// на погрешность вычисления sq_distance в TryCollectPoint
+BoundingBox GetCollectBounds(geom::Point2D a, geom::Point2D b, double radius) noexcept;
+
+// Скалярная реализация TryCollectPoints, доступная на любом процессоре
+void TryCollectPointsScalar(geom::Point2D a, geom::Point2D b, double gatherer_width,
+                            const ItemsSpan& items, CollectedItems& out);
+
+// Поддерживает ли процессор векторную реализацию TryCollectPoints
+bool HasVectorCollectKernel() noexcept;
+
+struct GatheringEvent {
+    size_t item_id;
+    size_t gatherer_id;
+    double sq_distance;
+    double time;
+};
+
+// Порядок событий в результате поиска: по времени, затем по номеру собирателя
+// и номеру предмета
+inline bool GatheringEventLess(const GatheringEvent& lhs, const GatheringEvent& rhs) noexcept {
+    return std::tie(lhs.time, lhs.gatherer_id, lhs.item_id) < std::tie(rhs.time, rhs.gatherer_id, rhs.item_id);
+}
+
+// Два собирателя сблизились на сумму своих ширин. first_id < second_id
+struct ContactEvent {
+    size_t first_id;
+    size_t second_id;
+    // Квадрат наименьшего расстояния между собирателями за такт
+    double sq_distance;
+    // Доля такта, в которую собиратели сблизились
+    double time;
+};
+
+inline bool ContactEventLess(const ContactEvent& lhs, const ContactEvent& rhs) noexcept {
+    return std::tie(lhs.time, lhs.first_id, lhs.second_id) < std::tie(rhs.time, rhs.first_id, rhs.second_id);
+}
+
+// Круглая зона, например зона сдачи предметов вокруг офиса
+struct Zone {
+    geom::Point2D center;
+    double radius;
+};
+
+// Собиратель вошёл в зону: в начале такта он был вне неё
+struct ZoneEvent {
+    size_t zone_id;
+    size_t gatherer_id;
+    // Доля такта, в которую собиратель вошёл в зону
+    double time;
+};
+
+inline bool ZoneEventLess(const ZoneEvent& lhs, const ZoneEvent& rhs) noexcept {
+    return std::tie(lhs.time, lhs.gatherer_id, lhs.zone_id) < std::tie(rhs.time, rhs.gatherer_id, rhs.zone_id);
+}
+
+// Собиратели a и b одновременно движутся по своим отрезкам с постоянной скоростью.
+// Возвращает событие, если за такт расстояние между ними стало не больше суммы
+// ширин, а в начале такта было больше. Поля first_id и second_id не заполняются
+std::optional<ContactEvent> TryContact(const Gatherer& a, const Gatherer& b) noexcept;
+
+// Возвращает долю такта, в которую собиратель вошёл в зону (с учётом своей
+// ширины), если в начале такта он был вне её
+std::optional<double> TryEnterZone(const Gatherer& gatherer, const Zone& zone) noexcept;
+
+// Распределение поиска событий по потокам
+struct GatheringParallelism {
+    // Наибольшее число потоков. 0 - по числу аппаратных потоков
+    size_t max_threads = 0;
+    // Меньше этого числа собирателей на поток поиск выполняется в вызывающем
+    // потоке, чтобы небольшие сеансы не платили за запуск потоков
+    size_t min_gatherers_per_thread = 4096;
+};
+
+// Находит все события сбора предметов за такт. События упорядочены по времени,
+// а при равном времени - по номеру собирателя и номеру предмета.
+// Точная проверка выполняется только для предметов рядом с отрезком перемещения
+// собирателя, что эквивалентно перебору всех пар, но обходится дешевле.
+// Результат не зависит от числа потоков.
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider,
+                                             const GatheringParallelism& parallelism);
+std::vector<GatheringEvent> FindGatherEvents(const SpanItemGathererProvider& provider,
+                                             const GatheringParallelism& parallelism = {});
+
 }  // namespace collision_detector
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "gathering_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace collision_detector {
+
+int64_t GatheringEngine::ItemCells::CellCoord(double coord) const noexcept {
+    return static_cast<int64_t>(std::floor(coord / cell_size_));
+}
+
+int64_t GatheringEngine::ItemCells::CellKey(int64_t cx, int64_t cy) noexcept {
+    return (cx << 32) ^ (cy & 0xFFFFFFFF);
+}
+
+void GatheringEngine::ItemCells::Insert(ItemId id, const Item& item) {
+    const int64_t key = CellKey(CellCoord(item.position.x), CellCoord(item.position.y));
+    Cell& cell = cells_[key];
+    locations_.emplace(id, Location{key, cell.ids.size(), item});
+    cell.x.push_back(item.position.x);
+    cell.y.push_back(item.position.y);
+    cell.width.push_back(item.width);
+    cell.ids.push_back(id);
+    max_width_ = std::max(max_width_, item.width);
+}
+
+bool GatheringEngine::ItemCells::Remove(ItemId id) {
+    const auto location_it = locations_.find(id);
+    if (location_it == locations_.end()) {
+        return false;
+    }
+    const int64_t key = location_it->second.cell;
+    const size_t index = location_it->second.index;
+    locations_.erase(location_it);
+
+    const auto cell_it = cells_.find(key);
+    Cell& cell = cell_it->second;
+    const size_t last = cell.ids.size() - 1;
+    if (index != last) {
+        cell.x[index] = cell.x[last];
+        cell.y[index] = cell.y[last];
+        cell.width[index] = cell.width[last];
+        cell.ids[index] = cell.ids[last];
+        locations_.at(cell.ids[index]).index = index;
+    }
+    cell.x.pop_back();
+    cell.y.pop_back();
+    cell.width.pop_back();
+    cell.ids.pop_back();
+    if (cell.ids.empty()) {
+        cells_.erase(cell_it);
+    }
+    return true;
+}
+
+const Item* GatheringEngine::ItemCells::Find(ItemId id) const {
+    const auto it = locations_.find(id);
+    return it == locations_.end() ? nullptr : &it->second.item;
+}
+
+GatheringEngine::GatheringEngine(std::span<const Item> static_items, double cell_size)
+    : GatheringEngine{static_items, {}, cell_size} {
+}
+
+GatheringEngine::GatheringEngine(std::span<const Item> static_items, std::span<const Zone> zones,
+                                 double cell_size)
+    : static_{cell_size}
+    , dynamic_{cell_size}
+    , zones_{cell_size}
+    , gatherers_{cell_size}
+    , static_count_{static_items.size()}
+    , next_id_{static_items.size()} {
+    for (size_t idx = 0; idx < static_items.size(); ++idx) {
+        static_.Insert(idx, static_items[idx]);
+    }
+    for (size_t idx = 0; idx < zones.size(); ++idx) {
+        zones_.Insert(idx, {zones[idx].center, zones[idx].radius});
+    }
+}
+
+GatheringEngine::ItemId GatheringEngine::AddItem(const Item& item) {
+    const ItemId id = next_id_++;
+    dynamic_.Insert(id, item);
+    return id;
+}
+
+bool GatheringEngine::RemoveItem(ItemId id) {
+    return dynamic_.Remove(id);
+}
+
+void GatheringEngine::PlaceGatherer(size_t gatherer_id, geom::Point2D position, double width) {
+    gatherers_.Remove(gatherer_id);
+    gatherers_.Insert(gatherer_id, {position, width});
+}
+
+void GatheringEngine::RemoveGatherer(size_t gatherer_id) {
+    gatherers_.Remove(gatherer_id);
+}
+
+void GatheringEngine::MoveGatherer(size_t gatherer_id, geom::Point2D start_pos, geom::Point2D end_pos,
+                                   double width) {
+    const Item* placed = gatherers_.Find(gatherer_id);
+    if (!placed || placed->position != start_pos || placed->width != width) {
+        PlaceGatherer(gatherer_id, start_pos, width);
+    }
+    // Собиратель, который не двигался, ничего не подбирает
+    if (start_pos.x == end_pos.x && start_pos.y == end_pos.y) {
+        return;
+    }
+    if (const auto [it, inserted] = move_index_.emplace(gatherer_id, moves_.size()); !inserted) {
+        // Повторное перемещение за такт заменяет предыдущее
+        moves_[it->second].second = Gatherer{start_pos, end_pos, width};
+        return;
+    }
+    moves_.emplace_back(gatherer_id, Gatherer{start_pos, end_pos, width});
+}
+
+void GatheringEngine::CollectFromCells(const ItemCells& cells, size_t gatherer_id, const Gatherer& gatherer) {
+    if (cells.Size() == 0) {
+        return;
+    }
+    const auto bounds =
+        GetCollectBounds(gatherer.start_pos, gatherer.end_pos, gatherer.width + cells.GetMaxWidth());
+    cells.ForEachCellInBox(bounds, [&](const ItemCells::Cell& cell) {
+        hits_.clear();
+        TryCollectPoints(gatherer.start_pos, gatherer.end_pos, gatherer.width, cell.GetItems(), hits_);
+        for (size_t hit = 0; hit < hits_.size(); ++hit) {
+            events_.gathering.push_back({cell.ids[hits_.ids[hit]], gatherer_id, hits_.sq_distances[hit],
+                               hits_.proj_ratios[hit]});
+        }
+    });
+}
+
+void GatheringEngine::FindContacts(size_t gatherer_id, const Gatherer& gatherer, double max_move) {
+    // Если собиратели сблизились, то позиция второго на начало такта отстоит
+    // от прямоугольника перемещения первого не дальше суммы ширин и перемещения
+    // второго. Поэтому пара найдётся при обходе сетки от любого из двух
+    const double radius = gatherer.width + gatherers_.GetMaxWidth() + max_move;
+    const auto bounds = GetCollectBounds(gatherer.start_pos, gatherer.end_pos, radius);
+    gatherers_.ForEachCellInBox(bounds, [&](const ItemCells::Cell& cell) {
+        for (size_t idx = 0; idx < cell.ids.size(); ++idx) {
+            const size_t other_id = cell.ids[idx];
+            if (other_id == gatherer_id) {
+                continue;
+            }
+            Gatherer other{{cell.x[idx], cell.y[idx]}, {cell.x[idx], cell.y[idx]}, cell.width[idx]};
+            if (const auto it = move_index_.find(other_id); it != move_index_.end()) {
+                // Пару двух движущихся собирателей проверяет собиратель с меньшим номером
+                if (other_id < gatherer_id) {
+                    continue;
+                }
+                other = moves_[it->second].second;
+            }
+            if (auto contact = TryContact(gatherer, other)) {
+                contact->first_id = std::min(gatherer_id, other_id);
+                contact->second_id = std::max(gatherer_id, other_id);
+                events_.contacts.push_back(*contact);
+            }
+        }
+    });
+}
+
+void GatheringEngine::FindZoneEntries(size_t gatherer_id, const Gatherer& gatherer) {
+    if (zones_.Size() == 0) {
+        return;
+    }
+    const auto bounds =
+        GetCollectBounds(gatherer.start_pos, gatherer.end_pos, gatherer.width + zones_.GetMaxWidth());
+    zones_.ForEachCellInBox(bounds, [&](const ItemCells::Cell& cell) {
+        for (size_t idx = 0; idx < cell.ids.size(); ++idx) {
+            if (const auto time = TryEnterZone(gatherer, {{cell.x[idx], cell.y[idx]}, cell.width[idx]})) {
+                events_.zones.push_back({cell.ids[idx], gatherer_id, *time});
+            }
+        }
+    });
+}
+
+TickEvents GatheringEngine::Tick() {
+    double max_move = 0;
+    for (const auto& [gatherer_id, gatherer] : moves_) {
+        max_move = std::max({max_move, std::abs(gatherer.end_pos.x - gatherer.start_pos.x),
+                             std::abs(gatherer.end_pos.y - gatherer.start_pos.y)});
+    }
+
+    for (const auto& [gatherer_id, gatherer] : moves_) {
+        CollectFromCells(static_, gatherer_id, gatherer);
+        CollectFromCells(dynamic_, gatherer_id, gatherer);
+        FindContacts(gatherer_id, gatherer, max_move);
+        FindZoneEntries(gatherer_id, gatherer);
+    }
+
+    // Собиратели перекладываются в сетке только после поиска сближений,
+    // который опирается на позиции начала такта
+    for (const auto& [gatherer_id, gatherer] : moves_) {
+        gatherers_.Remove(gatherer_id);
+        gatherers_.Insert(gatherer_id, {gatherer.end_pos, gatherer.width});
+    }
+    moves_.clear();
+    move_index_.clear();
+
+    std::sort(events_.gathering.begin(), events_.gathering.end(), GatheringEventLess);
+    std::sort(events_.contacts.begin(), events_.contacts.end(), ContactEventLess);
+    std::sort(events_.zones.begin(), events_.zones.end(), ZoneEventLess);
+    return std::exchange(events_, {});
+}
+
+}  // namespace collision_detector
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "collision_detector.h"
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace collision_detector {
+
+// События одного такта
+struct TickEvents {
+    // Упорядочены, как в FindGatherEvents
+    std::vector<GatheringEvent> gathering;
+    // Упорядочены по времени, затем по номерам собирателей
+    std::vector<ContactEvent> contacts;
+    // Упорядочены по времени, затем по номеру собирателя и номеру зоны
+    std::vector<ZoneEvent> zones;
+};
+
+/*
+ * Поиск событий такта, который сохраняет пространственный индекс между тактами.
+ *
+ * FindGatherEvents строит сетку предметов заново при каждом вызове, хотя от такта
+ * к такту предметы почти не меняются. Движок хранит сетки:
+ *   - статических предметов (например, офисов) и зон, индексируемых один раз
+ *     при создании;
+ *   - подвижных предметов (потерянных вещей), которые добавляются и удаляются
+ *     по одному за O(1), не затрагивая остальные;
+ *   - собирателей, в которой перекладываются только переместившиеся собиратели.
+ * За такт проверяются только собиратели, которые переместились, поэтому стоимость
+ * такта пропорциональна числу изменений и перемещений, а не числу всех сущностей.
+ *
+ * Кроме сбора предметов, движок находит сближения собирателей друг с другом
+ * и входы собирателей в зоны. Для них используются те же сетки, поэтому
+ * попарный перебор собирателей не нужен.
+ *
+ * Идентификаторы предметов назначает движок. Номера собирателей и зон задаёт
+ * вызывающий код. Результат сбора совпадает с FindGatherEvents для тех же
+ * предметов и перемещений.
+ */
+class GatheringEngine {
+public:
+    using ItemId = size_t;
+
+    // cell_size - сторона ячейки сетки. Удачный выбор - порядка перемещения
+    // собирателя за такт. Номер зоны равен её индексу в zones
+    GatheringEngine(std::span<const Item> static_items, double cell_size);
+    GatheringEngine(std::span<const Item> static_items, std::span<const Zone> zones, double cell_size);
+
+    // Идентификатор i-го статического предмета равен i
+    size_t StaticItemsCount() const noexcept {
+        return static_count_;
+    }
+
+    ItemId AddItem(const Item& item);
+    // Возвращает false, если предмета нет или он статический
+    bool RemoveItem(ItemId id);
+
+    size_t ItemsCount() const noexcept {
+        return static_count_ + dynamic_.Size();
+    }
+
+    // Помещает собирателя в точку без перемещения, например при появлении на карте.
+    // Неподвижные собиратели участвуют в поиске сближений
+    void PlaceGatherer(size_t gatherer_id, geom::Point2D position, double width);
+    void RemoveGatherer(size_t gatherer_id);
+
+    size_t GatherersCount() const noexcept {
+        return gatherers_.Size();
+    }
+
+    // Регистрирует перемещение собирателя в текущем такте. Неизвестный движку
+    // собиратель помещается в start_pos. Собиратель, который не переместился,
+    // можно не передавать
+    void MoveGatherer(size_t gatherer_id, geom::Point2D start_pos, geom::Point2D end_pos, double width);
+
+    // Находит события для перемещений, зарегистрированных с прошлого вызова,
+    // и переносит собирателей в конечные точки перемещений
+    TickEvents Tick();
+
+private:
+    /*
+     * Сетка, в каждой ячейке которой предметы хранятся столбцами.
+     * Удалённый предмет заменяется последним предметом ячейки.
+     */
+    class ItemCells {
+    public:
+        struct Cell {
+            std::vector<double> x;
+            std::vector<double> y;
+            std::vector<double> width;
+            std::vector<ItemId> ids;
+
+            ItemsSpan GetItems() const noexcept {
+                return {x, y, width};
+            }
+        };
+
+        explicit ItemCells(double cell_size) noexcept
+            : cell_size_{cell_size} {
+        }
+
+        void Insert(ItemId id, const Item& item);
+        bool Remove(ItemId id);
+        // Возвращает nullptr, если предмета нет
+        const Item* Find(ItemId id) const;
+
+        size_t Size() const noexcept {
+            return locations_.size();
+        }
+
+        double GetMaxWidth() const noexcept {
+            return max_width_;
+        }
+
+        // Вызывает fn(cell) для непустых ячеек, пересекающих прямоугольник
+        template <typename Fn>
+        void ForEachCellInBox(const BoundingBox& box, Fn&& fn) const {
+            const int64_t min_x = CellCoord(box.min.x);
+            const int64_t max_x = CellCoord(box.max.x);
+            const int64_t min_y = CellCoord(box.min.y);
+            const int64_t max_y = CellCoord(box.max.y);
+            // Для больших прямоугольников дешевле перебрать непустые ячейки
+            if (double(max_x - min_x + 1) * double(max_y - min_y + 1) > double(cells_.size())) {
+                for (const auto& [key, cell] : cells_) {
+                    fn(cell);
+                }
+                return;
+            }
+            for (int64_t cx = min_x; cx <= max_x; ++cx) {
+                for (int64_t cy = min_y; cy <= max_y; ++cy) {
+                    if (const auto it = cells_.find(CellKey(cx, cy)); it != cells_.end()) {
+                        fn(it->second);
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Location {
+            int64_t cell;
+            size_t index;
+            Item item;
+        };
+
+        int64_t CellCoord(double coord) const noexcept;
+        static int64_t CellKey(int64_t cx, int64_t cy) noexcept;
+
+        double cell_size_;
+        // Ширина не уменьшается при удалении предметов: завышенная оценка
+        // лишь немного расширяет область поиска
+        double max_width_ = 0;
+        std::unordered_map<int64_t, Cell> cells_;
+        std::unordered_map<ItemId, Location> locations_;
+    };
+
+    void CollectFromCells(const ItemCells& cells, size_t gatherer_id, const Gatherer& gatherer);
+    void FindContacts(size_t gatherer_id, const Gatherer& gatherer, double max_move);
+    void FindZoneEntries(size_t gatherer_id, const Gatherer& gatherer);
+
+    ItemCells static_;
+    ItemCells dynamic_;
+    ItemCells zones_;
+    // Позиции собирателей на начало такта. Ширина предмета - ширина собирателя
+    ItemCells gatherers_;
+    size_t static_count_ = 0;
+    ItemId next_id_ = 0;
+
+    // Перемещения текущего такта и индекс перемещения по номеру собирателя
+    std::vector<std::pair<size_t, Gatherer>> moves_;
+    std::unordered_map<size_t, size_t> move_index_;
+    TickEvents events_;
+    CollectedItems hits_;
+};
+
+}  // namespace collision_detector
@@ -2,4 +2,312 @@
 
 #include "../src/collision_detector.h"
 
-// Напишите здесь тесты для функции collision_detector::FindGatherEvents
\ No newline at end of file
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <sstream>
+#include <tuple>
+
+// Напишите здесь тесты для функции collision_detector::FindGatherEvents
+
+namespace collision_detector {
+
+bool operator==(const GatheringEvent& lhs, const GatheringEvent& rhs) {
+    return std::tie(lhs.item_id, lhs.gatherer_id, lhs.sq_distance, lhs.time)
+        == std::tie(rhs.item_id, rhs.gatherer_id, rhs.sq_distance, rhs.time);
+}
+
+}  // namespace collision_detector
+
+namespace Catch {
+
+template <>
+struct StringMaker<collision_detector::GatheringEvent> {
+    static std::string convert(const collision_detector::GatheringEvent& value) {
+        std::ostringstream tmp;
+        tmp << "(" << value.gatherer_id << "," << value.item_id << "," << value.sq_distance << ","
+            << value.time << ")";
+        return tmp.str();
+    }
+};
+
+}  // namespace Catch
+
+namespace {
+
+using namespace collision_detector;
+
+class VectorItemGathererProvider : public ItemGathererProvider {
+public:
+    VectorItemGathererProvider(std::vector<Item> items, std::vector<Gatherer> gatherers)
+        : items_(std::move(items))
+        , gatherers_(std::move(gatherers)) {
+    }
+
+    size_t ItemsCount() const override {
+        return items_.size();
+    }
+    Item GetItem(size_t idx) const override {
+        return items_[idx];
+    }
+    size_t GatherersCount() const override {
+        return gatherers_.size();
+    }
+    Gatherer GetGatherer(size_t idx) const override {
+        return gatherers_[idx];
+    }
+
+private:
+    std::vector<Item> items_;
+    std::vector<Gatherer> gatherers_;
+};
+
+// Эталон: перебор всех пар собиратель-предмет
+std::vector<GatheringEvent> FindGatherEventsBruteForce(const ItemGathererProvider& provider) {
+    std::vector<GatheringEvent> events;
+    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
+        const Gatherer gatherer = provider.GetGatherer(g);
+        if (gatherer.start_pos.x == gatherer.end_pos.x && gatherer.start_pos.y == gatherer.end_pos.y) {
+            continue;
+        }
+        for (size_t i = 0; i < provider.ItemsCount(); ++i) {
+            const Item item = provider.GetItem(i);
+            const auto result = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+            if (result.IsCollected(gatherer.width + item.width)) {
+                events.push_back({i, g, result.sq_distance, result.proj_ratio});
+            }
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.time < rhs.time;
+    });
+    return events;
+}
+
+}  // namespace
+
+SCENARIO("Gather events are found for items near the gatherer path") {
+    GIVEN("a gatherer moving along the x axis") {
+        const std::vector<Gatherer> gatherers{{{0, 0}, {10, 0}, 0.6}};
+
+        WHEN("items lie on, near and far from the path") {
+            const VectorItemGathererProvider provider{
+                {
+                    {{5, 0.5}, 0.},   // рядом с путём, в середине
+                    {{1, 0}, 0.},     // на пути, в начале
+                    {{5, 2}, 0.},     // слишком далеко
+                    {{11, 0}, 0.},    // за концом отрезка
+                    {{-0.5, 0}, 0.},  // позади начала отрезка
+                    {{9, 0.9}, 0.4},  // далеко, но с шириной предмета
+                },
+                gatherers};
+            const auto events = FindGatherEvents(provider);
+
+            THEN("only collectable items are reported in the order of collection") {
+                REQUIRE(events.size() == 3);
+                CHECK(events[0].item_id == 1);
+                CHECK(events[0].time == 0.1);
+                CHECK(events[1].item_id == 0);
+                CHECK(events[1].time == 0.5);
+                CHECK(events[2].item_id == 5);
+                CHECK(events[2].time == 0.9);
+                for (const auto& event : events) {
+                    CHECK(event.gatherer_id == 0);
+                }
+            }
+        }
+    }
+
+    GIVEN("a gatherer that stays in place") {
+        const VectorItemGathererProvider provider{{{{1, 1}, 1.}}, {{{1, 1}, {1, 1}, 1.}}};
+
+        THEN("it collects nothing") {
+            CHECK(FindGatherEvents(provider).empty());
+        }
+    }
+
+    GIVEN("no items or no gatherers") {
+        THEN("there are no events") {
+            CHECK(FindGatherEvents(VectorItemGathererProvider{{}, {{{0, 0}, {1, 0}, 1.}}}).empty());
+            CHECK(FindGatherEvents(VectorItemGathererProvider{{{{0, 0}, 1.}}, {}}).empty());
+        }
+    }
+
+    GIVEN("two gatherers reaching the same item at the same time") {
+        const VectorItemGathererProvider provider{
+            {{{5, 0}, 0.}},
+            {{{0, 0}, {10, 0}, 0.5}, {{5, -5}, {5, 5}, 0.5}, {{0, 0}, {10, 0}, 0.5}}};
+
+        THEN("events with equal time are ordered by gatherer") {
+            const auto events = FindGatherEvents(provider);
+            REQUIRE(events.size() == 3);
+            CHECK(events[0].gatherer_id == 0);
+            CHECK(events[1].gatherer_id == 1);
+            CHECK(events[2].gatherer_id == 2);
+        }
+    }
+}
+
+SCENARIO("Broad phase gives the same events as checking every pair") {
+    std::mt19937_64 rng{42};
+
+    const auto check_random_world = [&rng](size_t item_count, size_t gatherer_count, double world_size,
+                                           double max_step) {
+        std::uniform_real_distribution<double> coord{-world_size, world_size};
+        std::uniform_real_distribution<double> step{-max_step, max_step};
+        std::uniform_real_distribution<double> width{0, 1};
+
+        std::vector<Item> items;
+        for (size_t i = 0; i < item_count; ++i) {
+            items.push_back({{coord(rng), coord(rng)}, width(rng) * 0.5});
+        }
+        std::vector<Gatherer> gatherers;
+        for (size_t i = 0; i < gatherer_count; ++i) {
+            const geom::Point2D start{coord(rng), coord(rng)};
+            // Часть собирателей движется вдоль осей, как собаки по дорогам
+            const geom::Point2D end = i % 3 == 0 ? geom::Point2D{start.x + step(rng), start.y}
+                                    : i % 3 == 1 ? geom::Point2D{start.x, start.y + step(rng)}
+                                                 : geom::Point2D{start.x + step(rng), start.y + step(rng)};
+            gatherers.push_back({start, end, width(rng)});
+        }
+        const VectorItemGathererProvider provider{std::move(items), std::move(gatherers)};
+        CHECK(FindGatherEvents(provider) == FindGatherEventsBruteForce(provider));
+    };
+
+    WHEN("gatherers make short steps in a dense world") {
+        check_random_world(2000, 500, 50, 3);
+    }
+    WHEN("gatherers make long steps across the world") {
+        check_random_world(500, 200, 20, 40);
+    }
+    WHEN("items are sparse") {
+        check_random_world(20, 1000, 100, 5);
+    }
+    WHEN("items lie exactly on the gatherer paths") {
+        std::vector<Item> items;
+        std::vector<Gatherer> gatherers;
+        for (int i = 0; i < 100; ++i) {
+            gatherers.push_back({{0, i * 1.}, {100, i * 1.}, 0.});
+            items.push_back({{i * 1., i * 1.}, 0.});
+            items.push_back({{i * 1., i + 0.25}, 0.3});
+        }
+        const VectorItemGathererProvider provider{std::move(items), std::move(gatherers)};
+        const auto events = FindGatherEvents(provider);
+        CHECK(events.size() == 200);
+        CHECK(events == FindGatherEventsBruteForce(provider));
+    }
+}
+
+SCENARIO("Span provider gives the same events as the element-wise provider") {
+    GIVEN("a world stored both ways") {
+        const VectorItemGathererProvider provider{
+            {{{1, 0}, 0.1}, {{5, 0.5}, 0.}, {{3, 3}, 0.2}, {{3, 7}, 0.}},
+            {{{0, 0}, {10, 0}, 0.6}, {{3, 10}, {3, 0}, 0.1}, {{2, 2}, {2, 2}, 1.}}};
+        const auto buffer = GatheringBuffer::From(provider);
+
+        THEN("the buffer holds every element as a column") {
+            CHECK(buffer.GetItems().size() == provider.ItemsCount());
+            CHECK(buffer.GetGatherers().size() == provider.GatherersCount());
+            CHECK(buffer.GetItems().y[1] == 0.5);
+            CHECK(buffer.GetGatherers().end_y[1] == 0);
+        }
+
+        THEN("both providers produce identical events") {
+            const auto events = FindGatherEvents(buffer);
+            CHECK(events.size() == 4);
+            CHECK(events == FindGatherEvents(provider));
+            CHECK(events == FindGatherEventsBruteForce(provider));
+        }
+    }
+}
+
+SCENARIO("Batch collection matches TryCollectPoint exactly") {
+    std::mt19937_64 rng{7};
+    std::uniform_real_distribution<double> coord{-10, 10};
+    std::uniform_real_distribution<double> width{0, 2};
+
+    GatheringBuffer buffer;
+    const geom::Point2D a{-3, 1};
+    const geom::Point2D b{4, 2.5};
+    // Предметы точно в концах отрезка и на продолжениях дают proj_ratio 0 и 1
+    for (const geom::Point2D point : {a, b, geom::Point2D{-10, -0.5}, geom::Point2D{11, 4}}) {
+        buffer.AddItem({point, 0.});
+    }
+    for (int i = 0; i < 1003; ++i) {
+        buffer.AddItem({{coord(rng), coord(rng)}, width(rng)});
+    }
+    const double gatherer_width = 0.5;
+
+    CollectedItems expected;
+    const ItemsSpan items = buffer.GetItems();
+    for (size_t i = 0; i < items.size(); ++i) {
+        const auto result = TryCollectPoint(a, b, {items.x[i], items.y[i]});
+        if (result.IsCollected(gatherer_width + items.width[i])) {
+            expected.ids.push_back(i);
+            expected.sq_distances.push_back(result.sq_distance);
+            expected.proj_ratios.push_back(result.proj_ratio);
+        }
+    }
+    REQUIRE(expected.size() > 2);
+    CHECK(expected.ids[0] == 0);
+    CHECK(expected.proj_ratios[0] == 0);
+    CHECK(expected.ids[1] == 1);
+    CHECK(expected.proj_ratios[1] == 1);
+
+    const auto check_kernel = [&](auto&& kernel) {
+        CollectedItems actual;
+        // Пакетная проверка дописывает результаты к уже найденным
+        actual.ids.push_back(42);
+        actual.sq_distances.push_back(0);
+        actual.proj_ratios.push_back(0);
+        kernel(a, b, gatherer_width, items, actual);
+        REQUIRE(actual.size() == expected.size() + 1);
+        CHECK(std::equal(expected.ids.begin(), expected.ids.end(), actual.ids.begin() + 1));
+        CHECK(std::equal(expected.sq_distances.begin(), expected.sq_distances.end(),
+                         actual.sq_distances.begin() + 1));
+        CHECK(std::equal(expected.proj_ratios.begin(), expected.proj_ratios.end(),
+                         actual.proj_ratios.begin() + 1));
+    };
+
+    WHEN("the scalar kernel is used") {
+        check_kernel(TryCollectPointsScalar);
+    }
+    WHEN("the kernel is selected for the current processor") {
+        INFO("vector kernel: " << HasVectorCollectKernel());
+        check_kernel(TryCollectPoints);
+    }
+}
+
+SCENARIO("Parallel search gives the same events as the sequential one") {
+    std::mt19937_64 rng{2024};
+    std::uniform_real_distribution<double> coord{0, 100};
+    std::uniform_real_distribution<double> step{-4, 4};
+
+    GatheringBuffer buffer;
+    for (int i = 0; i < 5000; ++i) {
+        buffer.AddItem({{coord(rng), coord(rng)}, 0.1});
+    }
+    // Несколько собирателей подбирают один и тот же предмет в один момент
+    buffer.AddItem({{50, 50}, 0.});
+    for (int i = 0; i < 8; ++i) {
+        buffer.AddGatherer({{48, 50}, {52, 50}, 0.3});
+    }
+    for (int i = 0; i < 3001; ++i) {
+        const geom::Point2D start{coord(rng), coord(rng)};
+        buffer.AddGatherer({start, {start.x + step(rng), start.y + step(rng)}, 0.6});
+    }
+
+    const auto sequential = FindGatherEvents(buffer, {.max_threads = 1});
+    REQUIRE(sequential.size() > 100);
+    CHECK(std::is_sorted(sequential.begin(), sequential.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.time, lhs.gatherer_id, lhs.item_id)
+             < std::tie(rhs.time, rhs.gatherer_id, rhs.item_id);
+    }));
+
+    for (const size_t threads : {2, 3, 7}) {
+        DYNAMIC_SECTION("the search runs on " << threads << " threads") {
+            const auto parallel =
+                FindGatherEvents(buffer, {.max_threads = threads, .min_gatherers_per_thread = 1});
+            CHECK(parallel == sequential);
+        }
+    }
+}
@@ -0,0 +1,265 @@
+#include "../src/gathering_engine.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <map>
+#include <random>
+
+using namespace collision_detector;
+
+namespace {
+
+bool SameEvents(const std::vector<GatheringEvent>& lhs, const std::vector<GatheringEvent>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const auto& a, const auto& b) {
+        return a.item_id == b.item_id && a.gatherer_id == b.gatherer_id && a.sq_distance == b.sq_distance
+            && a.time == b.time;
+    });
+}
+
+}  // namespace
+
+SCENARIO("Gathering engine keeps items between ticks") {
+    GIVEN("an engine with an office and a lost object") {
+        const std::vector<Item> offices{{{10, 0}, 0.5}};
+        GatheringEngine engine{offices, 5};
+        const auto loot = engine.AddItem({{5, 0}, 0});
+
+        CHECK(engine.StaticItemsCount() == 1);
+        CHECK(engine.ItemsCount() == 2);
+        CHECK(loot == 1);
+
+        WHEN("a dog runs past both") {
+            engine.MoveGatherer(7, {0, 0}, {20, 0}, 0.6);
+            const auto events = engine.Tick().gathering;
+
+            THEN("it reaches the loot first and then the office") {
+                REQUIRE(events.size() == 2);
+                CHECK(events[0].item_id == loot);
+                CHECK(events[0].gatherer_id == 7);
+                CHECK(events[0].time == 0.25);
+                CHECK(events[1].item_id == 0);
+                CHECK(events[1].time == 0.5);
+            }
+        }
+
+        WHEN("the lost object is picked up") {
+            CHECK(engine.RemoveItem(loot));
+            CHECK_FALSE(engine.RemoveItem(loot));
+
+            THEN("it is not reported any more") {
+                engine.MoveGatherer(0, {0, 0}, {20, 0}, 0.6);
+                const auto events = engine.Tick().gathering;
+                REQUIRE(events.size() == 1);
+                CHECK(events[0].item_id == 0);
+            }
+        }
+
+        WHEN("offices cannot be removed") {
+            CHECK_FALSE(engine.RemoveItem(0));
+            CHECK(engine.ItemsCount() == 2);
+        }
+
+        WHEN("nobody moves") {
+            engine.MoveGatherer(0, {5, 0}, {5, 0}, 0.6);
+            THEN("there are no events and moves do not carry over to the next tick") {
+                CHECK(engine.Tick().gathering.empty());
+                CHECK(engine.Tick().gathering.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Gathering engine matches FindGatherEvents over many ticks") {
+    std::mt19937_64 rng{123};
+    std::uniform_real_distribution<double> coord{0, 200};
+    std::uniform_real_distribution<double> step{-3, 3};
+    std::uniform_real_distribution<double> width{0, 0.5};
+
+    std::vector<Item> offices;
+    for (int i = 0; i < 20; ++i) {
+        offices.push_back({{coord(rng), coord(rng)}, 0.5});
+    }
+    GatheringEngine engine{offices, 4};
+
+    // Текущие предметы: идентификатор в движке -> предмет
+    std::map<GatheringEngine::ItemId, Item> items;
+    for (size_t i = 0; i < offices.size(); ++i) {
+        items.emplace(i, offices[i]);
+    }
+    std::vector<geom::Point2D> dogs(300);
+    for (auto& dog : dogs) {
+        dog = {coord(rng), coord(rng)};
+    }
+
+    for (int tick = 0; tick < 30; ++tick) {
+        // Появляются новые предметы
+        for (int i = 0; i < 50; ++i) {
+            const Item item{{coord(rng), coord(rng)}, width(rng)};
+            items.emplace(engine.AddItem(item), item);
+        }
+
+        GatheringBuffer buffer;
+        std::vector<GatheringEngine::ItemId> ids;
+        for (const auto& [id, item] : items) {
+            buffer.AddItem(item);
+            ids.push_back(id);
+        }
+        for (size_t dog = 0; dog < dogs.size(); ++dog) {
+            // Часть собак стоит на месте
+            const geom::Point2D end =
+                dog % 4 == 0 ? dogs[dog] : geom::Point2D{dogs[dog].x + step(rng), dogs[dog].y};
+            buffer.AddGatherer({dogs[dog], end, 0.6});
+            engine.MoveGatherer(dog, dogs[dog], end, 0.6);
+            dogs[dog] = end;
+        }
+
+        auto expected = FindGatherEvents(buffer);
+        for (auto& event : expected) {
+            event.item_id = ids[event.item_id];
+        }
+        const auto actual = engine.Tick().gathering;
+        CHECK(SameEvents(actual, expected));
+
+        // Подобранные предметы исчезают
+        for (const auto& event : actual) {
+            if (event.item_id >= offices.size() && items.erase(event.item_id) != 0) {
+                CHECK(engine.RemoveItem(event.item_id));
+            }
+        }
+        CHECK(engine.ItemsCount() == items.size());
+    }
+}
+
+SCENARIO("Gathering engine finds dogs passing each other") {
+    GIVEN("two dogs running towards each other and a dog standing aside") {
+        GatheringEngine engine{{}, 5};
+        engine.PlaceGatherer(2, {20, 0.5}, 0.6);
+        engine.MoveGatherer(0, {0, 0}, {10, 0}, 0.6);
+        engine.MoveGatherer(1, {10, 0.5}, {0, 0.5}, 0.6);
+        const auto events = engine.Tick();
+
+        THEN("only the running dogs meet, when they come within their widths") {
+            REQUIRE(events.contacts.size() == 1);
+            const auto& contact = events.contacts[0];
+            CHECK(contact.first_id == 0);
+            CHECK(contact.second_id == 1);
+            CHECK(contact.sq_distance == 0.25);
+            // Сближение на 1.2 при относительной скорости 20 и начальном
+            // расстоянии по оси x 10: (10 - sqrt(1.2^2 - 0.5^2)) / 20
+            CHECK(std::abs(contact.time - (10 - std::sqrt(1.44 - 0.25)) / 20) < 1e-12);
+        }
+
+        AND_WHEN("the dogs keep running apart") {
+            engine.MoveGatherer(0, {10, 0}, {10, -10}, 0.6);
+            engine.MoveGatherer(1, {0, 0.5}, {-10, 0.5}, 0.6);
+            THEN("there is no new contact") {
+                CHECK(engine.Tick().contacts.empty());
+            }
+        }
+
+        AND_WHEN("a dog runs into the standing one") {
+            engine.MoveGatherer(0, {10, 0}, {19, 0}, 0.6);
+            const auto contacts = engine.Tick().contacts;
+            REQUIRE(contacts.size() == 1);
+            CHECK(contacts[0].first_id == 0);
+            CHECK(contacts[0].second_id == 2);
+        }
+    }
+}
+
+SCENARIO("Gathering engine finds zone entries") {
+    GIVEN("an office delivery zone") {
+        const std::vector<Zone> zones{{{10, 0}, 0.5}};
+        GatheringEngine engine{{}, zones, 5};
+
+        WHEN("a dog runs through it") {
+            engine.MoveGatherer(0, {0, 0}, {20, 0}, 0.5);
+            const auto events = engine.Tick();
+            THEN("the entry is reported at the moment the dog touches the zone") {
+                REQUIRE(events.zones.size() == 1);
+                CHECK(events.zones[0].zone_id == 0);
+                CHECK(events.zones[0].gatherer_id == 0);
+                CHECK(events.zones[0].time == 0.45);
+            }
+        }
+
+        WHEN("a dog moves inside the zone") {
+            engine.MoveGatherer(0, {10, 0}, {10, 0.3}, 0.5);
+            THEN("it does not enter it again") {
+                CHECK(engine.Tick().zones.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Contacts and zone entries match checking every pair") {
+    std::mt19937_64 rng{99};
+    std::uniform_real_distribution<double> coord{0, 60};
+    std::uniform_real_distribution<double> step{-3, 3};
+    std::uniform_real_distribution<double> radius{0.2, 2};
+
+    std::vector<Zone> zones;
+    for (int i = 0; i < 30; ++i) {
+        zones.push_back({{coord(rng), coord(rng)}, radius(rng)});
+    }
+    GatheringEngine engine{{}, zones, 4};
+
+    std::vector<geom::Point2D> dogs(200);
+    for (size_t dog = 0; dog < dogs.size(); ++dog) {
+        dogs[dog] = {coord(rng), coord(rng)};
+        engine.PlaceGatherer(dog, dogs[dog], 0.6);
+    }
+
+    size_t total_contacts = 0;
+    size_t total_entries = 0;
+    for (int tick = 0; tick < 20; ++tick) {
+        std::vector<Gatherer> moves;
+        for (size_t dog = 0; dog < dogs.size(); ++dog) {
+            const geom::Point2D end = dog % 3 == 0 ? dogs[dog]
+                                    : dog % 3 == 1 ? geom::Point2D{dogs[dog].x + step(rng), dogs[dog].y}
+                                                   : geom::Point2D{dogs[dog].x, dogs[dog].y + step(rng)};
+            moves.push_back({dogs[dog], end, 0.6});
+            // Неподвижных собак в движок не передаём
+            if (dog % 3 != 0) {
+                engine.MoveGatherer(dog, dogs[dog], end, 0.6);
+            }
+            dogs[dog] = end;
+        }
+
+        std::vector<ContactEvent> expected_contacts;
+        std::vector<ZoneEvent> expected_zones;
+        for (size_t a = 0; a < moves.size(); ++a) {
+            for (size_t b = a + 1; b < moves.size(); ++b) {
+                if (auto contact = TryContact(moves[a], moves[b])) {
+                    contact->first_id = a;
+                    contact->second_id = b;
+                    expected_contacts.push_back(*contact);
+                }
+            }
+            for (size_t zone = 0; zone < zones.size(); ++zone) {
+                if (const auto time = TryEnterZone(moves[a], zones[zone])) {
+                    expected_zones.push_back({zone, a, *time});
+                }
+            }
+        }
+        std::sort(expected_contacts.begin(), expected_contacts.end(), ContactEventLess);
+        std::sort(expected_zones.begin(), expected_zones.end(), ZoneEventLess);
+
+        const auto events = engine.Tick();
+        REQUIRE(events.contacts.size() == expected_contacts.size());
+        for (size_t i = 0; i < expected_contacts.size(); ++i) {
+            CHECK(events.contacts[i].first_id == expected_contacts[i].first_id);
+            CHECK(events.contacts[i].second_id == expected_contacts[i].second_id);
+            CHECK(events.contacts[i].time == expected_contacts[i].time);
+        }
+        REQUIRE(events.zones.size() == expected_zones.size());
+        for (size_t i = 0; i < expected_zones.size(); ++i) {
+            CHECK(events.zones[i].zone_id == expected_zones[i].zone_id);
+            CHECK(events.zones[i].gatherer_id == expected_zones[i].gatherer_id);
+        }
+        total_contacts += expected_contacts.size();
+        total_entries += expected_zones.size();
+    }
+    CHECK(total_contacts > 10);
+    CHECK(total_entries > 10);
+}
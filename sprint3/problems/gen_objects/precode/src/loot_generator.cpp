@@ -1,6 +1,7 @@
 #include "loot_generator.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 
 namespace loot_gen {
@@ -10,8 +11,8 @@ unsigned LootGenerator::Generate(TimeInterval time_delta, unsigned loot_count,
     time_without_loot_ += time_delta;
     const unsigned loot_shortage = loot_count > looter_count ? 0u : looter_count - loot_count;
     const double ratio = std::chrono::duration<double>{time_without_loot_} / base_interval_;
-    const double probability
-        = std::clamp((1.0 - std::pow(1.0 - probability_, ratio)) * random_generator_(), 0.0, 1.0);
+    const double probability = std::clamp(
+        LootProbability(ratio, log_keep_probability_) * random_generator_(), 0.0, 1.0);
     const unsigned generated_loot = static_cast<unsigned>(std::round(loot_shortage * probability));
     if (generated_loot > 0) {
         time_without_loot_ = {};
@@ -19,4 +20,65 @@ unsigned LootGenerator::Generate(TimeInterval time_delta, unsigned loot_count,
     return generated_loot;
 }
 
-} // namespace loot_gen
+double LootGenerator::LootProbability(double ratio, double log_keep_probability) noexcept {
+    // При нулевом времени произведение с -inf (probability == 1) дало бы NaN
+    return ratio > 0 ? 1.0 - std::exp(ratio * log_keep_probability) : 0.0;
+}
+
+BatchLootGenerator::BatchLootGenerator(TimeInterval base_interval, double probability)
+    : BatchLootGenerator{base_interval, probability, nullptr} {
+}
+
+BatchLootGenerator::BatchLootGenerator(TimeInterval base_interval, double probability,
+                                       LootGenerator::RandomGenerator random_gen)
+    : base_interval_{base_interval}
+    , log_keep_probability_{LootGenerator::LogKeepProbability(probability)}
+    , random_generator_{std::move(random_gen)} {
+}
+
+size_t BatchLootGenerator::AddSession(uint64_t seed) {
+    seeds_.push_back(seed);
+    counters_.push_back(0);
+    time_without_loot_.push_back(0);
+    random_values_.push_back(0);
+    return seeds_.size() - 1;
+}
+
+void BatchLootGenerator::Generate(TimeInterval time_delta, std::span<const unsigned> loot_counts,
+                                  std::span<const unsigned> looter_counts,
+                                  std::span<unsigned> generated) {
+    const size_t count = seeds_.size();
+    assert(loot_counts.size() == count && looter_counts.size() == count
+           && generated.size() == count);
+
+    if (random_generator_) {
+        for (size_t i = 0; i < count; ++i) {
+            random_values_[i] = random_generator_();
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            random_values_[i] = CounterRandom(seeds_[i], counters_[i]);
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        ++counters_[i];
+    }
+
+    const auto delta = time_delta.count();
+    for (size_t i = 0; i < count; ++i) {
+        const auto time_without_loot = time_without_loot_[i] + delta;
+        const unsigned loot_shortage
+            = loot_counts[i] > looter_counts[i] ? 0u : looter_counts[i] - loot_counts[i];
+        // Вычисления повторяют LootGenerator::Generate, чтобы результаты совпадали
+        // до последнего бита
+        const double ratio
+            = std::chrono::duration<double>{TimeInterval{time_without_loot}} / base_interval_;
+        const double probability = std::clamp(
+            LootGenerator::LootProbability(ratio, log_keep_probability_) * random_values_[i], 0.0, 1.0);
+        const auto loot = static_cast<unsigned>(std::round(loot_shortage * probability));
+        generated[i] = loot;
+        time_without_loot_[i] = loot > 0 ? 0 : time_without_loot;
+    }
+}
+
+}  // namespace loot_gen
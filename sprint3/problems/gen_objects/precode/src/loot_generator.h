@@ -1,6 +1,10 @@
 #pragma once
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <span>
+#include <vector>
 
 namespace loot_gen {
 
@@ -20,7 +24,7 @@ public:
     LootGenerator(TimeInterval base_interval, double probability,
                   RandomGenerator random_gen = DefaultGenerator)
         : base_interval_{base_interval}
-        , probability_{probability}
+        , log_keep_probability_{LogKeepProbability(probability)}
         , random_generator_{std::move(random_gen)} {
     }
 
@@ -35,14 +39,103 @@ public:
      */
     unsigned Generate(TimeInterval time_delta, unsigned loot_count, unsigned looter_count);
 
+    /*
+     * Логарифм вероятности того, что трофей не появится за базовый интервал.
+     * Вероятность появления за ratio интервалов равна 1 - exp(ratio * log(1 - p)):
+     * логарифм считается один раз, а не в std::pow при каждом вызове.
+     * Оба генератора считают вероятность одной функцией, поэтому их результаты
+     * совпадают до последнего бита
+     */
+    static double LogKeepProbability(double probability) noexcept {
+        return std::log(1.0 - probability);
+    }
+    static double LootProbability(double ratio, double log_keep_probability) noexcept;
+
 private:
     static double DefaultGenerator() noexcept {
         return 1.0;
     };
     TimeInterval base_interval_;
-    double probability_;
+    double log_keep_probability_;
     TimeInterval time_without_loot_{};
     RandomGenerator random_generator_;
 };
 
+/*
+ * Счётчиковый генератор псевдослучайных чисел (финализатор SplitMix64).
+ * n-е число потока с зерном seed вычисляется независимо от предыдущих, без
+ * состояния, поэтому генерацию для многих потоков можно векторизовать, а любой
+ * запуск - воспроизвести по записанному зерну.
+ */
+constexpr uint64_t MixBits(uint64_t z) noexcept {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Возвращает counter-е число потока seed, равномерно распределённое в [0, 1)
+constexpr double CounterRandom(uint64_t seed, uint64_t counter) noexcept {
+    const uint64_t bits = MixBits(seed + counter * 0x9E3779B97F4A7C15ull);
+    return static_cast<double>(bits >> 11) * 0x1.0p-53;
+}
+
+// Зерно index-го сеанса, выведенное из общего зерна запуска
+constexpr uint64_t DeriveSeed(uint64_t master_seed, uint64_t index) noexcept {
+    return MixBits(MixBits(master_seed) ^ (index + 1) * 0xD1B54A32D192ED03ull);
+}
+
+/*
+ * Генератор трофеев для многих сеансов сразу.
+ *
+ * Для каждого сеанса выдаёт то же, что LootGenerator с теми же параметрами и
+ * случайными числами, - вероятность считается по той же формуле. Состояние
+ * сеансов хранится в виде структуры массивов, и все сеансы обрабатываются
+ * за один проход без вызова std::function на каждый сеанс.
+ * Случайные числа сеанса берутся из CounterRandom с зерном сеанса, номер числа
+ * равен числу вызовов Generate с добавления сеанса. Поэтому результат сеанса
+ * зависит только от его зерна, а не от того, когда и после каких сеансов
+ * он добавлен.
+ */
+class BatchLootGenerator {
+public:
+    using TimeInterval = LootGenerator::TimeInterval;
+
+    BatchLootGenerator(TimeInterval base_interval, double probability);
+
+    // Случайные числа берутся из random_gen по одному на сеанс в порядке
+    // номеров сеансов. Используется в тестах
+    BatchLootGenerator(TimeInterval base_interval, double probability,
+                       LootGenerator::RandomGenerator random_gen);
+
+    // Возвращает номер добавленного сеанса
+    size_t AddSession(uint64_t seed);
+
+    size_t GetSessionCount() const noexcept {
+        return seeds_.size();
+    }
+
+    uint64_t GetSeed(size_t session) const {
+        return seeds_.at(session);
+    }
+
+    /*
+     * Для каждого сеанса i записывает в generated[i] количество трофеев, которые
+     * должны появиться в нём спустя time_delta. Размеры всех массивов равны
+     * количеству сеансов.
+     */
+    void Generate(TimeInterval time_delta, std::span<const unsigned> loot_counts,
+                  std::span<const unsigned> looter_counts, std::span<unsigned> generated);
+
+private:
+    TimeInterval base_interval_;
+    double log_keep_probability_;
+    LootGenerator::RandomGenerator random_generator_;
+
+    std::vector<uint64_t> seeds_;
+    // Номер следующего случайного числа сеанса
+    std::vector<uint64_t> counters_;
+    std::vector<TimeInterval::rep> time_without_loot_;
+    std::vector<double> random_values_;
+};
+
 }  // namespace loot_gen
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cmath>
 #include <catch2/catch_test_macros.hpp>
+#include <vector>
 
 #include "../src/loot_generator.h"
 
@@ -72,3 +74,121 @@ SCENARIO("Loot generation") {
         }
     }
 }
+
+SCENARIO("Batched loot generation") {
+    using loot_gen::BatchLootGenerator;
+    using loot_gen::LootGenerator;
+
+    constexpr size_t SESSION_COUNT = 50;
+    const std::vector<std::chrono::milliseconds> deltas{100ms, 250ms, 1s, 20ms, 3s, 0ms, 700ms};
+
+    GIVEN("a batched generator with injected random values") {
+        // Одна и та же последовательность случайных чисел для пакетного генератора
+        // и для набора обычных генераторов
+        unsigned batch_state = 1;
+        const auto next_random = [](unsigned& state) {
+            state = state * 1103515245u + 12345u;
+            return static_cast<double>(state >> 8) / (1u << 24);
+        };
+        BatchLootGenerator batch{1s, 0.3, [&] {
+                                     return next_random(batch_state);
+                                 }};
+        unsigned single_state = 1;
+        std::vector<LootGenerator> singles;
+        for (size_t i = 0; i < SESSION_COUNT; ++i) {
+            batch.AddSession(i);
+            singles.emplace_back(1s, 0.3, [&] {
+                return next_random(single_state);
+            });
+        }
+
+        THEN("every session gets the same loot as with its own generator") {
+            std::vector<unsigned> loot(SESSION_COUNT);
+            std::vector<unsigned> looters(SESSION_COUNT);
+            std::vector<unsigned> generated(SESSION_COUNT);
+            unsigned total = 0;
+            for (const auto delta : deltas) {
+                for (size_t i = 0; i < SESSION_COUNT; ++i) {
+                    looters[i] = static_cast<unsigned>(i % 7 + 3);
+                }
+                batch.Generate(delta, loot, looters, generated);
+                for (size_t i = 0; i < SESSION_COUNT; ++i) {
+                    INFO("session " << i);
+                    CHECK(generated[i] == singles[i].Generate(delta, loot[i], looters[i]));
+                    loot[i] = std::min(loot[i] + generated[i], looters[i] - 1);
+                    total += generated[i];
+                }
+            }
+            CHECK(total > 0);
+        }
+    }
+
+    GIVEN("batched generators seeded from a recorded master seed") {
+        const auto run = [&](uint64_t master_seed) {
+            BatchLootGenerator batch{1s, 0.5};
+            for (size_t i = 0; i < SESSION_COUNT; ++i) {
+                batch.AddSession(loot_gen::DeriveSeed(master_seed, i));
+            }
+            std::vector<unsigned> loot(SESSION_COUNT, 0);
+            std::vector<unsigned> looters(SESSION_COUNT, 10);
+            std::vector<unsigned> generated(SESSION_COUNT);
+            std::vector<unsigned> history;
+            for (const auto delta : deltas) {
+                batch.Generate(delta, loot, looters, generated);
+                history.insert(history.end(), generated.begin(), generated.end());
+            }
+            return history;
+        };
+
+        THEN("runs with the same seed are identical") {
+            CHECK(run(42) == run(42));
+            CHECK(run(42) != run(43));
+        }
+    }
+
+    GIVEN("a session added after others have already generated loot") {
+        const auto run = [&](size_t earlier_sessions, size_t earlier_ticks) {
+            BatchLootGenerator batch{1s, 0.5};
+            for (size_t i = 0; i < earlier_sessions; ++i) {
+                batch.AddSession(loot_gen::DeriveSeed(1, i));
+            }
+            std::vector<unsigned> loot(earlier_sessions, 0);
+            std::vector<unsigned> looters(earlier_sessions, 10);
+            std::vector<unsigned> generated(earlier_sessions);
+            for (size_t tick = 0; tick < earlier_ticks; ++tick) {
+                batch.Generate(100ms, loot, looters, generated);
+            }
+
+            const size_t session = batch.AddSession(loot_gen::DeriveSeed(2, 0));
+            loot.push_back(0);
+            looters.push_back(10);
+            generated.push_back(0);
+            std::vector<unsigned> history;
+            for (const auto delta : deltas) {
+                batch.Generate(delta, loot, looters, generated);
+                history.push_back(generated[session]);
+            }
+            return history;
+        };
+
+        THEN("its loot depends only on its seed") {
+            const auto alone = run(0, 0);
+            CHECK(run(SESSION_COUNT, 3) == alone);
+            CHECK(run(3, 10) == alone);
+        }
+    }
+
+    GIVEN("the counter-based random generator") {
+        THEN("it is uniform in [0, 1)") {
+            double sum = 0;
+            constexpr int COUNT = 100000;
+            for (int i = 0; i < COUNT; ++i) {
+                const double value = loot_gen::CounterRandom(7, i);
+                REQUIRE(value >= 0.0);
+                REQUIRE(value < 1.0);
+                sum += value;
+            }
+            CHECK(std::abs(sum / COUNT - 0.5) < 0.01);
+        }
+    }
+}
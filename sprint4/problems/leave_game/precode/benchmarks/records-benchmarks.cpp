@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+
+#include "../src/records_backend.h"
+
+/*
+ * Сравнение хранилищ рекордов: Postgres и локального файла.
+ *
+ * Аргумент backend: 0 - локальный файл, 1 - Postgres. Тесты Postgres
+ * подключаются к базе по адресу из переменной окружения GAME_DB_URL и
+ * пропускаются, если она не задана. Тесты дописывают записи в таблицу
+ * retired_players, поэтому для них нужна отдельная база.
+ * Оба хранилища дожидаются записи каждой группы на диск.
+ *
+ * Insert измеряет сохранение группы из batch записей, как её сохраняет
+ * RetiredPlayerWriter. Page измеряет запрос страницы из PAGE_SIZE записей,
+ * начинающейся с места start, в таблице из RECORD_COUNT записей.
+ */
+
+namespace {
+
+using namespace std::literals;
+using records_backend::RecordsBackendConfig;
+
+constexpr size_t RECORD_COUNT = 100'000;
+constexpr size_t PAGE_SIZE = 100;
+constexpr size_t LOAD_BATCH_SIZE = 10'000;
+
+enum Backend : int64_t { EMBEDDED = 0, POSTGRES = 1 };
+
+std::filesystem::path GetFilePath() {
+    return std::filesystem::temp_directory_path() / "records-benchmarks.bin";
+}
+
+// Возвращает nullptr, если хранилище недоступно
+std::unique_ptr<domain::RetiredPlayerRepository> OpenRepository(int64_t backend) {
+    RecordsBackendConfig config;
+    if (backend == POSTGRES) {
+        const char* db_url = std::getenv("GAME_DB_URL");
+        if (db_url == nullptr) {
+            return nullptr;
+        }
+        config.db_url = db_url;
+    } else {
+        config.type = RecordsBackendConfig::Type::EMBEDDED;
+        config.file_store.path = GetFilePath();
+    }
+    return records_backend::MakeRecordsRepository(config);
+}
+
+std::vector<domain::RetiredPlayer> MakePlayers(size_t count, std::mt19937_64& random) {
+    std::uniform_int_distribution<int> score{0, 10'000};
+    std::uniform_int_distribution<int> play_time{1'000, 3'600'000};
+    std::vector<domain::RetiredPlayer> players;
+    players.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        players.push_back({"Dog "s + std::to_string(random()), score(random), std::chrono::milliseconds{play_time(random)}});
+    }
+    return players;
+}
+
+// Дополняет хранилище до RECORD_COUNT записей
+void Fill(domain::RetiredPlayerRepository& repository) {
+    std::mt19937_64 random{2024};
+    while (repository.GetRecords(RECORD_COUNT - 1, 1).empty()) {
+        repository.SaveBatch(MakePlayers(LOAD_BATCH_SIZE, random));
+    }
+}
+
+void BM_Insert(benchmark::State& state) {
+    std::filesystem::remove(GetFilePath());
+    const auto repository = OpenRepository(state.range(0));
+    if (!repository) {
+        state.SkipWithError("GAME_DB_URL is not set");
+        return;
+    }
+    const auto batch_size = static_cast<size_t>(state.range(1));
+    std::mt19937_64 random{2024};
+    for (auto _ : state) {
+        state.PauseTiming();
+        const auto batch = MakePlayers(batch_size, random);
+        state.ResumeTiming();
+        repository->SaveBatch(batch);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch_size));
+    std::filesystem::remove(GetFilePath());
+}
+
+void BM_Page(benchmark::State& state) {
+    std::filesystem::remove(GetFilePath());
+    const auto repository = OpenRepository(state.range(0));
+    if (!repository) {
+        state.SkipWithError("GAME_DB_URL is not set");
+        return;
+    }
+    Fill(*repository);
+    const auto start = static_cast<size_t>(state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repository->GetRecords(start, PAGE_SIZE));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * PAGE_SIZE));
+    std::filesystem::remove(GetFilePath());
+}
+
+BENCHMARK(BM_Insert)
+    ->Name("Insert")
+    ->ArgNames({"backend", "batch"})
+    ->ArgsProduct({{EMBEDDED, POSTGRES}, {1, 100}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_Page)
+    ->Name("Page")
+    ->ArgNames({"backend", "start"})
+    ->ArgsProduct({{EMBEDDED, POSTGRES}, {0, 50'000, 99'900}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,121 @@
+#include "leaderboard.h"
+
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+
+namespace app {
+
+using namespace std::literals;
+
+namespace {
+
+void AppendNumber(std::string& out, double value) {
+    char buffer[32];
+    const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void AppendNumber(std::string& out, int value) {
+    char buffer[16];
+    const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Дописывает строку JSON, экранируя кавычки, обратную косую черту и управляющие символы
+void AppendString(std::string& out, std::string_view value) {
+    static constexpr std::string_view HEX_DIGITS = "0123456789abcdef"sv;
+    out += '"';
+    for (const char c : value) {
+        switch (c) {
+            case '"':
+                out += "\\\""sv;
+                break;
+            case '\\':
+                out += "\\\\"sv;
+                break;
+            case '\n':
+                out += "\\n"sv;
+                break;
+            case '\r':
+                out += "\\r"sv;
+                break;
+            case '\t':
+                out += "\\t"sv;
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00"sv;
+                    out += HEX_DIGITS[static_cast<unsigned char>(c) >> 4];
+                    out += HEX_DIGITS[static_cast<unsigned char>(c) & 0xF];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+}  // namespace
+
+Leaderboard::Leaderboard(const std::vector<domain::RetiredPlayer>& players)
+    : records_(players.begin(), players.end()) {
+}
+
+void Leaderboard::Add(domain::RetiredPlayer player) {
+    std::lock_guard lock{mutex_};
+    records_.insert(std::move(player));
+    page_cache_.clear();
+}
+
+size_t Leaderboard::GetSize() const {
+    std::lock_guard lock{mutex_};
+    return records_.size();
+}
+
+std::vector<domain::RetiredPlayer> Leaderboard::GetPage(size_t start, size_t max_items) const {
+    std::lock_guard lock{mutex_};
+    std::vector<domain::RetiredPlayer> page;
+    if (start >= records_.size()) {
+        return page;
+    }
+    const size_t count = std::min(max_items, records_.size() - start);
+    page.reserve(count);
+    std::copy_n(records_.nth(start), count, std::back_inserter(page));
+    return page;
+}
+
+std::shared_ptr<const std::string> Leaderboard::GetPageJson(size_t start, size_t max_items) const {
+    std::lock_guard lock{mutex_};
+    const auto key = std::make_pair(start, max_items);
+    if (const auto it = page_cache_.find(key); it != page_cache_.end()) {
+        return it->second;
+    }
+
+    auto json = std::make_shared<std::string>();
+    *json += '[';
+    if (start < records_.size()) {
+        const size_t count = std::min(max_items, records_.size() - start);
+        auto it = records_.nth(start);
+        for (size_t i = 0; i < count; ++i, ++it) {
+            if (i > 0) {
+                *json += ',';
+            }
+            *json += "{\"name\":"sv;
+            AppendString(*json, it->name);
+            *json += ",\"score\":"sv;
+            AppendNumber(*json, it->score);
+            *json += ",\"playTime\":"sv;
+            AppendNumber(*json, std::chrono::duration<double>{it->play_time}.count());
+            *json += '}';
+        }
+    }
+    *json += ']';
+
+    if (page_cache_.size() >= MAX_CACHED_PAGES) {
+        page_cache_.clear();
+    }
+    return page_cache_.emplace(key, std::move(json)).first->second;
+}
+
+}  // namespace app
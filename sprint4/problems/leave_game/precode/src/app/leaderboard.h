@@ -0,0 +1,56 @@
+#pragma once
+#include <boost/multi_index/identity.hpp>
+#include <boost/multi_index/ranked_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../domain/retired_player.h"
+
+namespace app {
+
+/*
+ * Таблица рекордов для /api/v1/game/records, упорядоченная по domain::RecordOrder.
+ *
+ * Загружается из базы при запуске и пополняется при уходе игроков на покой.
+ * Записи хранятся в ранжированном индексе Boost.MultiIndex: он находит запись
+ * по её месту за O(log n), поэтому страница из k записей с любого места
+ * строится за O(log n + k) без обращения к базе.
+ * JSON страниц кешируется до следующего добавления записи: опрашивающие клиенты
+ * обычно запрашивают одни и те же страницы. Методы можно вызывать из разных потоков.
+ */
+class Leaderboard {
+public:
+    Leaderboard() = default;
+    explicit Leaderboard(const std::vector<domain::RetiredPlayer>& players);
+
+    void Add(domain::RetiredPlayer player);
+
+    size_t GetSize() const;
+
+    std::vector<domain::RetiredPlayer> GetPage(size_t start, size_t max_items) const;
+
+    // Возвращает страницу в виде
+    // [{"name": "Rex", "score": 42, "playTime": 12.5}, ...], где playTime в секундах
+    std::shared_ptr<const std::string> GetPageJson(size_t start, size_t max_items) const;
+
+private:
+    using Records = boost::multi_index_container<
+        domain::RetiredPlayer,
+        boost::multi_index::indexed_by<boost::multi_index::ranked_non_unique<
+            boost::multi_index::identity<domain::RetiredPlayer>, domain::RecordOrder>>>;
+
+    // Сверх этого числа кеш страниц очищается, чтобы запросы со случайными
+    // параметрами не занимали память
+    static constexpr size_t MAX_CACHED_PAGES = 1024;
+
+    mutable std::mutex mutex_;
+    Records records_;
+    mutable std::map<std::pair<size_t, size_t>, std::shared_ptr<const std::string>> page_cache_;
+};
+
+}  // namespace app
@@ -0,0 +1,141 @@
+#include "retired_player_writer.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace app {
+
+RetiredPlayerWriter::RetiredPlayerWriter(domain::RetiredPlayerRepository& repository,
+                                         RetiredPlayerWriterConfig config, ErrorHandler on_error)
+    : repository_{repository}
+    , config_{config}
+    , on_error_{std::move(on_error)}
+    , worker_{[this](std::stop_token stop) {
+        Run(std::move(stop));
+    }} {
+}
+
+RetiredPlayerWriter::~RetiredPlayerWriter() {
+    worker_.request_stop();
+}
+
+void RetiredPlayerWriter::Enqueue(domain::RetiredPlayer player) {
+    std::unique_lock lock{mutex_};
+    if (queue_.size() >= config_.queue_capacity) {
+        const auto start = std::chrono::steady_clock::now();
+        not_full_.wait(lock, [this] {
+            return queue_.size() < config_.queue_capacity;
+        });
+        stats_.blocked_time += std::chrono::steady_clock::now() - start;
+    }
+    queue_.push_back(std::move(player));
+    ++stats_.enqueued;
+    lock.unlock();
+    not_empty_.notify_one();
+}
+
+bool RetiredPlayerWriter::TryEnqueue(domain::RetiredPlayer player) {
+    {
+        std::lock_guard lock{mutex_};
+        if (queue_.size() >= config_.queue_capacity) {
+            return false;
+        }
+        queue_.push_back(std::move(player));
+        ++stats_.enqueued;
+    }
+    not_empty_.notify_one();
+    return true;
+}
+
+void RetiredPlayerWriter::Flush() {
+    std::unique_lock lock{mutex_};
+    saved_.wait(lock, [this] {
+        return queue_.empty() && in_flight_ == 0;
+    });
+}
+
+RetiredPlayerWriterStats RetiredPlayerWriter::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
+
+void RetiredPlayerWriter::Run(std::stop_token stop) {
+    std::vector<domain::RetiredPlayer> batch;
+    batch.reserve(config_.max_batch_size);
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            // После запроса остановки очередь дописывается до конца
+            if (!not_empty_.wait(lock, stop, [this] {
+                    return !queue_.empty();
+                })) {
+                return;
+            }
+            const auto count = static_cast<std::ptrdiff_t>(std::min(queue_.size(), config_.max_batch_size));
+            std::move(queue_.begin(), queue_.begin() + count, std::back_inserter(batch));
+            queue_.erase(queue_.begin(), queue_.begin() + count);
+            in_flight_ = batch.size();
+        }
+        not_full_.notify_all();
+
+        Save(batch, stop);
+        batch.clear();
+        {
+            std::lock_guard lock{mutex_};
+            in_flight_ = 0;
+        }
+        saved_.notify_all();
+    }
+}
+
+void RetiredPlayerWriter::Save(std::span<const domain::RetiredPlayer> batch, std::stop_token stop) {
+    auto delay = config_.initial_retry_delay;
+    while (true) {
+        try {
+            repository_.SaveBatch(batch);
+            std::lock_guard lock{mutex_};
+            stats_.saved += batch.size();
+            ++stats_.batches;
+            return;
+        } catch (const domain::RepositoryUnavailable& ex) {
+            ReportError(ex);
+        } catch (const std::exception& ex) {
+            ReportError(ex);
+            // Группа сохраняется целиком или никак, поэтому одна негодная запись
+            // отвергла бы её при каждом повторе. Записи сохраняются по одной,
+            // чтобы отбросить только негодные
+            if (batch.size() > 1) {
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    Save(batch.subspan(i, 1), stop);
+                }
+                return;
+            }
+            std::lock_guard lock{mutex_};
+            stats_.rejected += batch.size();
+            return;
+        }
+
+        std::unique_lock lock{mutex_};
+        if (stop.stop_requested()) {
+            stats_.dropped += batch.size();
+            return;
+        }
+        // Ждём паузу целиком: новые записи не должны ускорять повтор
+        not_empty_.wait_for(lock, stop, delay, [] {
+            return false;
+        });
+        delay = std::min(delay * 2, config_.max_retry_delay);
+    }
+}
+
+void RetiredPlayerWriter::ReportError(const std::exception& error) {
+    {
+        std::lock_guard lock{mutex_};
+        ++stats_.failed_attempts;
+    }
+    if (on_error_) {
+        on_error_(error);
+    }
+}
+
+}  // namespace app
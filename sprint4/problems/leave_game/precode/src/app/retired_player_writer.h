@@ -0,0 +1,102 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "../domain/retired_player.h"
+
+namespace app {
+
+struct RetiredPlayerWriterConfig {
+    // Наибольшее число записей, ожидающих сохранения
+    size_t queue_capacity = 10'000;
+    // Наибольшее число записей, сохраняемых одним запросом
+    size_t max_batch_size = 500;
+    // После неудачной записи пауза перед повтором удваивается до max_retry_delay
+    std::chrono::milliseconds initial_retry_delay{100};
+    std::chrono::milliseconds max_retry_delay{10'000};
+};
+
+struct RetiredPlayerWriterStats {
+    uint64_t enqueued = 0;
+    uint64_t saved = 0;
+    uint64_t batches = 0;
+    uint64_t failed_attempts = 0;
+    // Записи, которые не удалось сохранить до остановки
+    uint64_t dropped = 0;
+    // Записи, которые хранилище отвергло, например из-за слишком длинного имени
+    uint64_t rejected = 0;
+    // Суммарное время, которое Enqueue ждал освобождения места в очереди
+    std::chrono::nanoseconds blocked_time{0};
+};
+
+/*
+ * Сохраняет итоги ушедших на покой игроков в отдельном потоке.
+ *
+ * Такт только ставит записи в ограниченную очередь. Поток записи забирает из неё
+ * всё накопившееся (не больше max_batch_size записей) и сохраняет одним запросом,
+ * поэтому при частом уходе игроков запросов к базе меньше, чем записей.
+ * Если хранилище недоступно (domain::RepositoryUnavailable), поток повторяет запись
+ * с нарастающей паузой, а записи продолжают копиться в очереди. Если хранилище
+ * отвергло группу, повтор не поможет: поток сохраняет её записи по одной,
+ * а отвергнутые отбрасывает и учитывает в rejected. Когда очередь
+ * заполнена, Enqueue ждёт: так простой базы сдерживает игру, а не приводит
+ * к неограниченному росту памяти или потере результатов.
+ */
+class RetiredPlayerWriter {
+public:
+    // Вызывается в потоке записи при каждой неудачной попытке сохранения
+    using ErrorHandler = std::function<void(const std::exception& error)>;
+
+    explicit RetiredPlayerWriter(domain::RetiredPlayerRepository& repository, RetiredPlayerWriterConfig config = {},
+                                 ErrorHandler on_error = {});
+
+    RetiredPlayerWriter(const RetiredPlayerWriter&) = delete;
+    RetiredPlayerWriter& operator=(const RetiredPlayerWriter&) = delete;
+
+    // Сохраняет оставшиеся записи, делая для каждой группы одну попытку.
+    // Записи, которые сохранить не удалось, учитываются в dropped
+    ~RetiredPlayerWriter();
+
+    // Ставит запись в очередь. Если очередь заполнена, ждёт освобождения места
+    void Enqueue(domain::RetiredPlayer player);
+
+    // Ставит запись в очередь, если в ней есть место
+    [[nodiscard]] bool TryEnqueue(domain::RetiredPlayer player);
+
+    // Дожидается сохранения всех поставленных в очередь записей
+    void Flush();
+
+    RetiredPlayerWriterStats GetStats() const;
+
+private:
+    void Run(std::stop_token stop);
+    void Save(std::span<const domain::RetiredPlayer> batch, std::stop_token stop);
+    void ReportError(const std::exception& error);
+
+    domain::RetiredPlayerRepository& repository_;
+    RetiredPlayerWriterConfig config_;
+    ErrorHandler on_error_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any not_empty_;
+    std::condition_variable not_full_;
+    std::condition_variable saved_;
+    std::deque<domain::RetiredPlayer> queue_;
+    // Число записей, которые поток записи забрал из очереди, но ещё не сохранил
+    size_t in_flight_ = 0;
+    RetiredPlayerWriterStats stats_;
+
+    // Объявлен последним, чтобы остановиться раньше разрушения остальных полей
+    std::jthread worker_;
+};
+
+}  // namespace app
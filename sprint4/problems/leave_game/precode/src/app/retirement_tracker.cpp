@@ -0,0 +1,154 @@
+#include "retirement_tracker.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+
+namespace app {
+
+RetirementTracker::RetirementTracker(Milliseconds retirement_time, Milliseconds now)
+    : retirement_time_{static_cast<uint64_t>(retirement_time.count())}
+    , current_{static_cast<uint64_t>(now.count())} {
+    heads_.fill(NO_NODE);
+}
+
+void RetirementTracker::OnIdle(DogId dog, Milliseconds since) {
+    const uint64_t deadline = static_cast<uint64_t>(since.count()) + retirement_time_;
+    if (const auto it = nodes_by_dog_.find(dog); it != nodes_by_dog_.end()) {
+        Unlink(it->second);
+        nodes_[it->second].deadline = deadline;
+        Insert(it->second);
+        return;
+    }
+
+    uint32_t node;
+    if (free_nodes_.empty()) {
+        node = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    } else {
+        node = free_nodes_.back();
+        free_nodes_.pop_back();
+    }
+    nodes_[node] = {.dog = dog, .deadline = deadline};
+    nodes_by_dog_.emplace(dog, node);
+    Insert(node);
+}
+
+void RetirementTracker::OnMove(DogId dog) {
+    const auto it = nodes_by_dog_.find(dog);
+    if (it == nodes_by_dog_.end()) {
+        return;
+    }
+    Unlink(it->second);
+    free_nodes_.push_back(it->second);
+    nodes_by_dog_.erase(it);
+}
+
+void RetirementTracker::Advance(Milliseconds now, const RetireHandler& on_retire) {
+    const auto target = static_cast<uint64_t>(now.count());
+    assert(target >= current_);
+
+    Retire(OVERDUE_SLOT, on_retire);
+    for (uint64_t time = GetNextEventTime(); time <= target; time = GetNextEventTime()) {
+        current_ = time;
+        // Ячейки, в диапазон которых вошло время, переносятся на нижние уровни.
+        // Сроки, равные текущему времени, попадают при переносе в OVERDUE_SLOT
+        for (int level = LEVELS - 1; level > 0; --level) {
+            const uint32_t digit = GetDigit(time, level);
+            if (occupied_[level] & (uint64_t{1} << digit)) {
+                Cascade(level * SLOTS_PER_LEVEL + digit);
+            }
+        }
+        Retire(GetDigit(time, 0), on_retire);
+        Retire(OVERDUE_SLOT, on_retire);
+    }
+    current_ = target;
+}
+
+void RetirementTracker::Insert(uint32_t node) {
+    Node& entry = nodes_[node];
+    if (entry.deadline <= current_) {
+        entry.slot = OVERDUE_SLOT;
+    } else {
+        const int level = (63 - std::countl_zero(entry.deadline ^ current_)) / SLOT_BITS;
+        const uint32_t digit = GetDigit(entry.deadline, level);
+        entry.slot = level * SLOTS_PER_LEVEL + digit;
+        occupied_[level] |= uint64_t{1} << digit;
+    }
+    entry.prev = NO_NODE;
+    entry.next = heads_[entry.slot];
+    if (entry.next != NO_NODE) {
+        nodes_[entry.next].prev = node;
+    }
+    heads_[entry.slot] = node;
+}
+
+void RetirementTracker::Unlink(uint32_t node) {
+    const Node& entry = nodes_[node];
+    if (entry.prev != NO_NODE) {
+        nodes_[entry.prev].next = entry.next;
+    } else {
+        heads_[entry.slot] = entry.next;
+        if (entry.next == NO_NODE && entry.slot != OVERDUE_SLOT) {
+            occupied_[entry.slot / SLOTS_PER_LEVEL] &= ~(uint64_t{1} << (entry.slot % SLOTS_PER_LEVEL));
+        }
+    }
+    if (entry.next != NO_NODE) {
+        nodes_[entry.next].prev = entry.prev;
+    }
+}
+
+void RetirementTracker::Cascade(uint32_t slot) {
+    uint32_t node = std::exchange(heads_[slot], NO_NODE);
+    occupied_[slot / SLOTS_PER_LEVEL] &= ~(uint64_t{1} << (slot % SLOTS_PER_LEVEL));
+    while (node != NO_NODE) {
+        const uint32_t next = nodes_[node].next;
+        Insert(node);
+        node = next;
+    }
+}
+
+void RetirementTracker::Retire(uint32_t slot, const RetireHandler& on_retire) {
+    uint32_t node = std::exchange(heads_[slot], NO_NODE);
+    if (node == NO_NODE) {
+        return;
+    }
+    if (slot != OVERDUE_SLOT) {
+        occupied_[slot / SLOTS_PER_LEVEL] &= ~(uint64_t{1} << (slot % SLOTS_PER_LEVEL));
+    }
+
+    std::vector<uint32_t> expired;
+    for (; node != NO_NODE; node = nodes_[node].next) {
+        expired.push_back(node);
+    }
+    // В OVERDUE_SLOT могут оказаться разные сроки
+    std::sort(expired.begin(), expired.end(), [this](uint32_t lhs, uint32_t rhs) {
+        return nodes_[lhs].deadline < nodes_[rhs].deadline;
+    });
+    for (const uint32_t expired_node : expired) {
+        const Node entry = nodes_[expired_node];
+        nodes_by_dog_.erase(entry.dog);
+        free_nodes_.push_back(expired_node);
+        on_retire(entry.dog, Milliseconds{static_cast<int64_t>(entry.deadline)});
+    }
+}
+
+uint64_t RetirementTracker::GetNextEventTime() const noexcept {
+    uint64_t next = UINT64_MAX;
+    for (int level = 0; level < LEVELS; ++level) {
+        const uint32_t digit = GetDigit(current_, level);
+        // Занятые ячейки уровня всегда лежат после текущей
+        const uint64_t later = digit + 1 < SLOTS_PER_LEVEL ? occupied_[level] & (~uint64_t{0} << (digit + 1)) : 0;
+        if (later == 0) {
+            continue;
+        }
+        const int shift = level * SLOT_BITS;
+        const int upper_shift = shift + SLOT_BITS;
+        const uint64_t upper = upper_shift < 64 ? (current_ >> upper_shift) << upper_shift : 0;
+        next = std::min(next, upper | (uint64_t{static_cast<uint32_t>(std::countr_zero(later))} << shift));
+    }
+    return next;
+}
+
+}  // namespace app
@@ -0,0 +1,89 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace app {
+
+/*
+ * Отслеживает бездействие собак и определяет, когда они уходят на покой.
+ *
+ * Собака уходит на покой, если стоит на месте не меньше retirement_time.
+ * Вместо проверки всех собак на каждом такте срок ухода каждой стоящей собаки
+ * хранится в иерархическом таймерном колесе. Уровень колеса состоит из 64 ячеек,
+ * ячейка уровня l охватывает 64^l миллисекунд. Срок попадает на уровень,
+ * соответствующий старшему разряду, которым он отличается от текущего времени,
+ * и по мере приближения переносится на нижние уровни. Маски занятых ячеек
+ * позволяют сразу переходить к ближайшему событию, поэтому такт обрабатывает
+ * только собак, чей срок истёк, и ячейки, которые пора перенести.
+ *
+ * Собака, остановившаяся в момент t, уходит на покой на первом такте,
+ * завершившемся в момент now >= t + retirement_time, - так же, как при проверке
+ * накопленного времени бездействия всех собак на каждом такте.
+ */
+class RetirementTracker {
+public:
+    using DogId = uint32_t;
+    using Milliseconds = std::chrono::milliseconds;
+    // Вызывается для ушедшей на покой собаки со сроком её ухода
+    using RetireHandler = std::function<void(DogId dog, Milliseconds deadline)>;
+
+    explicit RetirementTracker(Milliseconds retirement_time, Milliseconds now = Milliseconds{0});
+
+    // Собака стоит на месте с момента since (новая собака или остановившаяся).
+    // Повторный вызов для стоящей собаки переносит её срок
+    void OnIdle(DogId dog, Milliseconds since);
+
+    // Собака начала двигаться или покинула игру: её срок снимается
+    void OnMove(DogId dog);
+
+    // Продвигает время до now и вызывает on_retire для собак, чей срок
+    // не позже now, в порядке возрастания сроков. Ушедшие собаки больше
+    // не отслеживаются. now не может быть меньше времени предыдущего вызова
+    void Advance(Milliseconds now, const RetireHandler& on_retire);
+
+    size_t GetIdleDogCount() const noexcept {
+        return nodes_by_dog_.size();
+    }
+
+private:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS_PER_LEVEL = 1u << SLOT_BITS;
+    static constexpr int LEVELS = (64 + SLOT_BITS - 1) / SLOT_BITS;
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+    // Ячейка для сроков, наступивших раньше текущего времени колеса
+    static constexpr uint32_t OVERDUE_SLOT = LEVELS * SLOTS_PER_LEVEL;
+
+    struct Node {
+        DogId dog = 0;
+        uint64_t deadline = 0;
+        uint32_t slot = 0;
+        uint32_t prev = NO_NODE;
+        uint32_t next = NO_NODE;
+    };
+
+    // Разряд времени, задающий ячейку на уровне level
+    static uint32_t GetDigit(uint64_t time, int level) noexcept {
+        return static_cast<uint32_t>(time >> (level * SLOT_BITS)) & (SLOTS_PER_LEVEL - 1);
+    }
+
+    void Insert(uint32_t node);
+    void Unlink(uint32_t node);
+    void Cascade(uint32_t slot);
+    void Retire(uint32_t slot, const RetireHandler& on_retire);
+    // Ближайший момент после текущего, в который нужно перенести или обработать ячейку
+    uint64_t GetNextEventTime() const noexcept;
+
+    uint64_t retirement_time_;
+    uint64_t current_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+    std::unordered_map<DogId, uint32_t> nodes_by_dog_;
+    std::array<uint32_t, OVERDUE_SLOT + 1> heads_;
+    std::array<uint64_t, LEVELS> occupied_{};
+};
+
+}  // namespace app
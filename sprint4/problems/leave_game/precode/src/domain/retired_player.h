@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace domain {
+
+// Итог игры собаки, ушедшей на покой после dogRetirementTime секунд бездействия
+struct RetiredPlayer {
+    std::string name;
+    int score = 0;
+    std::chrono::milliseconds play_time{0};
+
+    [[nodiscard]] auto operator<=>(const RetiredPlayer&) const = default;
+};
+
+// Порядок таблицы рекордов: очки по убыванию, затем время игры и имя по возрастанию
+struct RecordOrder {
+    bool operator()(const RetiredPlayer& lhs, const RetiredPlayer& rhs) const noexcept {
+        if (lhs.score != rhs.score) {
+            return lhs.score > rhs.score;
+        }
+        if (lhs.play_time != rhs.play_time) {
+            return lhs.play_time < rhs.play_time;
+        }
+        return lhs.name < rhs.name;
+    }
+};
+
+// Хранилище временно недоступно, например из-за разрыва соединения.
+// В отличие от других ошибок сохранения, повтор той же записи может удаться
+class RepositoryUnavailable : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class RetiredPlayerRepository {
+public:
+    // Реализация выбирается настройками сервера и удаляется через этот интерфейс
+    virtual ~RetiredPlayerRepository() = default;
+
+    // Сохраняет записи в одной транзакции: либо все, либо ни одной.
+    // Выбрасывает RepositoryUnavailable, если хранилище недоступно,
+    // и другое исключение, если оно отвергло сами записи
+    virtual void SaveBatch(std::span<const RetiredPlayer> players) = 0;
+
+    // Возвращает все сохранённые записи в произвольном порядке
+    virtual std::vector<RetiredPlayer> LoadAll() = 0;
+
+    // Возвращает не больше max_items записей, начиная с места start в порядке RecordOrder
+    virtual std::vector<RetiredPlayer> GetRecords(size_t start, size_t max_items) = 0;
+};
+
+}  // namespace domain
@@ -0,0 +1,350 @@
+#include "embedded.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <boost/crc.hpp>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+namespace embedded {
+
+using namespace std::literals;
+
+namespace {
+
+/*
+ * Раскладка файла:
+ *   FileHeader
+ *   кадры: FrameHeader, затем count записей RecordHeader + имя (name_size байт)
+ * Контрольная сумма кадра считается по всему, что следует за ней, включая
+ * размер и число записей: иначе испорченный размер выглядел бы как обрыв.
+ * Числа хранятся в порядке байтов little-endian.
+ */
+constexpr std::string_view MAGIC = "GRECORDS"sv;
+constexpr uint32_t VERSION = 1;
+// Наибольшее число записей в кадре при сжатии файла
+constexpr size_t MAX_FRAME_RECORDS = 65'536;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct FrameHeader {
+    uint32_t checksum;
+    uint32_t size;
+    uint32_t count;
+};
+
+struct RecordHeader {
+    int32_t score;
+    uint32_t name_size;
+    int64_t play_time_ms;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 16);
+static_assert(sizeof(FrameHeader) == 12);
+static_assert(sizeof(RecordHeader) == 16);
+constexpr size_t CHECKED_OFFSET = offsetof(FrameHeader, size);
+
+template <typename T>
+void Append(std::string& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T ReadAt(std::string_view data, size_t offset) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+uint32_t Checksum(std::string_view data) noexcept {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+std::string EncodeHeader() {
+    FileHeader header{{}, VERSION, 0};
+    std::memcpy(header.magic, MAGIC.data(), sizeof(header.magic));
+    std::string out;
+    Append(out, header);
+    return out;
+}
+
+template <typename Iterator>
+void AppendFrame(std::string& out, Iterator begin, Iterator end) {
+    const size_t header_offset = out.size();
+    out.resize(out.size() + sizeof(FrameHeader));
+    uint32_t count = 0;
+    for (auto it = begin; it != end; ++it, ++count) {
+        Append(out, RecordHeader{it->score, static_cast<uint32_t>(it->name.size()),
+                                 static_cast<int64_t>(it->play_time.count())});
+        out.append(it->name);
+    }
+    FrameHeader header{0, static_cast<uint32_t>(out.size() - header_offset - sizeof(FrameHeader)), count};
+    std::memcpy(out.data() + header_offset, &header, sizeof(header));
+    header.checksum = Checksum(std::string_view{out}.substr(header_offset + CHECKED_OFFSET));
+    std::memcpy(out.data() + header_offset, &header, sizeof(header));
+}
+
+// Есть ли после offset целый кадр. Кадр, выходящий за конец файла, считается
+// оборванным, только если за ним нет целых кадров: иначе его размер испорчен
+bool HasFrameAfter(std::string_view data, size_t offset) {
+    for (size_t position = offset + 1; data.size() - position >= sizeof(FrameHeader); ++position) {
+        const auto frame = ReadAt<FrameHeader>(data, position);
+        if (frame.size <= data.size() - position - sizeof(FrameHeader)
+            && Checksum(data.substr(position + CHECKED_OFFSET, sizeof(FrameHeader) - CHECKED_OFFSET + frame.size))
+                   == frame.checksum) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Разбирает кадры и возвращает размер их целой части. Оборванный кадр в конце
+// файла не считается ошибкой, а испорченный кадр, за которым следуют другие
+// данные, - считается: отрезав его, мы потеряли бы и все следующие группы
+template <typename Handler>
+uint64_t ScanFrames(std::string_view data, Handler&& handler) {
+    size_t offset = sizeof(FileHeader);
+    while (data.size() - offset >= sizeof(FrameHeader)) {
+        const auto frame = ReadAt<FrameHeader>(data, offset);
+        if (frame.size > data.size() - offset - sizeof(FrameHeader)) {
+            if (HasFrameAfter(data, offset)) {
+                throw std::runtime_error("Corrupted records file");
+            }
+            break;
+        }
+        const auto body = data.substr(offset + sizeof(FrameHeader), frame.size);
+        if (Checksum(data.substr(offset + CHECKED_OFFSET, sizeof(FrameHeader) - CHECKED_OFFSET + frame.size))
+            != frame.checksum) {
+            if (offset + sizeof(FrameHeader) + frame.size != data.size()) {
+                throw std::runtime_error("Corrupted records file");
+            }
+            break;
+        }
+
+        size_t position = 0;
+        for (uint32_t i = 0; i < frame.count; ++i) {
+            if (body.size() - position < sizeof(RecordHeader)) {
+                throw std::runtime_error("Corrupted records file");
+            }
+            const auto record = ReadAt<RecordHeader>(body, position);
+            position += sizeof(RecordHeader);
+            if (record.name_size > body.size() - position) {
+                throw std::runtime_error("Corrupted records file");
+            }
+            handler(domain::RetiredPlayer{std::string{body.substr(position, record.name_size)}, record.score,
+                                          std::chrono::milliseconds{record.play_time_ms}});
+            position += record.name_size;
+        }
+        if (position != body.size()) {
+            throw std::runtime_error("Corrupted records file");
+        }
+        offset += sizeof(FrameHeader) + frame.size;
+    }
+    return offset;
+}
+
+std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream in{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+int OpenForAppend(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to open "s + path.string());
+    }
+    return fd;
+}
+
+void WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "Failed to write the records file");
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+void Sync(int fd) {
+    if (::fdatasync(fd) != 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to sync the records file");
+    }
+}
+
+// Сохраняет на диске запись каталога о переименованном файле
+void SyncDirectory(const std::filesystem::path& file_path) {
+    const std::filesystem::path directory = file_path.has_parent_path() ? file_path.parent_path() : ".";
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to open "s + directory.string());
+    }
+    const int result = ::fsync(fd);
+    const int error = errno;
+    ::close(fd);
+    if (result != 0) {
+        throw std::system_error(error, std::generic_category(), "Failed to sync "s + directory.string());
+    }
+}
+
+}  // namespace
+
+RetiredPlayerRepositoryImpl::RetiredPlayerRepositoryImpl(FileStoreConfig config)
+    : config_{std::move(config)} {
+    const std::string data = ReadFile(config_.path);
+    uint64_t valid_size = 0;
+    if (data.size() >= sizeof(FileHeader)) {
+        const auto header = ReadAt<FileHeader>(data, 0);
+        if (std::string_view{header.magic, sizeof(header.magic)} != MAGIC) {
+            throw std::runtime_error(config_.path.string() + " is not a records file"s);
+        }
+        if (header.version != VERSION) {
+            throw std::runtime_error("Unsupported records file version "s + std::to_string(header.version));
+        }
+        // После сжатия записи идут по порядку, и вставка в конец не требует поиска
+        valid_size = ScanFrames(data, [this](domain::RetiredPlayer player) {
+            records_.insert(records_.end(), std::move(player));
+        });
+    }
+
+    fd_ = OpenForAppend(config_.path);
+    try {
+        // Пустой файл или файл, оборвавшийся на заголовке, создаётся заново
+        if (valid_size != data.size() && ::ftruncate(fd_, static_cast<off_t>(valid_size)) != 0) {
+            throw std::system_error(errno, std::generic_category(), "Failed to truncate "s + config_.path.string());
+        }
+        if (valid_size == 0) {
+            WriteAll(fd_, EncodeHeader());
+            valid_size = sizeof(FileHeader);
+        }
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+    file_size_ = valid_size;
+}
+
+RetiredPlayerRepositoryImpl::~RetiredPlayerRepositoryImpl() {
+    ::close(fd_);
+}
+
+void RetiredPlayerRepositoryImpl::SaveBatch(std::span<const domain::RetiredPlayer> players) {
+    if (players.empty()) {
+        return;
+    }
+    std::string frame;
+    AppendFrame(frame, players.begin(), players.end());
+
+    // Запись на диск не блокирует чтение индекса, поэтому GetRecords
+    // не ждёт fdatasync и сжатия файла
+    std::lock_guard file_lock{file_mutex_};
+    try {
+        WriteAll(fd_, frame);
+        if (config_.sync) {
+            Sync(fd_);
+        }
+    } catch (const std::system_error& ex) {
+        // Недописанный кадр отрезается, чтобы следующие группы не оказались за ним
+        [[maybe_unused]] const int result = ::ftruncate(fd_, static_cast<off_t>(file_size_));
+        // Нехватка места или сбой диска могут пройти, поэтому запись стоит повторить
+        throw domain::RepositoryUnavailable{ex.what()};
+    }
+    file_size_ += frame.size();
+    {
+        std::unique_lock lock{mutex_};
+        records_.insert(players.begin(), players.end());
+    }
+
+    if (++frames_since_compaction_ >= config_.compaction_threshold) {
+        try {
+            CompactLocked();
+        } catch (const std::exception&) {
+            // Группа уже сохранена, поэтому ошибка сжатия не должна приводить
+            // к повторной записи. Сжатие повторится после следующей группы
+        }
+    }
+}
+
+std::vector<domain::RetiredPlayer> RetiredPlayerRepositoryImpl::LoadAll() {
+    std::shared_lock lock{mutex_};
+    return {records_.begin(), records_.end()};
+}
+
+std::vector<domain::RetiredPlayer> RetiredPlayerRepositoryImpl::GetRecords(size_t start, size_t max_items) {
+    std::shared_lock lock{mutex_};
+    std::vector<domain::RetiredPlayer> page;
+    if (start >= records_.size()) {
+        return page;
+    }
+    const size_t count = std::min(max_items, records_.size() - start);
+    page.reserve(count);
+    std::copy_n(records_.nth(start), count, std::back_inserter(page));
+    return page;
+}
+
+void RetiredPlayerRepositoryImpl::Compact() {
+    std::lock_guard file_lock{file_mutex_};
+    CompactLocked();
+}
+
+void RetiredPlayerRepositoryImpl::CompactLocked() {
+    // Индекс меняется только под file_mutex_, поэтому образ файла совпадает
+    // с индексом до конца сжатия
+    std::string data = EncodeHeader();
+    {
+        std::shared_lock lock{mutex_};
+        for (size_t start = 0; start < records_.size(); start += MAX_FRAME_RECORDS) {
+            AppendFrame(data, records_.nth(start),
+                        records_.nth(std::min(start + MAX_FRAME_RECORDS, records_.size())));
+        }
+    }
+
+    const std::filesystem::path temp_path = config_.path.string() + ".tmp";
+    const int temp_fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (temp_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to open "s + temp_path.string());
+    }
+    try {
+        WriteAll(temp_fd, data);
+        if (config_.sync) {
+            Sync(temp_fd);
+        }
+    } catch (...) {
+        ::close(temp_fd);
+        throw;
+    }
+    ::close(temp_fd);
+    std::filesystem::rename(temp_path, config_.path);
+
+    const int fd = OpenForAppend(config_.path);
+    ::close(fd_);
+    fd_ = fd;
+    file_size_ = data.size();
+    frames_since_compaction_ = 0;
+    if (config_.sync) {
+        SyncDirectory(config_.path);
+    }
+}
+
+}  // namespace embedded
@@ -0,0 +1,75 @@
+#pragma once
+#include <boost/multi_index/identity.hpp>
+#include <boost/multi_index/ranked_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+#include "../domain/retired_player.h"
+
+namespace embedded {
+
+struct FileStoreConfig {
+    std::filesystem::path path;
+    // После стольких дописанных групп файл переписывается заново
+    size_t compaction_threshold = 1024;
+    // Дожидаться ли записи каждой группы на диск
+    bool sync = true;
+};
+
+/*
+ * Хранит итоги игроков в локальном файле, когда Postgres недоступен или
+ * обращение к нему по сети слишком медленное.
+ *
+ * Файл только дописывается: каждая группа записей SaveBatch попадает в него
+ * одним кадром с контрольной суммой, поэтому после сбоя группа либо читается
+ * целиком, либо отбрасывается вместе с оборванным хвостом файла.
+ * Все записи держатся в памяти в ранжированном индексе, поэтому GetRecords
+ * не читает файл и работает за O(log n + k).
+ * Каждые compaction_threshold групп файл переписывается крупными кадрами
+ * в порядке таблицы рекордов: так он не разрастается заголовками мелких групп,
+ * а при запуске записи вставляются в индекс по порядку.
+ * Методы можно вызывать из разных потоков. Запись в файл и его сжатие
+ * не блокируют GetRecords: индекс блокируется только на время вставки.
+ */
+class RetiredPlayerRepositoryImpl : public domain::RetiredPlayerRepository {
+public:
+    // Читает файл, отбрасывая оборванный хвост, или создаёт пустой.
+    // Выбрасывает std::runtime_error, если файл повреждён
+    explicit RetiredPlayerRepositoryImpl(FileStoreConfig config);
+
+    RetiredPlayerRepositoryImpl(const RetiredPlayerRepositoryImpl&) = delete;
+    RetiredPlayerRepositoryImpl& operator=(const RetiredPlayerRepositoryImpl&) = delete;
+
+    ~RetiredPlayerRepositoryImpl() override;
+
+    void SaveBatch(std::span<const domain::RetiredPlayer> players) override;
+    std::vector<domain::RetiredPlayer> LoadAll() override;
+    std::vector<domain::RetiredPlayer> GetRecords(size_t start, size_t max_items) override;
+
+    // Переписывает файл, не дожидаясь порога
+    void Compact();
+
+private:
+    using Records = boost::multi_index_container<
+        domain::RetiredPlayer,
+        boost::multi_index::indexed_by<boost::multi_index::ranked_non_unique<
+            boost::multi_index::identity<domain::RetiredPlayer>, domain::RecordOrder>>>;
+
+    // Вызывается под file_mutex_
+    void CompactLocked();
+
+    FileStoreConfig config_;
+    // Защищает индекс records_
+    mutable std::shared_mutex mutex_;
+    Records records_;
+    // Упорядочивает запись в файл и защищает поля ниже
+    std::mutex file_mutex_;
+    int fd_ = -1;
+    uint64_t file_size_ = 0;
+    size_t frames_since_compaction_ = 0;
+};
+
+}  // namespace embedded
@@ -0,0 +1,103 @@
+#include "postgres.h"
+
+#include <algorithm>
+#include <limits>
+#include <pqxx/except>
+#include <pqxx/stream_to>
+#include <pqxx/zview.hxx>
+
+namespace postgres {
+
+using namespace std::literals;
+using pqxx::operator"" _zv;
+
+namespace {
+
+// LIMIT и OFFSET имеют тип bigint, а приведение большего числа дало бы отрицательное
+int64_t ToBigint(size_t value) noexcept {
+    return static_cast<int64_t>(std::min<uint64_t>(value, std::numeric_limits<int64_t>::max()));
+}
+
+}  // namespace
+
+RetiredPlayerRepositoryImpl::RetiredPlayerRepositoryImpl(std::string db_url)
+    : db_url_{std::move(db_url)} {
+    pqxx::work work{GetConnection()};
+    work.exec(R"(
+CREATE TABLE IF NOT EXISTS retired_players (
+    id UUID PRIMARY KEY DEFAULT gen_random_uuid(),
+    name varchar(100) NOT NULL,
+    score integer NOT NULL,
+    play_time_ms bigint NOT NULL
+);
+)"_zv);
+    // Имена сравниваются побайтно, как в domain::RecordOrder, а не по правилам языка базы
+    work.exec(R"(
+CREATE INDEX IF NOT EXISTS retired_players_score_idx
+    ON retired_players (score DESC, play_time_ms, name COLLATE "C");
+)"_zv);
+    work.commit();
+}
+
+pqxx::connection& RetiredPlayerRepositoryImpl::GetConnection() {
+    if (!connection_ || !connection_->is_open()) {
+        connection_.reset();
+        connection_.emplace(db_url_);
+    }
+    return *connection_;
+}
+
+void RetiredPlayerRepositoryImpl::SaveBatch(std::span<const domain::RetiredPlayer> players) {
+    try {
+        pqxx::work work{GetConnection()};
+        // COPY передаёт все строки одним потоком без разбора отдельных INSERT
+        auto stream = pqxx::stream_to::table(work, {"retired_players"sv}, {"name"sv, "score"sv, "play_time_ms"sv});
+        for (const auto& player : players) {
+            stream.write_values(player.name, player.score, static_cast<int64_t>(player.play_time.count()));
+        }
+        stream.complete();
+        work.commit();
+    } catch (const pqxx::broken_connection& ex) {
+        connection_.reset();
+        throw domain::RepositoryUnavailable{ex.what()};
+    }
+}
+
+std::vector<domain::RetiredPlayer> RetiredPlayerRepositoryImpl::LoadAll() {
+    try {
+        pqxx::read_transaction read{GetConnection()};
+        std::vector<domain::RetiredPlayer> players;
+        for (const auto& [name, score, play_time_ms] :
+             read.stream<std::string, int, int64_t>("SELECT name, score, play_time_ms FROM retired_players"_zv)) {
+            players.push_back({name, score, std::chrono::milliseconds{play_time_ms}});
+        }
+        return players;
+    } catch (const pqxx::broken_connection& ex) {
+        connection_.reset();
+        throw domain::RepositoryUnavailable{ex.what()};
+    }
+}
+
+std::vector<domain::RetiredPlayer> RetiredPlayerRepositoryImpl::GetRecords(size_t start, size_t max_items) {
+    try {
+        pqxx::read_transaction read{GetConnection()};
+        const auto result = read.exec_params(R"(
+SELECT name, score, play_time_ms FROM retired_players
+ORDER BY score DESC, play_time_ms, name COLLATE "C"
+LIMIT $1 OFFSET $2;
+)"_zv,
+                                             ToBigint(max_items), ToBigint(start));
+        std::vector<domain::RetiredPlayer> players;
+        players.reserve(result.size());
+        for (const auto& row : result) {
+            players.push_back({row[0].as<std::string>(), row[1].as<int>(),
+                               std::chrono::milliseconds{row[2].as<int64_t>()}});
+        }
+        return players;
+    } catch (const pqxx::broken_connection& ex) {
+        connection_.reset();
+        throw domain::RepositoryUnavailable{ex.what()};
+    }
+}
+
+}  // namespace postgres
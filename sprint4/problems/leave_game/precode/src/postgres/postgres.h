@@ -0,0 +1,32 @@
+#pragma once
+#include <optional>
+#include <pqxx/connection>
+#include <pqxx/transaction>
+#include <string>
+
+#include "../domain/retired_player.h"
+
+namespace postgres {
+
+class RetiredPlayerRepositoryImpl : public domain::RetiredPlayerRepository {
+public:
+    // Подключается к базе и создаёт таблицу, если её ещё нет
+    explicit RetiredPlayerRepositoryImpl(std::string db_url);
+
+    // Записывает игроков одной командой COPY. При разрыве соединения выбрасывает
+    // domain::RepositoryUnavailable, а следующий вызов подключается к базе заново
+    void SaveBatch(std::span<const domain::RetiredPlayer> players) override;
+
+    std::vector<domain::RetiredPlayer> LoadAll() override;
+
+    // Порядок совпадает с domain::RecordOrder и индексом retired_players_score_idx
+    std::vector<domain::RetiredPlayer> GetRecords(size_t start, size_t max_items) override;
+
+private:
+    pqxx::connection& GetConnection();
+
+    std::string db_url_;
+    std::optional<pqxx::connection> connection_;
+};
+
+}  // namespace postgres
@@ -0,0 +1,49 @@
+#include "records_backend.h"
+
+#include <stdexcept>
+#include <string_view>
+
+#include "postgres/postgres.h"
+
+namespace records_backend {
+
+using namespace std::literals;
+
+RecordsBackendConfig ParseRecordsBackendConfig(const boost::json::object& game_config, std::string db_url) {
+    RecordsBackendConfig config;
+    config.db_url = std::move(db_url);
+
+    const auto* section = game_config.if_contains("recordsBackend"sv);
+    if (section == nullptr) {
+        return config;
+    }
+    const auto& backend = section->as_object();
+    const std::string_view type = backend.at("type"sv).as_string();
+    if (type == "postgres"sv) {
+        config.type = RecordsBackendConfig::Type::POSTGRES;
+    } else if (type == "embedded"sv) {
+        config.type = RecordsBackendConfig::Type::EMBEDDED;
+        config.file_store.path = std::string{backend.at("path"sv).as_string()};
+        if (const auto* threshold = backend.if_contains("compactionThreshold"sv)) {
+            config.file_store.compaction_threshold = static_cast<size_t>(threshold->as_int64());
+        }
+        if (const auto* sync = backend.if_contains("sync"sv)) {
+            config.file_store.sync = sync->as_bool();
+        }
+    } else {
+        throw std::invalid_argument("Unknown records backend: "s + std::string{type});
+    }
+    return config;
+}
+
+std::unique_ptr<domain::RetiredPlayerRepository> MakeRecordsRepository(const RecordsBackendConfig& config) {
+    switch (config.type) {
+        case RecordsBackendConfig::Type::POSTGRES:
+            return std::make_unique<postgres::RetiredPlayerRepositoryImpl>(config.db_url);
+        case RecordsBackendConfig::Type::EMBEDDED:
+            return std::make_unique<embedded::RetiredPlayerRepositoryImpl>(config.file_store);
+    }
+    throw std::invalid_argument("Unknown records backend");
+}
+
+}  // namespace records_backend
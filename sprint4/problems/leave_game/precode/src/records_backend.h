@@ -0,0 +1,30 @@
+#pragma once
+#include <boost/json/object.hpp>
+#include <memory>
+#include <string>
+
+#include "domain/retired_player.h"
+#include "embedded/embedded.h"
+
+namespace records_backend {
+
+struct RecordsBackendConfig {
+    enum class Type { POSTGRES, EMBEDDED };
+
+    Type type = Type::POSTGRES;
+    // Адрес базы для Type::POSTGRES
+    std::string db_url;
+    // Файл рекордов для Type::EMBEDDED
+    embedded::FileStoreConfig file_store;
+};
+
+// Читает необязательный раздел "recordsBackend" настроек игры:
+//   {"type": "postgres"} - рекорды хранятся в базе по адресу db_url (по умолчанию);
+//   {"type": "embedded", "path": "records.bin", "compactionThreshold": 1024, "sync": true} -
+//   в локальном файле, compactionThreshold и sync необязательны.
+// Выбрасывает std::invalid_argument при неизвестном типе хранилища
+RecordsBackendConfig ParseRecordsBackendConfig(const boost::json::object& game_config, std::string db_url);
+
+std::unique_ptr<domain::RetiredPlayerRepository> MakeRecordsRepository(const RecordsBackendConfig& config);
+
+}  // namespace records_backend
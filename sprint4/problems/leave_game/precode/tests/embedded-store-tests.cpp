@@ -0,0 +1,146 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+
+#include "../src/embedded/embedded.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+domain::RetiredPlayer MakePlayer(std::string name, int score, int play_time_ms) {
+    return {std::move(name), score, std::chrono::milliseconds{play_time_ms}};
+}
+
+struct TempFile {
+    TempFile()
+        : path{fs::temp_directory_path() / ("records-test-"s + std::to_string(::getpid()) + ".bin")} {
+        fs::remove(path);
+    }
+
+    ~TempFile() {
+        fs::remove(path);
+        fs::remove(path.string() + ".tmp");
+    }
+
+    fs::path path;
+};
+
+}  // namespace
+
+SCENARIO("Embedded records store") {
+    GIVEN("an empty records file") {
+        TempFile file;
+        const embedded::FileStoreConfig config{file.path, 1024, false};
+        const std::vector first_batch{MakePlayer("Rex", 10, 5'000), MakePlayer("Ace", 30, 7'000)};
+        const std::vector second_batch{MakePlayer("Bob", 10, 5'000), MakePlayer("Max", 10, 3'000)};
+        const std::vector ordered{MakePlayer("Ace", 30, 7'000), MakePlayer("Max", 10, 3'000),
+                                  MakePlayer("Bob", 10, 5'000), MakePlayer("Rex", 10, 5'000)};
+        {
+            embedded::RetiredPlayerRepositoryImpl store{config};
+            store.SaveBatch(first_batch);
+            store.SaveBatch(second_batch);
+
+            THEN("records are returned in leaderboard order") {
+                CHECK(store.GetRecords(0, 100) == ordered);
+                CHECK(store.GetRecords(1, 2) == std::vector{ordered[1], ordered[2]});
+                CHECK(store.GetRecords(4, 10).empty());
+            }
+        }
+
+        WHEN("the file is reopened") {
+            embedded::RetiredPlayerRepositoryImpl store{config};
+            THEN("all saved records are loaded") {
+                CHECK(store.LoadAll() == ordered);
+            }
+        }
+
+        WHEN("the last batch is torn by a crash") {
+            fs::resize_file(file.path, fs::file_size(file.path) - 3);
+            embedded::RetiredPlayerRepositoryImpl store{config};
+            THEN("only the torn batch is lost") {
+                CHECK(store.LoadAll() == std::vector{first_batch[1], first_batch[0]});
+            }
+
+            AND_WHEN("more records are saved") {
+                store.SaveBatch(second_batch);
+                embedded::RetiredPlayerRepositoryImpl reopened{config};
+                THEN("they follow the intact part of the file") {
+                    CHECK(reopened.LoadAll() == ordered);
+                }
+            }
+        }
+
+        WHEN("a batch before the last one is corrupted") {
+            const auto size = fs::file_size(file.path);
+            {
+                std::fstream stream{file.path, std::ios::in | std::ios::out | std::ios::binary};
+                // Первый байт имени первой записи первой группы
+                stream.seekp(16 + 12 + 16);
+                stream.put('X');
+            }
+            THEN("the file is reported as corrupted and left intact") {
+                CHECK_THROWS_AS(embedded::RetiredPlayerRepositoryImpl{config}, std::runtime_error);
+                CHECK(fs::file_size(file.path) == size);
+            }
+        }
+
+        WHEN("the size of a batch before the last one is corrupted") {
+            const auto size = fs::file_size(file.path);
+            {
+                std::fstream stream{file.path, std::ios::in | std::ios::out | std::ios::binary};
+                // Старший байт размера первой группы: группа выходит за конец файла
+                stream.seekp(16 + 7);
+                stream.put('\x40');
+            }
+            THEN("it is not mistaken for a torn tail") {
+                CHECK_THROWS_AS(embedded::RetiredPlayerRepositoryImpl{config}, std::runtime_error);
+                CHECK(fs::file_size(file.path) == size);
+            }
+        }
+
+        WHEN("the file is compacted") {
+            const auto size_before = fs::file_size(file.path);
+            {
+                embedded::RetiredPlayerRepositoryImpl store{config};
+                store.Compact();
+            }
+            THEN("records are kept in fewer frames") {
+                CHECK(fs::file_size(file.path) < size_before);
+                embedded::RetiredPlayerRepositoryImpl store{config};
+                CHECK(store.LoadAll() == ordered);
+            }
+        }
+    }
+
+    GIVEN("a store with a small compaction threshold") {
+        TempFile file;
+        const embedded::FileStoreConfig config{file.path, 3, false};
+        std::vector<domain::RetiredPlayer> saved;
+        {
+            embedded::RetiredPlayerRepositoryImpl store{config};
+            for (int i = 0; i < 10; ++i) {
+                const std::vector batch{MakePlayer("Dog "s + std::to_string(i), i % 4, i * 100)};
+                store.SaveBatch(batch);
+                saved.insert(saved.end(), batch.begin(), batch.end());
+            }
+        }
+        THEN("records survive automatic compactions") {
+            std::ranges::sort(saved, domain::RecordOrder{});
+            embedded::RetiredPlayerRepositoryImpl store{config};
+            CHECK(store.LoadAll() == saved);
+        }
+    }
+
+    GIVEN("a file of another format") {
+        TempFile file;
+        std::ofstream{file.path} << "definitely not a records file";
+        THEN("it is not opened") {
+            CHECK_THROWS_AS(embedded::RetiredPlayerRepositoryImpl{{file.path}}, std::runtime_error);
+        }
+    }
+}
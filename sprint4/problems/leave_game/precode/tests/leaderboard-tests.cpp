@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+
+#include "../src/app/leaderboard.h"
+
+using namespace std::literals;
+
+namespace {
+
+domain::RetiredPlayer MakePlayer(std::string name, int score, int play_time_ms) {
+    return {std::move(name), score, std::chrono::milliseconds{play_time_ms}};
+}
+
+}  // namespace
+
+SCENARIO("Leaderboard") {
+    GIVEN("a leaderboard loaded from the database") {
+        app::Leaderboard leaderboard{{
+            MakePlayer("Rex", 10, 5'000),
+            MakePlayer("Ace", 30, 7'000),
+            MakePlayer("Bob", 10, 5'000),
+            MakePlayer("Max", 10, 3'000),
+        }};
+
+        THEN("records are ordered by score, play time and name") {
+            CHECK(leaderboard.GetPage(0, 100)
+                  == std::vector{MakePlayer("Ace", 30, 7'000), MakePlayer("Max", 10, 3'000),
+                                 MakePlayer("Bob", 10, 5'000), MakePlayer("Rex", 10, 5'000)});
+        }
+
+        THEN("a page can start anywhere") {
+            CHECK(leaderboard.GetPage(1, 2) == std::vector{MakePlayer("Max", 10, 3'000), MakePlayer("Bob", 10, 5'000)});
+            CHECK(leaderboard.GetPage(3, 10) == std::vector{MakePlayer("Rex", 10, 5'000)});
+            CHECK(leaderboard.GetPage(4, 10).empty());
+            CHECK(leaderboard.GetPage(100, 10).empty());
+        }
+
+        THEN("a page is serialized to JSON") {
+            CHECK(*leaderboard.GetPageJson(0, 2)
+                  == R"([{"name":"Ace","score":30,"playTime":7},{"name":"Max","score":10,"playTime":3}])"sv);
+            CHECK(*leaderboard.GetPageJson(10, 2) == "[]"sv);
+        }
+
+        WHEN("the same page is requested twice") {
+            const auto first = leaderboard.GetPageJson(0, 2);
+            const auto second = leaderboard.GetPageJson(0, 2);
+
+            THEN("the cached JSON is returned") {
+                CHECK(first == second);
+            }
+
+            AND_WHEN("a player retires") {
+                leaderboard.Add(MakePlayer("Top \"dog\"", 50, 1'500));
+
+                THEN("the page is rebuilt") {
+                    const auto updated = leaderboard.GetPageJson(0, 2);
+                    CHECK(updated != first);
+                    CHECK(*updated
+                          == R"([{"name":"Top \"dog\"","score":50,"playTime":1.5},{"name":"Ace","score":30,"playTime":7}])"sv);
+                    CHECK(leaderboard.GetSize() == 5);
+                }
+            }
+        }
+    }
+
+    GIVEN("many random records") {
+        std::mt19937 random{42};
+        std::uniform_int_distribution<int> score{0, 100};
+        std::vector<domain::RetiredPlayer> players;
+        app::Leaderboard leaderboard;
+        for (int i = 0; i < 1000; ++i) {
+            players.push_back(MakePlayer("Dog "s + std::to_string(i), score(random), score(random) * 100));
+            leaderboard.Add(players.back());
+        }
+        std::sort(players.begin(), players.end(), domain::RecordOrder{});
+
+        THEN("every page matches the sorted records") {
+            for (size_t start = 0; start < players.size(); start += 97) {
+                const auto page = leaderboard.GetPage(start, 50);
+                const auto end = players.begin() + static_cast<std::ptrdiff_t>(std::min(start + 50, players.size()));
+                CHECK(page == std::vector(players.begin() + static_cast<std::ptrdiff_t>(start), end));
+            }
+        }
+    }
+}
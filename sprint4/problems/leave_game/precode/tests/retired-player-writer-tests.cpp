@@ -0,0 +1,174 @@
+#include <catch2/catch_test_macros.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+#include "../src/app/retired_player_writer.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Репозиторий, который можно придержать и заставить отказывать
+struct MockRetiredPlayerRepository : domain::RetiredPlayerRepository {
+    std::mutex mutex;
+    std::condition_variable opened;
+    bool open = true;
+    int failures_left = 0;
+    // Записи с таким именем хранилище отвергает, как слишком длинные
+    std::string rejected_name;
+    std::vector<size_t> batch_sizes;
+    std::vector<domain::RetiredPlayer> saved;
+
+    void SaveBatch(std::span<const domain::RetiredPlayer> players) override {
+        std::unique_lock lock{mutex};
+        opened.wait(lock, [this] {
+            return open;
+        });
+        if (failures_left > 0) {
+            --failures_left;
+            throw domain::RepositoryUnavailable("connection lost");
+        }
+        for (const auto& player : players) {
+            if (player.name == rejected_name) {
+                throw std::invalid_argument("value too long");
+            }
+        }
+        batch_sizes.push_back(players.size());
+        saved.insert(saved.end(), players.begin(), players.end());
+    }
+
+    std::vector<domain::RetiredPlayer> LoadAll() override {
+        std::lock_guard lock{mutex};
+        return saved;
+    }
+
+    std::vector<domain::RetiredPlayer> GetRecords(size_t, size_t) override {
+        return {};
+    }
+
+    void SetOpen(bool value) {
+        {
+            std::lock_guard lock{mutex};
+            open = value;
+        }
+        opened.notify_all();
+    }
+};
+
+domain::RetiredPlayer MakePlayer(int i) {
+    return {"Dog "s + std::to_string(i), i * 10, std::chrono::milliseconds{i * 1000}};
+}
+
+struct Fixture {
+    MockRetiredPlayerRepository repository;
+    app::RetiredPlayerWriterConfig config{
+        .queue_capacity = 100,
+        .max_batch_size = 30,
+        .initial_retry_delay = 1ms,
+        .max_retry_delay = 4ms,
+    };
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "Retired player writer") {
+    GIVEN("a writer") {
+        WHEN("players are enqueued while the database is busy") {
+            repository.SetOpen(false);
+            app::RetiredPlayerWriter writer{repository, config};
+            for (int i = 0; i < 90; ++i) {
+                writer.Enqueue(MakePlayer(i));
+            }
+            repository.SetOpen(true);
+            writer.Flush();
+
+            THEN("they are saved in order in batches") {
+                REQUIRE(repository.saved.size() == 90);
+                for (int i = 0; i < 90; ++i) {
+                    CHECK(repository.saved[i] == MakePlayer(i));
+                }
+                CHECK(repository.batch_sizes.size() < 90);
+                for (const size_t size : repository.batch_sizes) {
+                    CHECK(size <= config.max_batch_size);
+                }
+                const auto stats = writer.GetStats();
+                CHECK(stats.enqueued == 90);
+                CHECK(stats.saved == 90);
+                CHECK(stats.batches == repository.batch_sizes.size());
+            }
+        }
+
+        WHEN("the database fails several times") {
+            repository.failures_left = 3;
+            size_t errors = 0;
+            app::RetiredPlayerWriter writer{repository, config, [&errors](const std::exception&) {
+                                                ++errors;
+                                            }};
+            writer.Enqueue(MakePlayer(1));
+            writer.Flush();
+
+            THEN("the batch is retried until it is saved") {
+                CHECK(repository.saved == std::vector{MakePlayer(1)});
+                CHECK(writer.GetStats().failed_attempts == 3);
+                CHECK(errors == 3);
+            }
+        }
+
+        WHEN("the database rejects one of the players") {
+            repository.SetOpen(false);
+            repository.rejected_name = MakePlayer(5).name;
+            app::RetiredPlayerWriter writer{repository, config};
+            for (int i = 0; i < 10; ++i) {
+                writer.Enqueue(MakePlayer(i));
+            }
+            repository.SetOpen(true);
+            writer.Flush();
+
+            THEN("only that player is dropped and the queue is not blocked") {
+                std::vector<domain::RetiredPlayer> expected;
+                for (int i = 0; i < 10; ++i) {
+                    if (i != 5) {
+                        expected.push_back(MakePlayer(i));
+                    }
+                }
+                CHECK(repository.saved == expected);
+                const auto stats = writer.GetStats();
+                CHECK(stats.saved == 9);
+                CHECK(stats.rejected == 1);
+                CHECK(stats.dropped == 0);
+            }
+        }
+
+        WHEN("the queue is full") {
+            repository.SetOpen(false);
+            app::RetiredPlayerWriter writer{repository, config};
+            size_t accepted = 0;
+            for (int i = 0; i < 200; ++i) {
+                accepted += writer.TryEnqueue(MakePlayer(i)) ? 1 : 0;
+            }
+
+            THEN("new players are not accepted until the writer catches up") {
+                // Поток записи мог успеть забрать одну группу до заполнения очереди
+                CHECK(accepted >= config.queue_capacity);
+                CHECK(accepted <= config.queue_capacity + config.max_batch_size);
+                repository.SetOpen(true);
+                writer.Flush();
+                CHECK(writer.TryEnqueue(MakePlayer(200)));
+                writer.Flush();
+                CHECK(repository.saved.size() == accepted + 1);
+            }
+        }
+
+        WHEN("the writer is destroyed while the database is down") {
+            repository.failures_left = 1'000'000;
+            {
+                app::RetiredPlayerWriter writer{repository, config};
+                writer.Enqueue(MakePlayer(1));
+            }
+            THEN("the destructor does not hang") {
+                CHECK(repository.saved.empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#include <catch2/catch_test_macros.hpp>
+#include <map>
+#include <random>
+#include <set>
+
+#include "../src/app/retirement_tracker.h"
+
+using namespace std::literals;
+using app::RetirementTracker;
+
+namespace {
+
+// Проверка всех собак на каждом такте, с которой сравнивается таймерное колесо
+class RetirementScan {
+public:
+    explicit RetirementScan(std::chrono::milliseconds retirement_time)
+        : retirement_time_{retirement_time} {
+    }
+
+    void OnIdle(uint32_t dog) {
+        idle_time_.try_emplace(dog, 0ms);
+    }
+
+    void OnMove(uint32_t dog) {
+        idle_time_.erase(dog);
+    }
+
+    std::set<uint32_t> Tick(std::chrono::milliseconds delta) {
+        std::set<uint32_t> retired;
+        for (auto it = idle_time_.begin(); it != idle_time_.end();) {
+            it->second += delta;
+            if (it->second >= retirement_time_) {
+                retired.insert(it->first);
+                it = idle_time_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return retired;
+    }
+
+private:
+    std::chrono::milliseconds retirement_time_;
+    std::map<uint32_t, std::chrono::milliseconds> idle_time_;
+};
+
+}  // namespace
+
+SCENARIO("Retirement tracker") {
+    GIVEN("a tracker with a 15 second retirement time") {
+        RetirementTracker tracker{15s};
+        std::vector<std::pair<uint32_t, std::chrono::milliseconds>> retired;
+        const auto on_retire = [&retired](uint32_t dog, std::chrono::milliseconds deadline) {
+            retired.emplace_back(dog, deadline);
+        };
+
+        WHEN("dogs stand still") {
+            tracker.OnIdle(1, 0ms);
+            tracker.OnIdle(2, 1'000ms);
+            tracker.Advance(14'999ms, on_retire);
+            THEN("they are not retired before their deadline") {
+                CHECK(retired.empty());
+                CHECK(tracker.GetIdleDogCount() == 2);
+            }
+
+            AND_WHEN("time passes both deadlines at once") {
+                tracker.Advance(20'000ms, on_retire);
+                THEN("both retire in deadline order") {
+                    CHECK(retired == std::vector{std::pair{1u, 15'000ms}, std::pair{2u, 16'000ms}});
+                    CHECK(tracker.GetIdleDogCount() == 0);
+                }
+            }
+        }
+
+        WHEN("a dog moves before its deadline") {
+            tracker.OnIdle(1, 0ms);
+            tracker.Advance(10'000ms, on_retire);
+            tracker.OnMove(1);
+            tracker.Advance(60'000ms, on_retire);
+            THEN("it is not retired") {
+                CHECK(retired.empty());
+            }
+
+            AND_WHEN("it stops again") {
+                tracker.OnIdle(1, 60'000ms);
+                tracker.Advance(75'000ms, on_retire);
+                THEN("the deadline counts from the stop") {
+                    CHECK(retired == std::vector{std::pair{1u, 75'000ms}});
+                }
+            }
+        }
+
+        WHEN("a deadline is far away") {
+            RetirementTracker slow{std::chrono::hours{24 * 365}};
+            slow.OnIdle(7, 123ms);
+            slow.Advance(std::chrono::hours{24 * 365}, on_retire);
+            slow.Advance(std::chrono::hours{24 * 365} + 123ms, on_retire);
+            THEN("it is retired exactly on time") {
+                CHECK(retired == std::vector{std::pair{7u, std::chrono::milliseconds{std::chrono::hours{24 * 365}} + 123ms}});
+            }
+        }
+    }
+
+    GIVEN("random dogs that start and stop moving") {
+        constexpr auto retirement_time = 15s;
+        RetirementTracker tracker{retirement_time};
+        RetirementScan scan{retirement_time};
+        std::mt19937 random{2024};
+        std::uniform_int_distribution<int> percent{0, 99};
+        std::uniform_int_distribution<int> tick{1, 200};
+
+        THEN("the wheel retires the same dogs on the same ticks as the scan") {
+            std::set<uint32_t> moving;
+            std::set<uint32_t> gone;
+            uint32_t next_dog = 0;
+            std::chrono::milliseconds now{0};
+            for (int i = 0; i < 10'000; ++i) {
+                // Новые собаки появляются стоящими
+                if (percent(random) < 5) {
+                    tracker.OnIdle(next_dog, now);
+                    scan.OnIdle(next_dog);
+                    ++next_dog;
+                }
+                for (uint32_t dog = 0; dog < next_dog; ++dog) {
+                    if (percent(random) != 0 || gone.contains(dog)) {
+                        continue;
+                    }
+                    if (moving.erase(dog) > 0) {
+                        tracker.OnIdle(dog, now);
+                        scan.OnIdle(dog);
+                    } else {
+                        moving.insert(dog);
+                        tracker.OnMove(dog);
+                        scan.OnMove(dog);
+                    }
+                }
+
+                // Иногда сервер долго не вызывает такт
+                const std::chrono::milliseconds delta{percent(random) == 0 ? 20'000 : tick(random)};
+                const auto previous = now;
+                now += delta;
+                std::set<uint32_t> retired;
+                tracker.Advance(now, [&](uint32_t dog, std::chrono::milliseconds deadline) {
+                    CHECK(deadline > previous);
+                    CHECK(deadline <= now);
+                    retired.insert(dog);
+                });
+                REQUIRE(retired == scan.Tick(delta));
+                // Ушедшие собаки больше не участвуют в игре
+                gone.insert(retired.begin(), retired.end());
+            }
+        }
+    }
+}
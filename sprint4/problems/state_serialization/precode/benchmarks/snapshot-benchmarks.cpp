@@ -0,0 +1,190 @@
+#include <benchmark/benchmark.h>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "../src/binary_snapshot.h"
+#include "../src/model_serialization.h"
+#include "../src/snapshot_restorer.h"
+
+/*
+ * Сравнение бинарного снимка с архивами boost::serialization.
+ *
+ * Мир состоит из DOG_COUNT собак, распределённых по сеансам. Архивы boost
+ * сохраняют те же собаки через DogRepr. Тесты сохранения измеряют запись в
+ * поток в памяти, тесты загрузки - восстановление модели из готового буфера.
+ *
+ * Тест Restore/snapshot восстанавливает сеансы из отображённого в память файла
+ * в заданное число потоков.
+ *
+ * Аргумент level тестов снимка - уровень сжатия zlib, 0 - снимок без сжатия.
+ * Сравнение bytes и времени при разных уровнях показывает, во что обходится
+ * уменьшение файла.
+ *
+ * Счётчик bytes - размер сохранённого состояния в байтах.
+ */
+
+namespace {
+
+using namespace std::literals;
+
+constexpr size_t DOG_COUNT = 100'000;
+constexpr size_t DOGS_PER_SESSION = 1'000;
+
+const std::vector<model::GameSession>& GetWorld() {
+    static const auto world = [] {
+        std::mt19937_64 random{2024};
+        std::uniform_real_distribution<double> coord{0, 1000};
+        std::uniform_real_distribution<double> speed{-3, 3};
+        std::vector<model::GameSession> sessions;
+        for (size_t i = 0; i < DOG_COUNT; ++i) {
+            if (i % DOGS_PER_SESSION == 0) {
+                sessions.emplace_back(model::GameSession::Id{static_cast<uint32_t>(sessions.size())},
+                                      model::MapId{"map"s + std::to_string(sessions.size() % 4)});
+            }
+            model::Dog dog{model::Dog::Id{static_cast<uint32_t>(i)}, "Dog "s + std::to_string(i),
+                           {coord(random), coord(random)}, 3};
+            dog.SetSpeed({speed(random), speed(random)});
+            dog.SetDirection(static_cast<model::Direction>(i % 4));
+            dog.AddScore(static_cast<model::Score>(i % 1000));
+            for (size_t j = 0; j < i % 4; ++j) {
+                [[maybe_unused]] const bool put
+                    = dog.PutToBag({model::FoundObject::Id{static_cast<uint32_t>(i * 4 + j)}, static_cast<unsigned>(j)});
+            }
+            sessions.back().AddDog(std::move(dog));
+        }
+        return sessions;
+    }();
+    return world;
+}
+
+template <typename OutputArchive>
+std::string SaveArchive() {
+    std::ostringstream out;
+    OutputArchive archive{out};
+    for (const auto& session : GetWorld()) {
+        for (const auto& dog : session.GetDogs()) {
+            serialization::DogRepr repr{dog};
+            archive << repr;
+        }
+    }
+    return std::move(out).str();
+}
+
+template <typename InputArchive>
+size_t LoadArchive(const std::string& data) {
+    std::istringstream in{data};
+    InputArchive archive{in};
+    std::vector<model::Dog> dogs;
+    dogs.reserve(DOG_COUNT);
+    for (size_t i = 0; i < DOG_COUNT; ++i) {
+        serialization::DogRepr repr;
+        archive >> repr;
+        dogs.push_back(repr.Restore());
+    }
+    return dogs.size();
+}
+
+std::string SaveSnapshot(int64_t level) {
+    serialization::SnapshotOptions options;
+    if (level > 0) {
+        options = {.codec = serialization::snapshot_format::Codec::ZLIB, .level = static_cast<int>(level)};
+    }
+    std::ostringstream out;
+    serialization::SaveSnapshot(out, GetWorld(), {}, 0, options);
+    return std::move(out).str();
+}
+
+template <typename OutputArchive>
+void BM_SaveArchive(benchmark::State& state) {
+    size_t bytes = 0;
+    for (auto _ : state) {
+        bytes = SaveArchive<OutputArchive>().size();
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * DOG_COUNT));
+}
+
+template <typename OutputArchive, typename InputArchive>
+void BM_LoadArchive(benchmark::State& state) {
+    const std::string data = SaveArchive<OutputArchive>();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LoadArchive<InputArchive>(data));
+    }
+    state.counters["bytes"] = static_cast<double>(data.size());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * DOG_COUNT));
+}
+
+void BM_SaveSnapshot(benchmark::State& state) {
+    size_t bytes = 0;
+    for (auto _ : state) {
+        bytes = SaveSnapshot(state.range(0)).size();
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * DOG_COUNT));
+}
+
+void BM_LoadSnapshot(benchmark::State& state) {
+    const std::string data = SaveSnapshot(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(serialization::LoadSnapshot(data));
+    }
+    state.counters["bytes"] = static_cast<double>(data.size());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * DOG_COUNT));
+}
+
+void BM_RestoreSnapshot(benchmark::State& state) {
+    const auto path = std::filesystem::temp_directory_path() / "snapshot-benchmarks.bin";
+    const std::string data = SaveSnapshot(state.range(0));
+    {
+        std::ofstream out{path, std::ios::binary};
+        out << data;
+    }
+    for (auto _ : state) {
+        const serialization::SnapshotRestorer restorer{path};
+        benchmark::DoNotOptimize(restorer.RestoreSessions(static_cast<unsigned>(state.range(1))));
+    }
+    std::filesystem::remove(path);
+    state.counters["bytes"] = static_cast<double>(data.size());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * DOG_COUNT));
+}
+
+BENCHMARK(BM_SaveArchive<boost::archive::text_oarchive>)->Name("Save/text_oarchive")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SaveArchive<boost::archive::binary_oarchive>)->Name("Save/binary_oarchive")->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SaveSnapshot)
+    ->Name("Save/snapshot")
+    ->ArgName("level")
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(6)
+    ->Arg(9)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadArchive<boost::archive::text_oarchive, boost::archive::text_iarchive>)
+    ->Name("Load/text_iarchive")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadArchive<boost::archive::binary_oarchive, boost::archive::binary_iarchive>)
+    ->Name("Load/binary_iarchive")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadSnapshot)
+    ->Name("Load/snapshot")
+    ->ArgName("level")
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(6)
+    ->Arg(9)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RestoreSnapshot)
+    ->Name("Restore/snapshot")
+    ->ArgNames({"level", "threads"})
+    ->ArgsProduct({{0, 1, 6}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
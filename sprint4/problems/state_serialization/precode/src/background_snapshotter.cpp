@@ -0,0 +1,119 @@
+#include "background_snapshotter.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include "binary_snapshot.h"
+#include "file_sync.h"
+
+namespace serialization {
+
+BackgroundSnapshotter::BackgroundSnapshotter(std::filesystem::path state_file, SavedHandler on_saved,
+                                             SnapshotOptions options)
+    : state_file_{std::move(state_file)}
+    , temp_file_{state_file_.string() + ".tmp"}
+    , on_saved_{std::move(on_saved)}
+    , options_{options}
+    , worker_{[this](std::stop_token stop) {
+        Run(std::move(stop));
+    }} {
+}
+
+BackgroundSnapshotter::~BackgroundSnapshotter() {
+    Flush();
+}
+
+void BackgroundSnapshotter::Capture(std::span<const model::GameSession> sessions,
+                                    std::span<const model::Player> players, uint64_t log_sequence) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock{mutex_};
+        // Незаписанный образ заменяется более свежим
+        const size_t index = pending_.value_or(writing_ == 0 ? 1 : 0);
+        if (pending_) {
+            ++stats_.dropped;
+        }
+        // assign копирует собак поверх существующих и переиспользует их память
+        Image& image = images_[index];
+        image.sessions.assign(sessions.begin(), sessions.end());
+        image.players.assign(players.begin(), players.end());
+        image.log_sequence = log_sequence;
+        pending_ = index;
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+        stats_.last_capture_time = elapsed;
+        stats_.max_capture_time = std::max(stats_.max_capture_time, elapsed);
+        ++stats_.captures;
+    }
+    image_ready_.notify_one();
+}
+
+void BackgroundSnapshotter::Flush() {
+    std::unique_lock lock{mutex_};
+    image_saved_.wait(lock, [this] {
+        return !pending_ && !writing_;
+    });
+}
+
+SnapshotterStats BackgroundSnapshotter::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
+
+void BackgroundSnapshotter::Run(std::stop_token stop) {
+    std::unique_lock lock{mutex_};
+    // Остановка откладывается, пока есть незаписанный образ
+    while (image_ready_.wait(lock, stop, [this] {
+        return pending_.has_value();
+    }) || pending_) {
+        writing_ = std::exchange(pending_, std::nullopt);
+        const Image& image = images_[*writing_];
+        lock.unlock();
+
+        const auto start = std::chrono::steady_clock::now();
+        bool saved = true;
+        try {
+            Save(image);
+        } catch (const std::exception&) {
+            saved = false;
+        }
+        // on_saved вызывается, только когда снимок и его имя сохранены на диске
+        if (saved && on_saved_) {
+            on_saved_(image.log_sequence);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        lock.lock();
+        writing_.reset();
+        if (saved) {
+            ++stats_.saves;
+            stats_.last_save_time = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+        } else {
+            ++stats_.failures;
+        }
+        image_saved_.notify_all();
+    }
+}
+
+void BackgroundSnapshotter::Save(const Image& image) {
+    {
+        std::ofstream out{temp_file_, std::ios::binary | std::ios::trunc};
+        if (!out) {
+            throw std::runtime_error("Failed to open " + temp_file_.string());
+        }
+        SaveSnapshot(out, image.sessions, image.players, image.log_sequence, options_);
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Failed to write " + temp_file_.string());
+        }
+    }
+    // Снимок должен лечь на диск раньше, чем журнал действий удалит учтённые
+    // в нём записи в on_saved, иначе сбой питания оставит пустой файл без журнала
+    SyncFile(temp_file_);
+    std::filesystem::rename(temp_file_, state_file_);
+    SyncParentDirectory(state_file_);
+}
+
+}  // namespace serialization
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "binary_snapshot.h"
+#include "model.h"
+
+namespace serialization {
+
+struct SnapshotterStats {
+    // Время, в течение которого такт копировал состояние игры
+    std::chrono::nanoseconds last_capture_time{0};
+    std::chrono::nanoseconds max_capture_time{0};
+    // Время записи последнего снимка на диск в фоновом потоке
+    std::chrono::nanoseconds last_save_time{0};
+    uint64_t captures = 0;
+    uint64_t saves = 0;
+    uint64_t failures = 0;
+    // Образы, заменённые более свежими до того, как их успели записать
+    uint64_t dropped = 0;
+};
+
+/*
+ * Сохраняет снимки состояния игры в фоновом потоке.
+ *
+ * Capture вызывается на такте и только копирует сеансы в один из двух буферов.
+ * Пока фоновый поток пишет один буфер, такт заполняет другой. После прогрева
+ * копирование переиспользует память буфера и почти не выделяет её.
+ * Фоновый поток сериализует образ во временный файл рядом с файлом состояния,
+ * синхронизирует его с диском и атомарно переименовывает, синхронизируя затем
+ * каталог, поэтому на диске всегда лежит целый снимок, в том числе после
+ * сбоя питания.
+ * Если такт сделал несколько снимков, пока записывался предыдущий, на диск
+ * попадёт только последний из них. Сжатие снимка, если оно задано в options,
+ * тоже выполняется в фоновом потоке.
+ */
+class BackgroundSnapshotter {
+public:
+    // Вызывается в фоновом потоке после записи снимка на диск с номером последней
+    // учтённой в нём записи журнала действий
+    using SavedHandler = std::function<void(uint64_t log_sequence)>;
+
+    explicit BackgroundSnapshotter(std::filesystem::path state_file, SavedHandler on_saved = {},
+                                   SnapshotOptions options = {});
+
+    BackgroundSnapshotter(const BackgroundSnapshotter&) = delete;
+    BackgroundSnapshotter& operator=(const BackgroundSnapshotter&) = delete;
+
+    // Дожидается записи последнего снятого образа
+    ~BackgroundSnapshotter();
+
+    // Копирует состояние сеансов и таблицу игроков для записи. Не ждёт ввода-вывода.
+    // log_sequence - номер последней записи журнала действий, учтённой в состоянии
+    void Capture(std::span<const model::GameSession> sessions, std::span<const model::Player> players = {},
+                 uint64_t log_sequence = 0);
+
+    // Дожидается записи всех снятых образов
+    void Flush();
+
+    SnapshotterStats GetStats() const;
+
+private:
+    struct Image {
+        std::vector<model::GameSession> sessions;
+        std::vector<model::Player> players;
+        uint64_t log_sequence = 0;
+    };
+
+    void Run(std::stop_token stop);
+    void Save(const Image& image);
+
+    std::filesystem::path state_file_;
+    std::filesystem::path temp_file_;
+    SavedHandler on_saved_;
+    SnapshotOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any image_ready_;
+    std::condition_variable image_saved_;
+    Image images_[2];
+    std::optional<size_t> pending_;
+    std::optional<size_t> writing_;
+    SnapshotterStats stats_;
+
+    // Объявлен последним, чтобы остановиться раньше разрушения остальных полей
+    std::jthread worker_;
+};
+
+}  // namespace serialization
@@ -0,0 +1,410 @@
+#include "binary_snapshot.h"
+
+#include <algorithm>
+#include <boost/crc.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+#include "snapshot_view.h"
+
+namespace serialization {
+
+using namespace std::literals;
+namespace fmt = snapshot_format;
+namespace io = boost::iostreams;
+
+namespace {
+
+template <typename T>
+void Append(std::string& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint32_t CheckedSize(size_t size) {
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        throw SnapshotError("Session is too large for the snapshot format");
+    }
+    return static_cast<uint32_t>(size);
+}
+
+// Последовательно читает значения из буфера, проверяя его границы
+class Reader {
+public:
+    explicit Reader(std::string_view data) noexcept
+        : data_{data} {
+    }
+
+    template <typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::string_view Take(uint64_t size) {
+        if (size > data_.size() - offset_) {
+            throw SnapshotError("Truncated snapshot");
+        }
+        const auto result = data_.substr(offset_, size);
+        offset_ += size;
+        return result;
+    }
+
+    bool AtEnd() const noexcept {
+        return offset_ == data_.size();
+    }
+
+private:
+    std::string_view data_;
+    size_t offset_ = 0;
+};
+
+// Наибольшая степень сжатия, которой может достичь zlib
+constexpr uint64_t MAX_ZLIB_RATIO = 1032;
+
+void Compress(std::string_view data, const SnapshotOptions& options, std::string& out) {
+    out.clear();
+    io::filtering_ostream stream;
+    stream.push(io::zlib_compressor{io::zlib_params{options.level}});
+    stream.push(io::back_inserter(out));
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    // Сбрасывает в out остаток сжатых данных
+    stream.reset();
+}
+
+void Decompress(std::string_view data, uint64_t uncompressed_size, std::string& out) {
+    if (uncompressed_size > (data.size() + 1) * MAX_ZLIB_RATIO) {
+        throw SnapshotError("Invalid compressed section size");
+    }
+    out.clear();
+    out.reserve(uncompressed_size);
+    try {
+        io::filtering_istream stream;
+        stream.push(io::zlib_decompressor{});
+        stream.push(io::array_source{data.data(), data.size()});
+        io::copy(stream, io::back_inserter(out));
+    } catch (const io::zlib_error& ex) {
+        throw SnapshotError("Corrupted compressed section: "s + ex.what());
+    }
+    if (out.size() != uncompressed_size) {
+        throw SnapshotError("Compressed section size mismatch");
+    }
+}
+
+}  // namespace
+
+uint32_t SectionChecksum(std::string_view payload) noexcept {
+    boost::crc_32_type crc;
+    crc.process_bytes(payload.data(), payload.size());
+    return crc.checksum();
+}
+
+void EncodeSession(const model::GameSession& session, std::string& out) {
+    const auto& dogs = session.GetDogs();
+    const auto& lost_objects = session.GetLostObjects();
+    const std::string& map_id = *session.GetMapId();
+
+    size_t bag_item_count = 0;
+    size_t names_size = 0;
+    for (const auto& dog : dogs) {
+        bag_item_count += dog.GetBagContent().size();
+        names_size += dog.GetName().size();
+    }
+
+    const fmt::SessionHeader header{
+        .id = *session.GetId(),
+        .map_id_size = CheckedSize(map_id.size()),
+        .dog_count = CheckedSize(dogs.size()),
+        .lost_object_count = CheckedSize(lost_objects.size()),
+        .bag_item_count = CheckedSize(bag_item_count),
+        .names_size = CheckedSize(names_size),
+    };
+    out.reserve(out.size() + sizeof(header) + map_id.size() + dogs.size() * sizeof(fmt::DogRecord)
+                + lost_objects.size() * sizeof(fmt::LostObjectRecord)
+                + bag_item_count * sizeof(fmt::BagItemRecord) + names_size);
+    Append(out, header);
+    out.append(map_id);
+
+    uint32_t bag_offset = 0;
+    uint32_t name_offset = 0;
+    for (const auto& dog : dogs) {
+        const auto& bag = dog.GetBagContent();
+        const auto& name = dog.GetName();
+        fmt::DogRecord record{
+            .id = *dog.GetId(),
+            .score = dog.GetScore(),
+            .x = dog.GetPosition().x,
+            .y = dog.GetPosition().y,
+            .speed_x = dog.GetSpeed().x,
+            .speed_y = dog.GetSpeed().y,
+            .bag_capacity = dog.GetBagCapacity(),
+            .bag_offset = bag_offset,
+            .bag_size = static_cast<uint32_t>(bag.size()),
+            .name_offset = name_offset,
+            .name_size = static_cast<uint32_t>(name.size()),
+            .direction = static_cast<uint8_t>(dog.GetDirection()),
+            .reserved = {},
+        };
+        Append(out, record);
+        bag_offset += record.bag_size;
+        name_offset += record.name_size;
+    }
+
+    for (const auto& object : lost_objects) {
+        Append(out, fmt::LostObjectRecord{*object.id, object.type, object.position.x, object.position.y});
+    }
+    for (const auto& dog : dogs) {
+        for (const auto& item : dog.GetBagContent()) {
+            Append(out, fmt::BagItemRecord{*item.id, item.type});
+        }
+    }
+    for (const auto& dog : dogs) {
+        out.append(dog.GetName());
+    }
+}
+
+model::GameSession DecodeSession(std::string_view payload) {
+    const SessionView view{payload};
+    model::GameSession session{view.GetId(), model::MapId{std::string{view.GetMapId()}}};
+    session.Reserve(view.GetDogCount(), view.GetLostObjectCount());
+    for (size_t i = 0; i < view.GetDogCount(); ++i) {
+        const DogView record = view.GetDog(i);
+        model::Dog& dog = session.EmplaceDog(record.GetId(), std::string{record.GetName()}, record.GetPosition(),
+                                             record.GetBagCapacity());
+        dog.SetSpeed(record.GetSpeed());
+        dog.SetDirection(record.GetDirection());
+        dog.AddScore(record.GetScore());
+        for (size_t j = 0; j < record.GetBagSize(); ++j) {
+            // Вместимость рюкзака проверена SessionView
+            [[maybe_unused]] const bool put = dog.PutToBag(record.GetBagItem(j));
+        }
+    }
+    for (const auto& object : view.GetLostObjects()) {
+        session.AddLostObject(object);
+    }
+    return session;
+}
+
+void EncodePlayers(std::span<const model::Player> players, std::string& out) {
+    for (const auto& player : players) {
+        const std::string& token = *player.token;
+        Append(out, fmt::PlayerRecord{*player.session_id, *player.dog_id, CheckedSize(token.size())});
+        out.append(token);
+    }
+}
+
+std::vector<model::Player> DecodePlayers(std::string_view payload) {
+    Reader reader{payload};
+    std::vector<model::Player> players;
+    while (!reader.AtEnd()) {
+        const auto record = reader.Read<fmt::PlayerRecord>();
+        players.push_back({model::Token{std::string{reader.Take(record.token_size)}},
+                           model::GameSession::Id{record.session_id}, model::Dog::Id{record.dog_id}});
+    }
+    return players;
+}
+
+uint64_t DecodeLogPosition(std::string_view payload) {
+    Reader reader{payload};
+    const auto position = reader.Read<fmt::LogPositionRecord>();
+    if (!reader.AtEnd()) {
+        throw SnapshotError("Invalid log position");
+    }
+    return position.sequence;
+}
+
+void SnapshotSection::Verify() const {
+    if (SectionChecksum(payload) != checksum) {
+        throw SnapshotError("Snapshot checksum mismatch");
+    }
+}
+
+std::string_view SnapshotSection::Decode(std::string& buffer) const {
+    Verify();
+    if (codec == static_cast<uint32_t>(fmt::Codec::NONE)) {
+        return payload;
+    }
+    Decompress(payload, uncompressed_size, buffer);
+    return buffer;
+}
+
+void SaveSnapshot(std::ostream& out, std::span<const model::GameSession> sessions,
+                  std::span<const model::Player> players, uint64_t log_sequence, const SnapshotOptions& options) {
+    if (options.codec != fmt::Codec::NONE && options.codec != fmt::Codec::ZLIB) {
+        throw std::invalid_argument("Unknown snapshot codec");
+    }
+
+    fmt::FileHeader header{};
+    std::memcpy(header.magic, fmt::MAGIC.data(), sizeof(header.magic));
+    header.version = fmt::VERSION;
+    header.codec = static_cast<uint32_t>(options.codec);
+    // Позиция в журнале, игроки, сеансы и индекс
+    header.section_count = sessions.size() + 3;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t offset = sizeof(header);
+    uint64_t uncompressed_size = 0;
+    std::vector<fmt::IndexEntry> index;
+    index.reserve(sessions.size() + 2);
+    std::string payload;
+    std::string compressed;
+    const auto write_section = [&](fmt::SectionType type) {
+        std::string_view stored = payload;
+        if (options.codec == fmt::Codec::ZLIB && type != fmt::SectionType::INDEX) {
+            Compress(payload, options, compressed);
+            stored = compressed;
+        }
+        const fmt::SectionHeader section{static_cast<uint32_t>(type), SectionChecksum(stored), stored.size(),
+                                         payload.size()};
+        out.write(reinterpret_cast<const char*>(&section), sizeof(section));
+        out.write(stored.data(), static_cast<std::streamsize>(stored.size()));
+        const uint64_t size = sizeof(section) + stored.size();
+        index.push_back({section.type, 0, offset, size});
+        offset += size;
+        uncompressed_size += payload.size();
+    };
+
+    Append(payload, fmt::LogPositionRecord{log_sequence});
+    write_section(fmt::SectionType::LOG_POSITION);
+    payload.clear();
+    EncodePlayers(players, payload);
+    write_section(fmt::SectionType::PLAYERS);
+    for (const auto& session : sessions) {
+        payload.clear();
+        EncodeSession(session, payload);
+        write_section(fmt::SectionType::SESSION);
+    }
+
+    const uint64_t index_offset = offset;
+    payload.assign(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(fmt::IndexEntry));
+    write_section(fmt::SectionType::INDEX);
+    fmt::FileTrailer trailer{index_offset, uncompressed_size, {}};
+    std::memcpy(trailer.magic, fmt::TRAILER_MAGIC.data(), sizeof(trailer.magic));
+    out.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+    if (!out) {
+        throw std::runtime_error("Failed to write snapshot");
+    }
+}
+
+std::vector<SnapshotSection> ReadSnapshotIndex(std::string_view data) {
+    Reader reader{data};
+    const auto header = reader.Read<fmt::FileHeader>();
+    if (std::string_view{header.magic, sizeof(header.magic)} != fmt::MAGIC) {
+        throw SnapshotError("Not a game state snapshot");
+    }
+    if (header.version != fmt::VERSION) {
+        throw SnapshotError("Unsupported snapshot version "s + std::to_string(header.version));
+    }
+    if (header.codec != static_cast<uint32_t>(fmt::Codec::NONE)
+        && header.codec != static_cast<uint32_t>(fmt::Codec::ZLIB)) {
+        throw SnapshotError("Unsupported snapshot codec "s + std::to_string(header.codec));
+    }
+    if (data.size() < sizeof(fmt::FileHeader) + sizeof(fmt::FileTrailer)) {
+        throw SnapshotError("Truncated snapshot");
+    }
+
+    fmt::FileTrailer trailer;
+    std::memcpy(&trailer, data.data() + data.size() - sizeof(trailer), sizeof(trailer));
+    if (std::string_view{trailer.magic, sizeof(trailer.magic)} != fmt::TRAILER_MAGIC) {
+        throw SnapshotError("Truncated snapshot");
+    }
+    const auto body = data.substr(0, data.size() - sizeof(trailer));
+
+    // Читает секцию по смещению и проверяет, что она целиком лежит в файле
+    const auto read_section = [body, &header](uint64_t offset, uint64_t size, fmt::SectionType type) {
+        if (offset < sizeof(fmt::FileHeader) || offset > body.size() || size > body.size() - offset
+            || size < sizeof(fmt::SectionHeader)) {
+            throw SnapshotError("Invalid snapshot index");
+        }
+        Reader section_reader{body.substr(offset, size)};
+        const auto section_header = section_reader.Read<fmt::SectionHeader>();
+        const auto payload = section_reader.Take(section_header.size);
+        if (!section_reader.AtEnd()) {
+            throw SnapshotError("Invalid snapshot index");
+        }
+        // Индекс всегда хранится без сжатия
+        const uint32_t codec
+            = type == fmt::SectionType::INDEX ? static_cast<uint32_t>(fmt::Codec::NONE) : header.codec;
+        if (codec == static_cast<uint32_t>(fmt::Codec::NONE) && section_header.uncompressed_size != payload.size()) {
+            throw SnapshotError("Invalid snapshot index");
+        }
+        return SnapshotSection{section_header.type, section_header.checksum, codec, payload,
+                               section_header.uncompressed_size};
+    };
+
+    const auto index_section
+        = read_section(trailer.index_offset, body.size() - std::min<uint64_t>(trailer.index_offset, body.size()),
+                       fmt::SectionType::INDEX);
+    index_section.Verify();
+    if (index_section.type != static_cast<uint32_t>(fmt::SectionType::INDEX)
+        || index_section.payload.size() % sizeof(fmt::IndexEntry) != 0
+        || index_section.payload.size() / sizeof(fmt::IndexEntry) + 1 != header.section_count) {
+        throw SnapshotError("Invalid snapshot index");
+    }
+
+    std::vector<SnapshotSection> sections;
+    sections.reserve(header.section_count - 1);
+    uint64_t expected_offset = sizeof(fmt::FileHeader);
+    uint64_t uncompressed_size = index_section.uncompressed_size;
+    for (size_t i = 0; i * sizeof(fmt::IndexEntry) < index_section.payload.size(); ++i) {
+        fmt::IndexEntry entry;
+        std::memcpy(&entry, index_section.payload.data() + i * sizeof(entry), sizeof(entry));
+        // Секции идут подряд, поэтому индекс не может ссылаться на перекрывающиеся участки
+        if (entry.offset != expected_offset) {
+            throw SnapshotError("Invalid snapshot index");
+        }
+        auto section = read_section(entry.offset, entry.size, static_cast<fmt::SectionType>(entry.type));
+        if (section.type != entry.type) {
+            throw SnapshotError("Invalid snapshot index");
+        }
+        sections.push_back(section);
+        expected_offset += entry.size;
+        uncompressed_size += section.uncompressed_size;
+    }
+    if (expected_offset != trailer.index_offset || uncompressed_size != trailer.uncompressed_size) {
+        throw SnapshotError("Invalid snapshot index");
+    }
+    return sections;
+}
+
+SnapshotContent ReadSnapshot(std::string_view data) {
+    SnapshotContent content;
+    std::string buffer;
+    for (const auto& section : ReadSnapshotIndex(data)) {
+        const auto payload = section.Decode(buffer);
+        switch (static_cast<fmt::SectionType>(section.type)) {
+            case fmt::SectionType::SESSION:
+                content.sessions.push_back(DecodeSession(payload));
+                break;
+            case fmt::SectionType::LOG_POSITION:
+                content.log_sequence = DecodeLogPosition(payload);
+                break;
+            case fmt::SectionType::PLAYERS:
+                content.players = DecodePlayers(payload);
+                break;
+            default:
+                break;
+        }
+    }
+    return content;
+}
+
+std::vector<model::GameSession> LoadSnapshot(std::string_view data) {
+    return ReadSnapshot(data).sessions;
+}
+
+std::vector<model::GameSession> LoadSnapshot(std::istream& in) {
+    const std::string data{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    return LoadSnapshot(data);
+}
+
+}  // namespace serialization
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model.h"
+#include "snapshot_format.h"
+
+/*
+ * Бинарный снимок состояния игры. В отличие от текстового архива boost
+ * числа записываются без форматирования, а собаки сеанса - массивом записей
+ * фиксированного размера. Раскладка описана в snapshot_format.h.
+ *
+ * Секции могут сжиматься zlib: сжатие уменьшает файл и нагрузку на диск ценой
+ * времени процессора при записи и восстановлении.
+ */
+namespace serialization {
+
+// Снимок повреждён, обрезан или имеет неподдерживаемую версию формата
+class SnapshotError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+struct SnapshotContent {
+    std::vector<model::GameSession> sessions;
+    std::vector<model::Player> players;
+    // Номер последней записи журнала действий, учтённой в снимке
+    uint64_t log_sequence = 0;
+};
+
+struct SnapshotOptions {
+    snapshot_format::Codec codec = snapshot_format::Codec::NONE;
+    // Уровень сжатия zlib: от 1 (быстрее) до 9 (меньше)
+    int level = 6;
+};
+
+void SaveSnapshot(std::ostream& out, std::span<const model::GameSession> sessions,
+                  std::span<const model::Player> players = {}, uint64_t log_sequence = 0,
+                  const SnapshotOptions& options = {});
+
+// Выбрасывают SnapshotError, если снимок некорректен
+SnapshotContent ReadSnapshot(std::string_view data);
+std::vector<model::GameSession> LoadSnapshot(std::string_view data);
+std::vector<model::GameSession> LoadSnapshot(std::istream& in);
+
+// Дописывает в out содержимое секции сеанса без заголовка секции
+void EncodeSession(const model::GameSession& session, std::string& out);
+
+// Восстанавливает сеанс из содержимого секции.
+// Выбрасывает SnapshotError, если содержимое некорректно
+model::GameSession DecodeSession(std::string_view payload);
+
+void EncodePlayers(std::span<const model::Player> players, std::string& out);
+std::vector<model::Player> DecodePlayers(std::string_view payload);
+uint64_t DecodeLogPosition(std::string_view payload);
+
+// Контрольная сумма содержимого секции
+uint32_t SectionChecksum(std::string_view payload) noexcept;
+
+// Секция снимка, лежащего в памяти целиком
+struct SnapshotSection {
+    // Значение snapshot_format::SectionType
+    uint32_t type = 0;
+    uint32_t checksum = 0;
+    // Значение snapshot_format::Codec
+    uint32_t codec = 0;
+    // Содержимое в том виде, в каком оно лежит в файле
+    std::string_view payload;
+    uint64_t uncompressed_size = 0;
+
+    // Выбрасывает SnapshotError, если контрольная сумма не совпадает
+    void Verify() const;
+
+    // Проверяет контрольную сумму и возвращает содержимое секции. Сжатое
+    // содержимое распаковывается в buffer, несжатое возвращается без копирования.
+    // Выбрасывает SnapshotError, если секция повреждена
+    std::string_view Decode(std::string& buffer) const;
+};
+
+// Проверяет заголовок снимка и по индексу находит его секции, кроме самого
+// индекса. Содержимое секций не проверяется, чтобы их можно было проверять
+// и разбирать параллельно. Выбрасывает SnapshotError, если снимок некорректен
+std::vector<SnapshotSection> ReadSnapshotIndex(std::string_view data);
+
+}  // namespace serialization
@@ -0,0 +1,38 @@
+#include "file_sync.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
+#include <system_error>
+
+namespace serialization {
+
+using namespace std::literals;
+
+namespace {
+
+void SyncPath(const std::filesystem::path& path, int flags) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | flags);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to open "s + path.string());
+    }
+    const int result = ::fsync(fd);
+    const int error = errno;
+    ::close(fd);
+    if (result != 0) {
+        throw std::system_error(error, std::generic_category(), "Failed to sync "s + path.string());
+    }
+}
+
+}  // namespace
+
+void SyncFile(const std::filesystem::path& path) {
+    SyncPath(path, 0);
+}
+
+void SyncParentDirectory(const std::filesystem::path& path) {
+    SyncPath(path.has_parent_path() ? path.parent_path() : std::filesystem::path{"."}, O_DIRECTORY);
+}
+
+}  // namespace serialization
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <filesystem>
+
+namespace serialization {
+
+// Дожидается записи содержимого файла на диск.
+// Выбрасывает std::system_error при ошибке
+void SyncFile(const std::filesystem::path& path);
+
+// Дожидается записи на диск каталога, содержащего path, например, после
+// переименования path: без этого после сбоя питания каталог может ссылаться
+// на прежний файл. Выбрасывает std::system_error при ошибке
+void SyncParentDirectory(const std::filesystem::path& path);
+
+}  // namespace serialization
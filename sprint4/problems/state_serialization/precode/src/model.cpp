@@ -1,3 +1,25 @@
 #include "model.h"
 
-namespace model {}  // namespace model
+#include <algorithm>
+
+namespace model {
+
+bool GameSession::RemoveDog(const Dog::Id& id) {
+    const auto it = std::find_if(dogs_.begin(), dogs_.end(), [&id](const Dog& dog) {
+        return dog.GetId() == id;
+    });
+    if (it == dogs_.end()) {
+        return false;
+    }
+    dogs_.erase(it);
+    return true;
+}
+
+void GameSession::Tick(std::chrono::milliseconds delta) noexcept {
+    const double seconds = std::chrono::duration<double>{delta}.count();
+    for (auto& dog : dogs_) {
+        dog.SetPosition(dog.GetPosition() + dog.GetSpeed() * seconds);
+    }
+}
+
+}  // namespace model
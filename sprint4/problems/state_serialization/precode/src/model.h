@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -135,4 +136,97 @@ private:
 using DogPtr = std::shared_ptr<Dog>;
 using ConstDogPtr = std::shared_ptr<const Dog>;
 
+// Потерянный предмет, лежащий на карте
+struct LostObject {
+    using Id = util::Tagged<uint32_t, LostObject>;
+
+    Id id{0u};
+    LostObjectType type{0u};
+    geom::Point2D position;
+
+    [[nodiscard]] auto operator<=>(const LostObject&) const = default;
+};
+
+struct MapTag {};
+using MapId = util::Tagged<std::string, MapTag>;
+
+// Игровой сеанс на карте: собаки игроков и потерянные на карте предметы
+class GameSession {
+public:
+    using Id = util::Tagged<uint32_t, GameSession>;
+    using Dogs = std::vector<Dog>;
+    using LostObjects = std::vector<LostObject>;
+
+    GameSession(Id id, MapId map_id)
+        : id_(std::move(id))
+        , map_id_(std::move(map_id)) {
+    }
+
+    const Id& GetId() const noexcept {
+        return id_;
+    }
+
+    const MapId& GetMapId() const noexcept {
+        return map_id_;
+    }
+
+    const Dogs& GetDogs() const noexcept {
+        return dogs_;
+    }
+
+    Dogs& GetDogs() noexcept {
+        return dogs_;
+    }
+
+    const LostObjects& GetLostObjects() const noexcept {
+        return lost_objects_;
+    }
+
+    void Reserve(size_t dog_count, size_t lost_object_count) {
+        dogs_.reserve(dog_count);
+        lost_objects_.reserve(lost_object_count);
+    }
+
+    Dog& AddDog(Dog dog) {
+        return dogs_.emplace_back(std::move(dog));
+    }
+
+    // Создаёт собаку сразу в сеансе, передавая аргументы конструктору Dog
+    template <typename... Args>
+    Dog& EmplaceDog(Args&&... args) {
+        return dogs_.emplace_back(std::forward<Args>(args)...);
+    }
+
+    void AddLostObject(LostObject object) {
+        lost_objects_.push_back(std::move(object));
+    }
+
+    // Возвращает false, если собаки нет в сеансе. Сохраняет порядок остальных собак
+    bool RemoveDog(const Dog::Id& id);
+
+    // Перемещает собак в соответствии с их скоростями
+    void Tick(std::chrono::milliseconds delta) noexcept;
+
+private:
+    Id id_;
+    MapId map_id_;
+    Dogs dogs_;
+    LostObjects lost_objects_;
+};
+
+namespace detail {
+struct TokenTag {};
+}  // namespace detail
+
+using Token = util::Tagged<std::string, detail::TokenTag>;
+
+// Игрок управляет собакой в сеансе, предъявляя свой токен
+struct Player {
+    Token token{std::string{}};
+    GameSession::Id session_id{0u};
+    Dog::Id dog_id{0u};
+
+    [[nodiscard]] auto operator<=>(const Player&) const = default;
+};
+
 }  // namespace model
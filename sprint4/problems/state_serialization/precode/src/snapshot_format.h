@@ -0,0 +1,160 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+/*
+ * Раскладка бинарного снимка состояния игры.
+ *
+ * Файл начинается с FileHeader, за которым следуют секции. Каждая секция
+ * начинается с SectionHeader, содержащего тип, размер и контрольную сумму CRC-32
+ * её содержимого. Секции неизвестных типов пропускаются при чтении.
+ *
+ * FileHeader::codec задаёт сжатие содержимого секций. Каждая секция сжимается
+ * отдельно, поэтому секции по-прежнему можно распаковывать параллельно.
+ * Контрольная сумма считается по сжатому содержимому, а размер до сжатия
+ * хранится в SectionHeader::uncompressed_size. Индекс не сжимается.
+ * FileTrailer::uncompressed_size - суммарный размер содержимого секций
+ * до сжатия: его нельзя записать в заголовок, не зная заранее, сколько
+ * займут секции.
+ *
+ * Последняя секция - INDEX - перечисляет смещения и размеры остальных секций
+ * (IndexEntry[]), а за ней следует FileTrailer со смещением этой секции.
+ * По индексу отображённый в память файл можно разбирать по секциям
+ * параллельно, не просматривая его целиком.
+ *
+ * Секция PLAYERS содержит таблицу токенов игроков: записи PlayerRecord,
+ * за каждой из которых следует токен (token_size байт).
+ *
+ * Секция LOG_POSITION содержит номер последней записи журнала действий,
+ * учтённой в снимке. При восстановлении журнал применяется начиная со следующей.
+ *
+ * Секция сеанса устроена так:
+ *   SessionHeader
+ *   идентификатор карты (map_id_size байт)
+ *   DogRecord[dog_count]
+ *   LostObjectRecord[lost_object_count]
+ *   BagItemRecord[bag_item_count] - содержимое рюкзаков всех собак подряд
+ *   имена собак подряд (names_size байт)
+ *
+ * Записи имеют фиксированный размер, а имена и рюкзаки собак адресуются
+ * смещениями, поэтому к любой собаке можно обратиться, не разбирая предыдущих.
+ * Все числа хранятся в порядке байтов little-endian.
+ */
+namespace serialization::snapshot_format {
+
+inline constexpr std::string_view MAGIC = "GSNAPSHT";
+// Версия формата. Увеличивается при любом изменении раскладки файла
+inline constexpr uint32_t VERSION = 3;
+inline constexpr std::string_view TRAILER_MAGIC = "GSNAPIDX";
+
+static_assert(std::endian::native == std::endian::little);
+
+enum class Codec : uint32_t {
+    NONE = 0,
+    ZLIB = 1,
+};
+
+enum class SectionType : uint32_t {
+    SESSION = 1,
+    LOG_POSITION = 2,
+    PLAYERS = 3,
+    INDEX = 4,
+};
+
+#pragma pack(push, 1)
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    // Значение Codec
+    uint32_t codec;
+    uint64_t section_count;
+};
+
+struct SectionHeader {
+    uint32_t type;
+    uint32_t checksum;
+    // Размер содержимого в файле
+    uint64_t size;
+    uint64_t uncompressed_size;
+};
+
+struct LogPositionRecord {
+    uint64_t sequence;
+};
+
+struct SessionHeader {
+    uint32_t id;
+    uint32_t map_id_size;
+    uint32_t dog_count;
+    uint32_t lost_object_count;
+    uint32_t bag_item_count;
+    uint32_t names_size;
+};
+
+struct DogRecord {
+    uint32_t id;
+    uint32_t score;
+    double x;
+    double y;
+    double speed_x;
+    double speed_y;
+    uint64_t bag_capacity;
+    // Смещения отсчитываются от начала рюкзаков и имён секции
+    uint32_t bag_offset;
+    uint32_t bag_size;
+    uint32_t name_offset;
+    uint32_t name_size;
+    uint8_t direction;
+    uint8_t reserved[7];
+};
+
+struct LostObjectRecord {
+    uint32_t id;
+    uint32_t type;
+    double x;
+    double y;
+};
+
+struct BagItemRecord {
+    uint32_t id;
+    uint32_t type;
+};
+
+struct PlayerRecord {
+    uint32_t session_id;
+    uint32_t dog_id;
+    uint32_t token_size;
+};
+
+struct IndexEntry {
+    uint32_t type;
+    uint32_t reserved;
+    // Смещение заголовка секции от начала файла
+    uint64_t offset;
+    // Размер секции вместе с заголовком
+    uint64_t size;
+};
+
+struct FileTrailer {
+    uint64_t index_offset;
+    uint64_t uncompressed_size;
+    char magic[8];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 24);
+static_assert(sizeof(SectionHeader) == 24);
+static_assert(sizeof(LogPositionRecord) == 8);
+static_assert(sizeof(SessionHeader) == 24);
+static_assert(sizeof(DogRecord) == 72);
+static_assert(sizeof(LostObjectRecord) == 24);
+static_assert(sizeof(BagItemRecord) == 8);
+static_assert(sizeof(PlayerRecord) == 12);
+static_assert(sizeof(IndexEntry) == 24);
+static_assert(sizeof(FileTrailer) == 24);
+
+}  // namespace serialization::snapshot_format
@@ -0,0 +1,96 @@
+#include "snapshot_restorer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+#include "snapshot_format.h"
+
+namespace serialization {
+
+using namespace std::literals;
+namespace fmt = snapshot_format;
+
+SnapshotRestorer::SnapshotRestorer(const std::filesystem::path& path) {
+    try {
+        file_.open(path.string());
+    } catch (const std::exception& ex) {
+        throw SnapshotError("Failed to map "s + path.string() + ": "s + ex.what());
+    }
+
+    std::string buffer;
+    for (const auto& section : ReadSnapshotIndex({file_.data(), file_.size()})) {
+        switch (static_cast<fmt::SectionType>(section.type)) {
+            case fmt::SectionType::SESSION:
+                sessions_.push_back(section);
+                break;
+            case fmt::SectionType::LOG_POSITION:
+                log_sequence_ = DecodeLogPosition(section.Decode(buffer));
+                break;
+            case fmt::SectionType::PLAYERS:
+                players_ = DecodePlayers(section.Decode(buffer));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+std::vector<model::GameSession> SnapshotRestorer::RestoreSessions(unsigned thread_count) const {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = static_cast<unsigned>(std::min<size_t>(thread_count, sessions_.size()));
+
+    std::vector<size_t> order(sessions_.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+        return sessions_[lhs].uncompressed_size > sessions_[rhs].uncompressed_size;
+    });
+
+    std::vector<std::optional<model::GameSession>> restored(sessions_.size());
+    std::atomic<size_t> next{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    const auto worker = [&] {
+        // Буфер распакованной секции переиспользуется между секциями одного потока
+        std::string buffer;
+        for (size_t i = next++; i < order.size(); i = next++) {
+            try {
+                restored[order[i]].emplace(DecodeSession(sessions_[order[i]].Decode(buffer)));
+            } catch (...) {
+                std::lock_guard lock{error_mutex};
+                if (!error) {
+                    error = std::current_exception();
+                }
+                // Остальные потоки заканчивают работу, не беря новых секций
+                next = order.size();
+            }
+        }
+    };
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(thread_count > 0 ? thread_count - 1 : 0);
+        for (unsigned i = 1; i < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    std::vector<model::GameSession> sessions;
+    sessions.reserve(restored.size());
+    for (auto& session : restored) {
+        sessions.push_back(std::move(*session));
+    }
+    return sessions;
+}
+
+}  // namespace serialization
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "binary_snapshot.h"
+
+namespace serialization {
+
+/*
+ * Восстанавливает состояние игры из файла снимка, отображённого в память.
+ *
+ * Конструктор проверяет заголовок и индекс снимка и сразу читает таблицу игроков
+ * и позицию в журнале действий: этого достаточно, чтобы сервер начал принимать
+ * соединения, пока сеансы ещё восстанавливаются.
+ * RestoreSessions проверяет, распаковывает и разбирает секции сеансов параллельно.
+ * Потоки забирают секции по одной, начиная с самых больших, поэтому один
+ * крупный сеанс не задерживает остальные. Собаки создаются сразу в векторе сеанса.
+ */
+class SnapshotRestorer {
+public:
+    // Выбрасывает SnapshotError, если файл не удалось открыть или снимок некорректен
+    explicit SnapshotRestorer(const std::filesystem::path& path);
+
+    uint64_t GetLogSequence() const noexcept {
+        return log_sequence_;
+    }
+
+    const std::vector<model::Player>& GetPlayers() const noexcept {
+        return players_;
+    }
+
+    size_t GetSessionCount() const noexcept {
+        return sessions_.size();
+    }
+
+    // Возвращает сеансы в порядке их записи в снимок. При thread_count == 0
+    // используется по потоку на ядро. Выбрасывает SnapshotError,
+    // если какая-либо секция сеанса повреждена
+    std::vector<model::GameSession> RestoreSessions(unsigned thread_count = 0) const;
+
+private:
+    boost::iostreams::mapped_file_source file_;
+    std::vector<SnapshotSection> sessions_;
+    std::vector<model::Player> players_;
+    uint64_t log_sequence_ = 0;
+};
+
+}  // namespace serialization
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "snapshot_view.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct MapStats {
+    size_t sessions = 0;
+    size_t dogs = 0;
+    size_t lost_objects = 0;
+    size_t bag_items = 0;
+    uint64_t total_score = 0;
+    model::Score max_score = 0;
+};
+
+}  // namespace
+
+/*
+ * Печатает статистику по картам из файла снимка состояния игры: число сеансов,
+ * собак, потерянных предметов и предметов в рюкзаках, суммарные и лучшие очки.
+ * Модель не восстанавливается: собаки читаются прямо из отображённого файла.
+ */
+int main(int argc, const char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: snapshot_stats <snapshot-file>"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        const serialization::SnapshotReader reader{argv[1]};
+
+        std::map<std::string, MapStats, std::less<>> maps;
+        reader.ForEachSession([&maps](const serialization::SessionView& session) {
+            auto it = maps.find(session.GetMapId());
+            if (it == maps.end()) {
+                it = maps.emplace(std::string{session.GetMapId()}, MapStats{}).first;
+            }
+            MapStats& stats = it->second;
+            ++stats.sessions;
+            stats.dogs += session.GetDogCount();
+            stats.lost_objects += session.GetLostObjectCount();
+            for (const auto& dog : session.GetDogs()) {
+                stats.bag_items += dog.GetBagSize();
+                stats.total_score += dog.GetScore();
+                stats.max_score = std::max(stats.max_score, dog.GetScore());
+            }
+        });
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << std::left << std::setw(20) << "Map"sv << std::right << std::setw(10) << "Sessions"sv
+                  << std::setw(10) << "Dogs"sv << std::setw(10) << "Lost"sv << std::setw(10) << "In bags"sv
+                  << std::setw(14) << "Total score"sv << std::setw(12) << "Max score"sv << std::setw(12)
+                  << "Avg score"sv << '\n';
+        for (const auto& [map_id, stats] : maps) {
+            const double average
+                = stats.dogs > 0 ? static_cast<double>(stats.total_score) / static_cast<double>(stats.dogs) : 0;
+            std::cout << std::left << std::setw(20) << map_id << std::right << std::setw(10) << stats.sessions
+                      << std::setw(10) << stats.dogs << std::setw(10) << stats.lost_objects << std::setw(10)
+                      << stats.bag_items << std::setw(14) << stats.total_score << std::setw(12) << stats.max_score
+                      << std::setw(12) << std::fixed << std::setprecision(1) << average << '\n';
+        }
+        std::cout << "Elapsed: "sv << std::setprecision(2) << elapsed.count() << " ms"sv << std::endl;
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,84 @@
+#include "snapshot_view.h"
+
+#include <cstring>
+
+namespace serialization {
+
+using namespace std::literals;
+namespace fmt = snapshot_format;
+
+namespace {
+
+template <typename T>
+T ReadRecord(std::string_view records, size_t index) noexcept {
+    T record;
+    std::memcpy(&record, records.data() + index * sizeof(T), sizeof(T));
+    return record;
+}
+
+}  // namespace
+
+model::FoundObject DogView::GetBagItem(size_t index) const noexcept {
+    const auto item = ReadRecord<fmt::BagItemRecord>(bag_, index);
+    return {model::FoundObject::Id{item.id}, item.type};
+}
+
+SessionView::SessionView(std::string_view payload) {
+    size_t offset = 0;
+    const auto take = [&payload, &offset](uint64_t size) {
+        if (size > payload.size() - offset) {
+            throw SnapshotError("Truncated snapshot");
+        }
+        const auto result = payload.substr(offset, size);
+        offset += size;
+        return result;
+    };
+
+    std::memcpy(&header_, take(sizeof(header_)).data(), sizeof(header_));
+    map_id_ = take(header_.map_id_size);
+    dogs_ = take(uint64_t{header_.dog_count} * sizeof(fmt::DogRecord));
+    lost_objects_ = take(uint64_t{header_.lost_object_count} * sizeof(fmt::LostObjectRecord));
+    bag_items_ = take(uint64_t{header_.bag_item_count} * sizeof(fmt::BagItemRecord));
+    names_ = take(header_.names_size);
+    if (offset != payload.size()) {
+        throw SnapshotError("Unexpected data after session");
+    }
+
+    for (uint32_t i = 0; i < header_.dog_count; ++i) {
+        const auto record = ReadRecord<fmt::DogRecord>(dogs_, i);
+        if (uint64_t{record.bag_offset} + record.bag_size > header_.bag_item_count
+            || uint64_t{record.name_offset} + record.name_size > header_.names_size
+            || record.bag_size > record.bag_capacity
+            || record.direction > static_cast<uint8_t>(model::Direction::SOUTH)) {
+            throw SnapshotError("Invalid dog record");
+        }
+    }
+}
+
+DogView SessionView::GetDog(size_t index) const noexcept {
+    const auto record = ReadRecord<fmt::DogRecord>(dogs_, index);
+    return {record, names_.substr(record.name_offset, record.name_size),
+            bag_items_.substr(record.bag_offset * sizeof(fmt::BagItemRecord),
+                              record.bag_size * sizeof(fmt::BagItemRecord))};
+}
+
+model::LostObject SessionView::GetLostObject(size_t index) const noexcept {
+    const auto record = ReadRecord<fmt::LostObjectRecord>(lost_objects_, index);
+    return {model::LostObject::Id{record.id}, record.type, {record.x, record.y}};
+}
+
+SnapshotReader::SnapshotReader(const std::filesystem::path& path) {
+    try {
+        file_.open(path.string());
+    } catch (const std::exception& ex) {
+        throw SnapshotError("Failed to map "s + path.string() + ": "s + ex.what());
+    }
+
+    for (const auto& section : ReadSnapshotIndex({file_.data(), file_.size()})) {
+        if (section.type == static_cast<uint32_t>(fmt::SectionType::SESSION)) {
+            sessions_.push_back(section);
+        }
+    }
+}
+
+}  // namespace serialization
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "binary_snapshot.h"
+#include "snapshot_format.h"
+
+/*
+ * Доступ к содержимому снимка без восстановления модели.
+ *
+ * Представления ссылаются на байты секции и читают поля записей по требованию,
+ * не выделяя памяти под собак, их имена и рюкзаки. Они действительны, пока жив
+ * буфер, из которого созданы. Мелкие объекты (предметы рюкзака, потерянные
+ * предметы) возвращаются по значению.
+ */
+namespace serialization {
+
+class DogView {
+public:
+    // record должна быть проверена SessionView
+    DogView(const snapshot_format::DogRecord& record, std::string_view name, std::string_view bag) noexcept
+        : record_{record}
+        , name_{name}
+        , bag_{bag} {
+    }
+
+    model::Dog::Id GetId() const noexcept {
+        return model::Dog::Id{record_.id};
+    }
+
+    std::string_view GetName() const noexcept {
+        return name_;
+    }
+
+    geom::Point2D GetPosition() const noexcept {
+        return {record_.x, record_.y};
+    }
+
+    geom::Vec2D GetSpeed() const noexcept {
+        return {record_.speed_x, record_.speed_y};
+    }
+
+    model::Direction GetDirection() const noexcept {
+        return static_cast<model::Direction>(record_.direction);
+    }
+
+    model::Score GetScore() const noexcept {
+        return record_.score;
+    }
+
+    size_t GetBagCapacity() const noexcept {
+        return static_cast<size_t>(record_.bag_capacity);
+    }
+
+    size_t GetBagSize() const noexcept {
+        return record_.bag_size;
+    }
+
+    model::FoundObject GetBagItem(size_t index) const noexcept;
+
+    auto GetBagContent() const {
+        return std::views::iota(size_t{0}, GetBagSize())
+             | std::views::transform([dog = *this](size_t i) {
+                   return dog.GetBagItem(i);
+               });
+    }
+
+private:
+    snapshot_format::DogRecord record_;
+    std::string_view name_;
+    std::string_view bag_;
+};
+
+// Секция сеанса. Раскладка секции и все записи собак проверяются при создании,
+// поэтому дальнейшие обращения не выбрасывают исключений
+class SessionView {
+public:
+    // Выбрасывает SnapshotError, если содержимое секции некорректно
+    explicit SessionView(std::string_view payload);
+
+    model::GameSession::Id GetId() const noexcept {
+        return model::GameSession::Id{header_.id};
+    }
+
+    std::string_view GetMapId() const noexcept {
+        return map_id_;
+    }
+
+    size_t GetDogCount() const noexcept {
+        return header_.dog_count;
+    }
+
+    DogView GetDog(size_t index) const noexcept;
+
+    auto GetDogs() const {
+        return std::views::iota(size_t{0}, GetDogCount())
+             | std::views::transform([session = *this](size_t i) {
+                   return session.GetDog(i);
+               });
+    }
+
+    size_t GetLostObjectCount() const noexcept {
+        return header_.lost_object_count;
+    }
+
+    model::LostObject GetLostObject(size_t index) const noexcept;
+
+    auto GetLostObjects() const {
+        return std::views::iota(size_t{0}, GetLostObjectCount())
+             | std::views::transform([session = *this](size_t i) {
+                   return session.GetLostObject(i);
+               });
+    }
+
+private:
+    snapshot_format::SessionHeader header_;
+    std::string_view map_id_;
+    std::string_view dogs_;
+    std::string_view lost_objects_;
+    std::string_view bag_items_;
+    std::string_view names_;
+};
+
+/*
+ * Читает сеансы из файла снимка, отображённого в память. Несжатые секции
+ * просматриваются на месте, сжатые распаковываются по одной в общий буфер.
+ */
+class SnapshotReader {
+public:
+    // Выбрасывает SnapshotError, если файл не удалось открыть или снимок некорректен
+    explicit SnapshotReader(const std::filesystem::path& path);
+
+    size_t GetSessionCount() const noexcept {
+        return sessions_.size();
+    }
+
+    // Вызывает handler(const SessionView&) для каждого сеанса в порядке их записи.
+    // Представление действительно только во время вызова.
+    // Выбрасывает SnapshotError, если секция сеанса повреждена
+    template <typename Handler>
+    void ForEachSession(Handler&& handler) const {
+        std::string buffer;
+        for (const auto& section : sessions_) {
+            const SessionView session{section.Decode(buffer)};
+            handler(session);
+        }
+    }
+
+private:
+    boost::iostreams::mapped_file_source file_;
+    std::vector<SnapshotSection> sessions_;
+};
+
+}  // namespace serialization
@@ -0,0 +1,577 @@
+#include "write_ahead_log.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "binary_snapshot.h"
+#include "file_sync.h"
+#include "snapshot_restorer.h"
+
+namespace serialization {
+
+using namespace std::literals;
+
+namespace {
+
+enum class EventType : uint8_t {
+    JOIN = 1,
+    MOVE,
+    TICK,
+    RETIRE,
+};
+
+#pragma pack(push, 1)
+struct RecordHeader {
+    // CRC-32 всего, что следует за ним: размера, номера, типа и полей события.
+    // Размер тоже проверяется, иначе испорченный размер выглядел бы как обрыв
+    uint32_t checksum;
+    uint32_t size;
+    uint64_t sequence;
+    uint8_t type;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(RecordHeader) == 17);
+constexpr size_t CHECKED_OFFSET = offsetof(RecordHeader, size);
+
+template <typename... Fns>
+struct Overloaded : Fns... {
+    using Fns::operator()...;
+};
+
+template <typename T>
+void Append(std::string& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(std::string& out, std::string_view str) {
+    Append(out, static_cast<uint32_t>(str.size()));
+    out.append(str);
+}
+
+// Читает поля события, запоминая выход за границы записи
+class FieldReader {
+public:
+    explicit FieldReader(std::string_view data) noexcept
+        : data_{data} {
+    }
+
+    template <typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        if (!ok_ || data_.size() < sizeof(T)) {
+            ok_ = false;
+            return value;
+        }
+        std::memcpy(&value, data_.data(), sizeof(T));
+        data_.remove_prefix(sizeof(T));
+        return value;
+    }
+
+    std::string ReadString() {
+        const auto size = Read<uint32_t>();
+        if (!ok_ || data_.size() < size) {
+            ok_ = false;
+            return {};
+        }
+        std::string str{data_.substr(0, size)};
+        data_.remove_prefix(size);
+        return str;
+    }
+
+    bool IsValid() const noexcept {
+        return ok_ && data_.empty();
+    }
+
+private:
+    std::string_view data_;
+    bool ok_ = true;
+};
+
+EventType EncodeEvent(const LogEvent& event, std::string& out) {
+    return std::visit(
+        Overloaded{
+            [&out](const JoinEvent& join) {
+                Append(out, *join.session_id);
+                AppendString(out, *join.map_id);
+                Append(out, *join.dog_id);
+                AppendString(out, join.dog_name);
+                Append(out, join.position.x);
+                Append(out, join.position.y);
+                Append(out, static_cast<uint64_t>(join.bag_capacity));
+                AppendString(out, *join.token);
+                return EventType::JOIN;
+            },
+            [&out](const MoveEvent& move) {
+                Append(out, *move.session_id);
+                Append(out, *move.dog_id);
+                Append(out, static_cast<uint8_t>(move.direction));
+                Append(out, move.speed.x);
+                Append(out, move.speed.y);
+                return EventType::MOVE;
+            },
+            [&out](const TickEvent& tick) {
+                Append(out, static_cast<int64_t>(tick.delta.count()));
+                return EventType::TICK;
+            },
+            [&out](const RetireEvent& retire) {
+                Append(out, *retire.session_id);
+                Append(out, *retire.dog_id);
+                return EventType::RETIRE;
+            },
+        },
+        event);
+}
+
+std::optional<LogEvent> DecodeEvent(uint8_t type, std::string_view payload) {
+    FieldReader reader{payload};
+    LogEvent event;
+    switch (static_cast<EventType>(type)) {
+        case EventType::JOIN: {
+            JoinEvent join;
+            join.session_id = model::GameSession::Id{reader.Read<uint32_t>()};
+            join.map_id = model::MapId{reader.ReadString()};
+            join.dog_id = model::Dog::Id{reader.Read<uint32_t>()};
+            join.dog_name = reader.ReadString();
+            join.position.x = reader.Read<double>();
+            join.position.y = reader.Read<double>();
+            join.bag_capacity = static_cast<size_t>(reader.Read<uint64_t>());
+            join.token = model::Token{reader.ReadString()};
+            event = std::move(join);
+            break;
+        }
+        case EventType::MOVE: {
+            MoveEvent move;
+            move.session_id = model::GameSession::Id{reader.Read<uint32_t>()};
+            move.dog_id = model::Dog::Id{reader.Read<uint32_t>()};
+            const auto direction = reader.Read<uint8_t>();
+            if (direction > static_cast<uint8_t>(model::Direction::SOUTH)) {
+                return std::nullopt;
+            }
+            move.direction = static_cast<model::Direction>(direction);
+            move.speed.x = reader.Read<double>();
+            move.speed.y = reader.Read<double>();
+            event = move;
+            break;
+        }
+        case EventType::TICK:
+            event = TickEvent{std::chrono::milliseconds{reader.Read<int64_t>()}};
+            break;
+        case EventType::RETIRE: {
+            RetireEvent retire;
+            retire.session_id = model::GameSession::Id{reader.Read<uint32_t>()};
+            retire.dog_id = model::Dog::Id{reader.Read<uint32_t>()};
+            event = retire;
+            break;
+        }
+        default:
+            return std::nullopt;
+    }
+    if (!reader.IsValid()) {
+        return std::nullopt;
+    }
+    return event;
+}
+
+struct ScanResult {
+    // Длина префикса журнала, состоящего из целых записей
+    size_t valid_size = 0;
+    uint64_t last_sequence = 0;
+};
+
+// Есть ли после offset целая запись с номером больше sequence. Запись,
+// выходящая за конец файла, считается оборванной, только если за ней
+// нет целых записей: иначе её размер испорчен
+bool HasRecordAfter(std::string_view data, size_t offset, uint64_t sequence) {
+    for (size_t position = offset + 1; data.size() - position >= sizeof(RecordHeader); ++position) {
+        RecordHeader header;
+        std::memcpy(&header, data.data() + position, sizeof(header));
+        if (header.size <= data.size() - position - sizeof(header) && header.sequence > sequence
+            && SectionChecksum(data.substr(position + CHECKED_OFFSET, sizeof(header) - CHECKED_OFFSET + header.size))
+                   == header.checksum) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Перебирает целые записи журнала до незавершённой записи в конце файла.
+// Выбрасывает std::runtime_error, если повреждена запись посреди журнала
+template <typename Handler>
+ScanResult ScanLog(std::string_view data, Handler&& handler) {
+    ScanResult result;
+    while (data.size() - result.valid_size >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        std::memcpy(&header, data.data() + result.valid_size, sizeof(header));
+        const size_t record_size = sizeof(header) + header.size;
+        if (header.size > data.size() - result.valid_size - sizeof(header)) {
+            if (HasRecordAfter(data, result.valid_size, result.last_sequence + 1)) {
+                throw std::runtime_error("Corrupted log record "s + std::to_string(result.last_sequence + 1));
+            }
+            break;
+        }
+        const auto checked = data.substr(result.valid_size + CHECKED_OFFSET, record_size - CHECKED_OFFSET);
+        if (SectionChecksum(checked) != header.checksum) {
+            if (result.valid_size + record_size != data.size()) {
+                throw std::runtime_error("Corrupted log record "s + std::to_string(result.last_sequence + 1));
+            }
+            break;
+        }
+        // Запись с верной контрольной суммой записана целиком, поэтому
+        // разрыв нумерации или неизвестное событие - порча, а не обрыв
+        if (result.last_sequence != 0 && header.sequence != result.last_sequence + 1) {
+            throw std::runtime_error("Log sequence gap after record "s + std::to_string(result.last_sequence));
+        }
+        const auto event = DecodeEvent(header.type, checked.substr(sizeof(header) - CHECKED_OFFSET));
+        if (!event) {
+            throw std::runtime_error("Malformed log record "s + std::to_string(header.sequence));
+        }
+        handler(header.sequence, *event, result.valid_size);
+        result.valid_size += record_size;
+        result.last_sequence = header.sequence;
+    }
+    return result;
+}
+
+std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream in{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+int OpenForAppend(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to open "s + path.string());
+    }
+    return fd;
+}
+
+void WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "Failed to write the log");
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+void Sync(int fd) {
+    if (::fdatasync(fd) != 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to sync the log");
+    }
+}
+
+}  // namespace
+
+WriteAheadLog::WriteAheadLog(std::filesystem::path path, uint64_t min_sequence, bool sync)
+    : path_{std::move(path)}
+    , sync_{sync} {
+    const std::string data = ReadFile(path_);
+    auto scan = ScanLog(data, [](uint64_t, const LogEvent&, size_t) {});
+    if (scan.last_sequence < min_sequence) {
+        // Все записи учтены в снимке, а новые записи не продолжили бы их нумерацию
+        scan.valid_size = 0;
+    }
+    last_sequence_ = durable_sequence_ = std::max(scan.last_sequence, min_sequence);
+
+    fd_ = OpenForAppend(path_);
+    if (scan.valid_size != data.size() && ::ftruncate(fd_, static_cast<off_t>(scan.valid_size)) != 0) {
+        const int error = errno;
+        ::close(fd_);
+        throw std::system_error(error, std::generic_category(), "Failed to truncate "s + path_.string());
+    }
+    file_size_ = scan.valid_size;
+    worker_ = std::jthread{[this](std::stop_token stop) {
+        Run(std::move(stop));
+    }};
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    // Run дописывает накопленные события перед остановкой
+    worker_.request_stop();
+    worker_.join();
+    ::close(fd_);
+}
+
+uint64_t WriteAheadLog::Append(const LogEvent& event) {
+    uint64_t sequence = 0;
+    {
+        std::lock_guard lock{mutex_};
+        if (failed_) {
+            throw std::runtime_error("Failed to write the log");
+        }
+        sequence = ++last_sequence_;
+        const size_t start = pending_.size();
+        pending_.resize(start + sizeof(RecordHeader));
+        const auto type = EncodeEvent(event, pending_);
+
+        RecordHeader header{0, static_cast<uint32_t>(pending_.size() - start - sizeof(RecordHeader)), sequence,
+                            static_cast<uint8_t>(type)};
+        std::memcpy(pending_.data() + start, &header, sizeof(header));
+        header.checksum = SectionChecksum(std::string_view{pending_}.substr(start + CHECKED_OFFSET));
+        std::memcpy(pending_.data() + start, &header, sizeof(header));
+    }
+    work_ready_.notify_one();
+    return sequence;
+}
+
+uint64_t WriteAheadLog::GetLastSequence() const {
+    std::lock_guard lock{mutex_};
+    return last_sequence_;
+}
+
+uint64_t WriteAheadLog::GetDurableSequence() const {
+    std::lock_guard lock{mutex_};
+    return durable_sequence_;
+}
+
+void WriteAheadLog::WaitDurable(uint64_t sequence) {
+    std::unique_lock lock{mutex_};
+    durable_.wait(lock, [this, sequence] {
+        return durable_sequence_ >= sequence || failed_;
+    });
+    if (durable_sequence_ < sequence) {
+        throw std::runtime_error("Failed to write the log");
+    }
+}
+
+void WriteAheadLog::Flush() {
+    WaitDurable(GetLastSequence());
+}
+
+void WriteAheadLog::DiscardUpTo(uint64_t sequence) {
+    {
+        std::lock_guard lock{mutex_};
+        discard_up_to_ = std::max(discard_up_to_.value_or(0), sequence);
+    }
+    work_ready_.notify_one();
+}
+
+void WriteAheadLog::Run(std::stop_token stop) {
+    std::string batch;
+    std::unique_lock lock{mutex_};
+    const auto has_work = [this] {
+        return !pending_.empty() || discard_up_to_.has_value();
+    };
+    while (work_ready_.wait(lock, stop, has_work) || has_work()) {
+        batch.clear();
+        batch.swap(pending_);
+        const uint64_t batch_sequence = last_sequence_;
+        const auto discard = std::exchange(discard_up_to_, std::nullopt);
+        if (failed_) {
+            // События, добавленные до обнаружения сбоя, не записываются:
+            // в файле они следовали бы за потерянной группой
+            continue;
+        }
+        lock.unlock();
+
+        bool written = true;
+        try {
+            if (!batch.empty()) {
+                WriteBatch(batch);
+            }
+        } catch (const std::exception&) {
+            written = false;
+        }
+        if (written && discard) {
+            try {
+                Compact(*discard);
+            } catch (const std::exception&) {
+                // Записи остались в файле, и он будет сжат при следующем вызове DiscardUpTo
+            }
+        }
+
+        lock.lock();
+        if (written) {
+            durable_sequence_ = batch_sequence;
+        } else {
+            failed_ = true;
+        }
+        durable_.notify_all();
+    }
+}
+
+void WriteAheadLog::WriteBatch(const std::string& batch) {
+    try {
+        WriteAll(fd_, batch);
+        if (sync_) {
+            Sync(fd_);
+        }
+    } catch (...) {
+        // Недописанная запись посреди файла скрыла бы от чтения все следующие
+        [[maybe_unused]] const int result = ::ftruncate(fd_, static_cast<off_t>(file_size_));
+        throw;
+    }
+    file_size_ += batch.size();
+}
+
+void WriteAheadLog::Compact(uint64_t sequence) {
+    const std::string data = ReadFile(path_);
+    // Запись с номером sequence остаётся, чтобы после перезапуска нумерация
+    // продолжилась с него, даже если более новых записей нет
+    size_t keep_from = data.size();
+    ScanLog(data, [&keep_from, sequence](uint64_t record_sequence, const LogEvent&, size_t offset) {
+        if (record_sequence >= sequence && offset < keep_from) {
+            keep_from = offset;
+        }
+    });
+    if (keep_from == 0) {
+        return;
+    }
+
+    const std::filesystem::path temp_path = path_.string() + ".tmp";
+    const int temp_fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (temp_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to open "s + temp_path.string());
+    }
+    try {
+        WriteAll(temp_fd, std::string_view{data}.substr(keep_from));
+        if (sync_) {
+            Sync(temp_fd);
+        }
+    } catch (...) {
+        ::close(temp_fd);
+        throw;
+    }
+    ::close(temp_fd);
+    std::filesystem::rename(temp_path, path_);
+
+    // Старый дескриптор указывает на удалённый файл. Если новый открыть
+    // не удастся, следующая запись завершится ошибкой, а не пропадёт
+    ::close(fd_);
+    fd_ = -1;
+    fd_ = OpenForAppend(path_);
+    file_size_ = data.size() - keep_from;
+    if (sync_) {
+        SyncParentDirectory(path_);
+    }
+}
+
+uint64_t ReadLog(const std::filesystem::path& path,
+                 const std::function<void(uint64_t sequence, const LogEvent& event)>& handler) {
+    const std::string data = ReadFile(path);
+    return ScanLog(data, [&handler](uint64_t sequence, const LogEvent& event, size_t) {
+               handler(sequence, event);
+           }).last_sequence;
+}
+
+EventApplier::EventApplier(std::vector<model::GameSession>& sessions, std::vector<model::Player>& players)
+    : sessions_{sessions}
+    , players_{players} {
+    for (size_t i = 0; i < sessions_.size(); ++i) {
+        session_index_.emplace(*sessions_[i].GetId(), i);
+        IndexDogs(i, 0);
+    }
+}
+
+void EventApplier::IndexDogs(size_t session_index, size_t first_dog) {
+    const auto& session = sessions_[session_index];
+    const auto& dogs = session.GetDogs();
+    for (size_t i = first_dog; i < dogs.size(); ++i) {
+        dog_index_.insert_or_assign(DogKey(*session.GetId(), *dogs[i].GetId()), i);
+    }
+}
+
+model::Dog* EventApplier::FindDog(model::GameSession::Id session_id, model::Dog::Id dog_id) {
+    const auto session_it = session_index_.find(*session_id);
+    const auto dog_it = dog_index_.find(DogKey(*session_id, *dog_id));
+    if (session_it == session_index_.end() || dog_it == dog_index_.end()) {
+        return nullptr;
+    }
+    return &sessions_[session_it->second].GetDogs()[dog_it->second];
+}
+
+bool EventApplier::Apply(const LogEvent& event) {
+    return std::visit(
+        Overloaded{
+            [this](const JoinEvent& join) {
+                auto [session_it, inserted] = session_index_.try_emplace(*join.session_id, sessions_.size());
+                if (inserted) {
+                    sessions_.emplace_back(join.session_id, join.map_id);
+                }
+                auto& session = sessions_[session_it->second];
+                if (dog_index_.contains(DogKey(*join.session_id, *join.dog_id))) {
+                    return false;
+                }
+                session.EmplaceDog(join.dog_id, join.dog_name, join.position, join.bag_capacity);
+                IndexDogs(session_it->second, session.GetDogs().size() - 1);
+                if (!(*join.token).empty()) {
+                    players_.push_back({join.token, join.session_id, join.dog_id});
+                }
+                return true;
+            },
+            [this](const MoveEvent& move) {
+                model::Dog* dog = FindDog(move.session_id, move.dog_id);
+                if (!dog) {
+                    return false;
+                }
+                dog->SetDirection(move.direction);
+                dog->SetSpeed(move.speed);
+                return true;
+            },
+            [this](const TickEvent& tick) {
+                for (auto& session : sessions_) {
+                    session.Tick(tick.delta);
+                }
+                return true;
+            },
+            [this](const RetireEvent& retire) {
+                const auto session_it = session_index_.find(*retire.session_id);
+                const auto dog_it = dog_index_.find(DogKey(*retire.session_id, *retire.dog_id));
+                if (session_it == session_index_.end() || dog_it == dog_index_.end()) {
+                    return false;
+                }
+                const size_t position = dog_it->second;
+                dog_index_.erase(dog_it);
+                sessions_[session_it->second].RemoveDog(retire.dog_id);
+                // Собаки после удалённой сдвинулись на одну позицию
+                IndexDogs(session_it->second, position);
+                std::erase_if(players_, [&retire](const model::Player& player) {
+                    return player.session_id == retire.session_id && player.dog_id == retire.dog_id;
+                });
+                return true;
+            },
+        },
+        event);
+}
+
+RecoveredState RecoverState(const std::filesystem::path& snapshot_path,
+                            const std::filesystem::path& log_path) {
+    RecoveredState state;
+    if (std::filesystem::exists(snapshot_path)) {
+        const SnapshotRestorer restorer{snapshot_path};
+        state.sessions = restorer.RestoreSessions();
+        state.players = restorer.GetPlayers();
+        state.log_sequence = restorer.GetLogSequence();
+    }
+
+    EventApplier applier{state.sessions, state.players};
+    ReadLog(log_path, [&state, &applier](uint64_t sequence, const LogEvent& event) {
+        // Записи, учтённые в снимке, пропускаются
+        if (sequence <= state.log_sequence) {
+            return;
+        }
+        applier.Apply(event);
+        state.log_sequence = sequence;
+        ++state.replayed_events;
+    });
+    return state;
+}
+
+}  // namespace serialization
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "model.h"
+
+/*
+ * Журнал действий, изменяющих состояние игры, между снимками состояния.
+ *
+ * Каждая запись получает номер, возрастающий на единицу. Запись состоит из
+ * заголовка (CRC-32, размер, номер, тип) и полей события в порядке байтов
+ * little-endian. Обрезанная или повреждённая запись в конце файла считается
+ * незавершённой и отбрасывается: так выглядит журнал после падения сервера
+ * посреди записи. Повреждённая запись, за которой в файле есть данные,
+ * означает порчу журнала: её отбрасывание потеряло бы и все следующие записи.
+ */
+namespace serialization {
+
+// Игрок присоединился к сеансу. Сеанс создаётся, если его ещё нет
+struct JoinEvent {
+    model::GameSession::Id session_id{0u};
+    model::MapId map_id{std::string{}};
+    model::Dog::Id dog_id{0u};
+    std::string dog_name;
+    geom::Point2D position;
+    size_t bag_capacity = 0;
+    model::Token token{std::string{}};
+};
+
+struct MoveEvent {
+    model::GameSession::Id session_id{0u};
+    model::Dog::Id dog_id{0u};
+    model::Direction direction = model::Direction::NORTH;
+    geom::Vec2D speed;
+};
+
+// Такт всех сеансов
+struct TickEvent {
+    std::chrono::milliseconds delta{0};
+};
+
+// Игрок покинул игру, его собака удаляется из сеанса, а токен - из таблицы игроков
+struct RetireEvent {
+    model::GameSession::Id session_id{0u};
+    model::Dog::Id dog_id{0u};
+};
+
+using LogEvent = std::variant<JoinEvent, MoveEvent, TickEvent, RetireEvent>;
+
+/*
+ * Дописывает события в журнал из отдельного потока.
+ *
+ * Append только кодирует событие в буфер в памяти. Поток записи забирает
+ * накопившиеся события целиком, записывает их одним вызовом write
+ * и один раз вызывает fdatasync (групповая фиксация): чем чаще приходят
+ * события, тем больше их фиксируется за одну синхронизацию с диском.
+ *
+ * Если записать группу не удалось, её недописанная часть отрезается от файла,
+ * а журнал перестаёт принимать события: иначе следующие группы оказались бы
+ * в файле после пропущенных записей и не прочитались бы при восстановлении.
+ */
+class WriteAheadLog {
+public:
+    // Открывает журнал, продолжая нумерацию записей в нём, но не меньше чем
+    // с min_sequence + 1, например, с номера, учтённого в восстановленном снимке.
+    // Отбрасывает незавершённую запись в конце файла и записи, целиком учтённые
+    // в снимке с номером min_sequence, если нумерация не продолжает их.
+    // Выбрасывает std::runtime_error, если журнал повреждён.
+    // Без sync записи не синхронизируются с диском, что полезно в тестах
+    explicit WriteAheadLog(std::filesystem::path path, uint64_t min_sequence = 0, bool sync = true);
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Записывает все добавленные события
+    ~WriteAheadLog();
+
+    // Возвращает номер записи события. Не ждёт ввода-вывода.
+    // Выбрасывает std::runtime_error, если запись в журнал перестала удаваться
+    uint64_t Append(const LogEvent& event);
+
+    // Номер последней добавленной записи
+    uint64_t GetLastSequence() const;
+
+    // Номер последней записи, сохранённой на диске
+    uint64_t GetDurableSequence() const;
+
+    // Дожидается сохранения на диске записи с номером sequence.
+    // Выбрасывает std::runtime_error, если запись не удалось сохранить
+    void WaitDurable(uint64_t sequence);
+
+    // Дожидается сохранения всех добавленных записей
+    void Flush();
+
+    // Удаляет из файла записи с номерами меньше sequence, например, после
+    // записи снимка, в котором они учтены. Запись sequence остаётся, чтобы
+    // сохранить нумерацию. Выполняется потоком записи
+    void DiscardUpTo(uint64_t sequence);
+
+private:
+    void Run(std::stop_token stop);
+    void WriteBatch(const std::string& batch);
+    void Compact(uint64_t sequence);
+
+    std::filesystem::path path_;
+    bool sync_;
+    int fd_ = -1;
+    // Размер файла, состоящего из целых записей. Изменяется только потоком записи
+    uint64_t file_size_ = 0;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any work_ready_;
+    std::condition_variable durable_;
+    std::string pending_;
+    uint64_t last_sequence_ = 0;
+    uint64_t durable_sequence_ = 0;
+    std::optional<uint64_t> discard_up_to_;
+    // Группу записей не удалось сохранить. Журнал больше не принимает события,
+    // а durable_sequence_ не продвигается дальше последней сохранённой группы
+    bool failed_ = false;
+
+    std::jthread worker_;
+};
+
+// Вызывает handler для каждой целой записи журнала по порядку номеров.
+// Возвращает номер последней целой записи или 0, если их нет.
+// Отсутствующий файл считается пустым журналом.
+// Выбрасывает std::runtime_error, если журнал повреждён
+uint64_t ReadLog(const std::filesystem::path& path,
+                 const std::function<void(uint64_t sequence, const LogEvent& event)>& handler);
+
+// Применяет события журнала к сеансам игры и таблице игроков,
+// поддерживая индекс сеансов и собак
+class EventApplier {
+public:
+    EventApplier(std::vector<model::GameSession>& sessions, std::vector<model::Player>& players);
+
+    // Возвращает false, если событие ссылается на отсутствующие сеанс или собаку
+    bool Apply(const LogEvent& event);
+
+private:
+    static uint64_t DogKey(uint32_t session_id, uint32_t dog_id) noexcept {
+        return (uint64_t{session_id} << 32) | dog_id;
+    }
+
+    void IndexDogs(size_t session_index, size_t first_dog);
+    model::Dog* FindDog(model::GameSession::Id session_id, model::Dog::Id dog_id);
+
+    std::vector<model::GameSession>& sessions_;
+    std::vector<model::Player>& players_;
+    std::unordered_map<uint32_t, size_t> session_index_;
+    std::unordered_map<uint64_t, size_t> dog_index_;
+};
+
+struct RecoveredState {
+    std::vector<model::GameSession> sessions;
+    std::vector<model::Player> players;
+    // Номер последней применённой записи журнала
+    uint64_t log_sequence = 0;
+    // Сколько записей журнала применено поверх снимка
+    uint64_t replayed_events = 0;
+};
+
+// Загружает последний снимок (если он есть), восстанавливая сеансы параллельно,
+// и применяет записи журнала, сделанные после него.
+// Выбрасывает SnapshotError, если снимок повреждён, и std::runtime_error,
+// если повреждён журнал
+RecoveredState RecoverState(const std::filesystem::path& snapshot_path,
+                            const std::filesystem::path& log_path);
+
+}  // namespace serialization
@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+
+#include "../src/background_snapshotter.h"
+#include "../src/binary_snapshot.h"
+
+using namespace model;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<GameSession> MakeSessions(size_t dog_count) {
+    std::vector<GameSession> sessions;
+    auto& session = sessions.emplace_back(GameSession::Id{0u}, MapId{"town"s});
+    for (size_t i = 0; i < dog_count; ++i) {
+        session.AddDog(Dog{Dog::Id{static_cast<uint32_t>(i)}, "Dog "s + std::to_string(i),
+                           {static_cast<double>(i), 0}, 3});
+    }
+    return sessions;
+}
+
+std::vector<GameSession> LoadFile(const fs::path& path) {
+    std::ifstream in{path, std::ios::binary};
+    return serialization::LoadSnapshot(in);
+}
+
+}  // namespace
+
+SCENARIO("Background snapshotting") {
+    const fs::path dir = fs::temp_directory_path() / "background-snapshotter-tests";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const fs::path state_file = dir / "state.bin";
+
+    GIVEN("a snapshotter") {
+        serialization::BackgroundSnapshotter snapshotter{state_file};
+
+        WHEN("the game state is captured") {
+            auto sessions = MakeSessions(10);
+            snapshotter.Capture(sessions);
+            // Изменения после снятия образа не попадают в снимок
+            sessions.front().GetDogs().front().AddScore(100);
+            snapshotter.Flush();
+
+            THEN("the captured state is written to the state file") {
+                const auto restored = LoadFile(state_file);
+                REQUIRE(restored.size() == 1);
+                REQUIRE(restored.front().GetDogs().size() == 10);
+                CHECK(restored.front().GetDogs().front().GetScore() == 0);
+                CHECK_FALSE(fs::exists(dir / "state.bin.tmp"));
+            }
+
+            THEN("the capture time is reported") {
+                const auto stats = snapshotter.GetStats();
+                CHECK(stats.captures == 1);
+                CHECK(stats.saves == 1);
+                CHECK(stats.failures == 0);
+                CHECK(stats.last_capture_time.count() > 0);
+                CHECK(stats.max_capture_time >= stats.last_capture_time);
+            }
+        }
+
+        WHEN("the state is captured many times in a row") {
+            for (size_t i = 1; i <= 20; ++i) {
+                snapshotter.Capture(MakeSessions(i * 100));
+            }
+            snapshotter.Flush();
+
+            THEN("the file contains the latest state") {
+                CHECK(LoadFile(state_file).front().GetDogs().size() == 2000);
+                const auto stats = snapshotter.GetStats();
+                CHECK(stats.captures == 20);
+                CHECK(stats.saves + stats.dropped == 20);
+            }
+        }
+    }
+
+    GIVEN("a snapshotter whose state file cannot be written") {
+        serialization::BackgroundSnapshotter snapshotter{dir / "missing" / "state.bin"};
+        snapshotter.Capture(MakeSessions(1));
+        snapshotter.Flush();
+
+        THEN("the failure is counted") {
+            CHECK(snapshotter.GetStats().failures == 1);
+        }
+    }
+
+    fs::remove_all(dir);
+}
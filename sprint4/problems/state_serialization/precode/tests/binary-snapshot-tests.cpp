@@ -0,0 +1,173 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <sstream>
+
+#include "../src/binary_snapshot.h"
+
+using namespace model;
+using namespace std::literals;
+
+namespace {
+
+std::vector<GameSession> MakeSessions() {
+    std::vector<GameSession> sessions;
+
+    auto& town = sessions.emplace_back(GameSession::Id{0u}, MapId{"town"s});
+    {
+        Dog dog{Dog::Id{42u}, "Pluto"s, {42.2, 12.5}, 3};
+        dog.AddScore(42);
+        CHECK(dog.PutToBag({FoundObject::Id{10u}, 2u}));
+        CHECK(dog.PutToBag({FoundObject::Id{11u}, 0u}));
+        dog.SetDirection(Direction::EAST);
+        dog.SetSpeed({2.3, -1.2});
+        town.AddDog(std::move(dog));
+    }
+    town.AddDog(Dog{Dog::Id{43u}, "Шарик"s, {0, 0.1}, 0});
+    town.AddLostObject({LostObject::Id{7u}, 1u, {3.5, 4}});
+
+    sessions.emplace_back(GameSession::Id{1u}, MapId{"empty"s});
+    return sessions;
+}
+
+void CheckEqual(const Dog& expected, const Dog& actual) {
+    CHECK(expected.GetId() == actual.GetId());
+    CHECK(expected.GetName() == actual.GetName());
+    CHECK(expected.GetPosition() == actual.GetPosition());
+    CHECK(expected.GetSpeed() == actual.GetSpeed());
+    CHECK(expected.GetDirection() == actual.GetDirection());
+    CHECK(expected.GetScore() == actual.GetScore());
+    CHECK(expected.GetBagCapacity() == actual.GetBagCapacity());
+    CHECK(expected.GetBagContent() == actual.GetBagContent());
+}
+
+void CheckEqual(const std::vector<GameSession>& expected, const std::vector<GameSession>& actual) {
+    REQUIRE(expected.size() == actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        CHECK(expected[i].GetId() == actual[i].GetId());
+        CHECK(expected[i].GetMapId() == actual[i].GetMapId());
+        CHECK(expected[i].GetLostObjects() == actual[i].GetLostObjects());
+        REQUIRE(expected[i].GetDogs().size() == actual[i].GetDogs().size());
+        for (size_t j = 0; j < expected[i].GetDogs().size(); ++j) {
+            CheckEqual(expected[i].GetDogs()[j], actual[i].GetDogs()[j]);
+        }
+    }
+}
+
+}  // namespace
+
+SCENARIO("Binary snapshot") {
+    GIVEN("game sessions") {
+        const auto sessions = MakeSessions();
+
+        WHEN("they are saved to a snapshot") {
+            std::stringstream strm;
+            serialization::SaveSnapshot(strm, sessions);
+            const std::string data = strm.str();
+
+            THEN("they can be loaded back") {
+                CheckEqual(sessions, serialization::LoadSnapshot(strm));
+            }
+
+            AND_WHEN("a byte of the index is corrupted") {
+                auto corrupted = data;
+                corrupted[corrupted.size() - sizeof(serialization::snapshot_format::FileTrailer) - 6] ^= 1;
+                THEN("loading fails") {
+                    CHECK_THROWS_AS(serialization::LoadSnapshot(corrupted), serialization::SnapshotError);
+                }
+            }
+
+            AND_WHEN("a byte of the snapshot is corrupted") {
+                auto corrupted = data;
+                corrupted[corrupted.size() / 2] ^= 1;
+                THEN("loading fails") {
+                    CHECK_THROWS_AS(serialization::LoadSnapshot(corrupted), serialization::SnapshotError);
+                }
+            }
+
+            AND_WHEN("the snapshot is truncated") {
+                THEN("loading fails") {
+                    CHECK_THROWS_AS(serialization::LoadSnapshot(std::string_view{data}.substr(0, data.size() - 1)),
+                                    serialization::SnapshotError);
+                }
+            }
+
+            AND_WHEN("the snapshot has another version") {
+                auto other = data;
+                other[8] = 99;
+                THEN("loading fails") {
+                    CHECK_THROWS_AS(serialization::LoadSnapshot(other), serialization::SnapshotError);
+                }
+            }
+        }
+    }
+
+    GIVEN("game sessions, players and a log position") {
+        const auto sessions = MakeSessions();
+        const std::vector<Player> players{{Token{"token"s}, GameSession::Id{0u}, Dog::Id{43u}}};
+        std::stringstream strm;
+        serialization::SaveSnapshot(strm, sessions, players, 17);
+
+        THEN("all of them are restored") {
+            const auto content = serialization::ReadSnapshot(strm.str());
+            CheckEqual(sessions, content.sessions);
+            CHECK(content.players == players);
+            CHECK(content.log_sequence == 17);
+        }
+    }
+
+    GIVEN("game sessions with many similar dogs") {
+        auto sessions = MakeSessions();
+        for (uint32_t i = 0; i < 1000; ++i) {
+            sessions.back().AddDog(Dog{Dog::Id{i}, "Rex "s + std::to_string(i), {1.0 * (i % 10), 2}, 3});
+        }
+        const std::vector<Player> players{{Token{"token"s}, GameSession::Id{1u}, Dog::Id{7u}}};
+        std::stringstream plain;
+        serialization::SaveSnapshot(plain, sessions, players, 5);
+
+        WHEN("they are saved to a compressed snapshot") {
+            std::stringstream strm;
+            serialization::SaveSnapshot(strm, sessions, players, 5,
+                                        {.codec = serialization::snapshot_format::Codec::ZLIB, .level = 9});
+            const std::string data = strm.str();
+
+            THEN("the snapshot is smaller and records the codec and the uncompressed size") {
+                CHECK(data.size() < plain.str().size() / 2);
+                serialization::snapshot_format::FileHeader header;
+                std::memcpy(&header, data.data(), sizeof(header));
+                CHECK(header.codec == static_cast<uint32_t>(serialization::snapshot_format::Codec::ZLIB));
+
+                // Несжатый снимок того же состояния содержит столько же данных
+                const auto read_trailer = [](const std::string& snapshot) {
+                    serialization::snapshot_format::FileTrailer trailer;
+                    std::memcpy(&trailer, snapshot.data() + snapshot.size() - sizeof(trailer), sizeof(trailer));
+                    return trailer;
+                };
+                CHECK(read_trailer(data).uncompressed_size == read_trailer(plain.str()).uncompressed_size);
+                CHECK(read_trailer(plain.str()).uncompressed_size > plain.str().size() / 2);
+            }
+
+            THEN("everything can be loaded back") {
+                const auto content = serialization::ReadSnapshot(data);
+                CheckEqual(sessions, content.sessions);
+                CHECK(content.players == players);
+                CHECK(content.log_sequence == 5);
+            }
+
+            AND_WHEN("a byte of a compressed section is corrupted") {
+                auto corrupted = data;
+                const auto section = serialization::ReadSnapshotIndex(data).back();
+                corrupted[section.payload.data() - data.data() + section.payload.size() / 2] ^= 1;
+                THEN("loading fails") {
+                    CHECK_THROWS_AS(serialization::LoadSnapshot(corrupted), serialization::SnapshotError);
+                }
+            }
+        }
+    }
+
+    GIVEN("data that is not a snapshot") {
+        THEN("loading fails") {
+            CHECK_THROWS_AS(serialization::LoadSnapshot("22 serialization::archive"sv),
+                            serialization::SnapshotError);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "../src/snapshot_restorer.h"
+
+using namespace model;
+using namespace serialization;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<GameSession> MakeSessions() {
+    std::vector<GameSession> sessions;
+    for (uint32_t i = 0; i < 20; ++i) {
+        auto& session = sessions.emplace_back(GameSession::Id{i}, MapId{"map"s + std::to_string(i % 3)});
+        // Размеры сеансов различаются, чтобы порядок разбора отличался от порядка в файле
+        for (uint32_t j = 0; j < (i * 37) % 100; ++j) {
+            auto& dog = session.EmplaceDog(Dog::Id{j}, "Dog "s + std::to_string(j),
+                                           geom::Point2D{i * 1.5, j * 0.5}, 2);
+            dog.AddScore(i + j);
+        }
+        session.AddLostObject({LostObject::Id{i}, i % 4, {1.0 * i, 2.0}});
+    }
+    return sessions;
+}
+
+std::string Save(const std::vector<GameSession>& sessions, const std::vector<Player>& players,
+                 const SnapshotOptions& options = {}) {
+    std::ostringstream out;
+    SaveSnapshot(out, sessions, players, 42, options);
+    return out.str();
+}
+
+void WriteFile(const fs::path& path, const std::string& data) {
+    std::ofstream out{path, std::ios::binary};
+    out << data;
+}
+
+}  // namespace
+
+SCENARIO("Parallel snapshot restore") {
+    const fs::path dir = fs::temp_directory_path() / "snapshot-restorer-tests";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const fs::path path = dir / "state.bin";
+
+    const auto sessions = MakeSessions();
+    const std::vector<Player> players{
+        {Token{"0123456789abcdef"s}, GameSession::Id{3u}, Dog::Id{1u}},
+        {Token{"fedcba9876543210"s}, GameSession::Id{7u}, Dog::Id{0u}},
+    };
+    const std::string data = Save(sessions, players);
+
+    GIVEN("a snapshot file") {
+        WriteFile(path, data);
+        const SnapshotRestorer restorer{path};
+
+        THEN("players and the log position are available before sessions are restored") {
+            CHECK(restorer.GetPlayers() == players);
+            CHECK(restorer.GetLogSequence() == 42);
+            CHECK(restorer.GetSessionCount() == sessions.size());
+        }
+
+        THEN("sessions restored in parallel match a sequential load") {
+            const auto expected = ReadSnapshot(data).sessions;
+            for (unsigned threads : {1u, 4u, 64u}) {
+                const auto restored = restorer.RestoreSessions(threads);
+                REQUIRE(restored.size() == expected.size());
+                for (size_t i = 0; i < restored.size(); ++i) {
+                    CHECK(restored[i].GetId() == expected[i].GetId());
+                    CHECK(restored[i].GetMapId() == expected[i].GetMapId());
+                    CHECK(restored[i].GetLostObjects() == expected[i].GetLostObjects());
+                    REQUIRE(restored[i].GetDogs().size() == expected[i].GetDogs().size());
+                    for (size_t j = 0; j < restored[i].GetDogs().size(); ++j) {
+                        CHECK(restored[i].GetDogs()[j].GetName() == expected[i].GetDogs()[j].GetName());
+                        CHECK(restored[i].GetDogs()[j].GetScore() == expected[i].GetDogs()[j].GetScore());
+                    }
+                }
+            }
+        }
+    }
+
+    GIVEN("a compressed snapshot file") {
+        WriteFile(path, Save(sessions, players, {.codec = snapshot_format::Codec::ZLIB, .level = 1}));
+        const SnapshotRestorer restorer{path};
+
+        THEN("sessions are decompressed and restored in parallel") {
+            CHECK(restorer.GetPlayers() == players);
+            CHECK(restorer.GetLogSequence() == 42);
+            const auto expected = ReadSnapshot(data).sessions;
+            const auto restored = restorer.RestoreSessions(4);
+            REQUIRE(restored.size() == expected.size());
+            for (size_t i = 0; i < restored.size(); ++i) {
+                CHECK(restored[i].GetId() == expected[i].GetId());
+                REQUIRE(restored[i].GetDogs().size() == expected[i].GetDogs().size());
+                for (size_t j = 0; j < restored[i].GetDogs().size(); ++j) {
+                    CHECK(restored[i].GetDogs()[j].GetName() == expected[i].GetDogs()[j].GetName());
+                    CHECK(restored[i].GetDogs()[j].GetPosition() == expected[i].GetDogs()[j].GetPosition());
+                }
+            }
+        }
+    }
+
+    GIVEN("a snapshot with a corrupted session") {
+        auto corrupted = data;
+        const auto sections = ReadSnapshotIndex(data);
+        const auto& last_session = sections.back();
+        corrupted[last_session.payload.data() - data.data() + last_session.payload.size() / 2] ^= 1;
+        WriteFile(path, corrupted);
+        const SnapshotRestorer restorer{path};
+
+        THEN("the players are still read, but restoring sessions fails") {
+            CHECK(restorer.GetPlayers() == players);
+            CHECK_THROWS_AS(restorer.RestoreSessions(4), SnapshotError);
+        }
+    }
+
+    GIVEN("a missing file") {
+        THEN("the restorer cannot be created") {
+            CHECK_THROWS_AS(SnapshotRestorer{dir / "missing.bin"}, SnapshotError);
+        }
+    }
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,108 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "../src/snapshot_view.h"
+
+using namespace model;
+using namespace serialization;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<GameSession> MakeSessions() {
+    std::vector<GameSession> sessions;
+    for (uint32_t i = 0; i < 5; ++i) {
+        auto& session = sessions.emplace_back(GameSession::Id{i}, MapId{"map"s + std::to_string(i % 2)});
+        for (uint32_t j = 0; j < i * 10; ++j) {
+            auto& dog = session.EmplaceDog(Dog::Id{j}, "Dog "s + std::to_string(j), geom::Point2D{i * 1.5, j * 0.5},
+                                           3);
+            dog.SetSpeed({0.5 * j, -1.0});
+            dog.SetDirection(static_cast<Direction>(j % 4));
+            dog.AddScore(i + j);
+            for (uint32_t k = 0; k < j % 4; ++k) {
+                CHECK(dog.PutToBag({FoundObject::Id{j * 4 + k}, k}));
+            }
+        }
+        session.AddLostObject({LostObject::Id{i}, i % 4, {1.0 * i, 2.0}});
+    }
+    return sessions;
+}
+
+void CheckEqual(const GameSession& expected, const SessionView& actual) {
+    CHECK(expected.GetId() == actual.GetId());
+    CHECK(*expected.GetMapId() == actual.GetMapId());
+    REQUIRE(expected.GetDogs().size() == actual.GetDogCount());
+    size_t i = 0;
+    for (const auto& dog : actual.GetDogs()) {
+        const Dog& expected_dog = expected.GetDogs()[i++];
+        CHECK(dog.GetId() == expected_dog.GetId());
+        CHECK(dog.GetName() == expected_dog.GetName());
+        CHECK(dog.GetPosition() == expected_dog.GetPosition());
+        CHECK(dog.GetSpeed() == expected_dog.GetSpeed());
+        CHECK(dog.GetDirection() == expected_dog.GetDirection());
+        CHECK(dog.GetScore() == expected_dog.GetScore());
+        CHECK(dog.GetBagCapacity() == expected_dog.GetBagCapacity());
+        REQUIRE(dog.GetBagSize() == expected_dog.GetBagContent().size());
+        size_t j = 0;
+        for (const auto& item : dog.GetBagContent()) {
+            CHECK(item == expected_dog.GetBagContent()[j++]);
+        }
+    }
+    REQUIRE(expected.GetLostObjects().size() == actual.GetLostObjectCount());
+    CHECK(actual.GetLostObject(0) == expected.GetLostObjects()[0]);
+}
+
+}  // namespace
+
+SCENARIO("Snapshot views") {
+    const auto sessions = MakeSessions();
+
+    GIVEN("an encoded session") {
+        std::string payload;
+        EncodeSession(sessions.back(), payload);
+
+        THEN("the view reads the session in place") {
+            CheckEqual(sessions.back(), SessionView{payload});
+        }
+
+        AND_WHEN("a dog record points outside the names") {
+            snapshot_format::DogRecord record;
+            const size_t offset = sizeof(snapshot_format::SessionHeader) + (*sessions.back().GetMapId()).size();
+            std::memcpy(&record, payload.data() + offset, sizeof(record));
+            record.name_size = 1'000;
+            std::memcpy(payload.data() + offset, &record, sizeof(record));
+            THEN("the view cannot be created") {
+                CHECK_THROWS_AS(SessionView{payload}, SnapshotError);
+            }
+        }
+
+        AND_WHEN("the session is truncated") {
+            THEN("the view cannot be created") {
+                CHECK_THROWS_AS(SessionView{std::string_view{payload}.substr(0, payload.size() - 1)}, SnapshotError);
+            }
+        }
+    }
+
+    GIVEN("snapshot files with and without compression") {
+        const fs::path path = fs::temp_directory_path() / "snapshot-view-tests.bin";
+        for (const auto codec : {snapshot_format::Codec::NONE, snapshot_format::Codec::ZLIB}) {
+            {
+                std::ofstream out{path, std::ios::binary};
+                SaveSnapshot(out, sessions, {}, 0, {.codec = codec});
+            }
+            const SnapshotReader reader{path};
+            CHECK(reader.GetSessionCount() == sessions.size());
+
+            size_t i = 0;
+            reader.ForEachSession([&](const SessionView& session) {
+                CheckEqual(sessions[i++], session);
+            });
+            CHECK(i == sessions.size());
+        }
+        fs::remove(path);
+    }
+}
@@ -0,0 +1,268 @@
+#include <sys/resource.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+
+#include "../src/binary_snapshot.h"
+#include "../src/write_ahead_log.h"
+
+using namespace model;
+using namespace serialization;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<LogEvent> MakeEvents() {
+    return {
+        JoinEvent{GameSession::Id{0u}, MapId{"town"s}, Dog::Id{0u}, "Pluto"s, {1, 2}, 3, Token{"t0"s}},
+        JoinEvent{GameSession::Id{0u}, MapId{"town"s}, Dog::Id{1u}, "Шарик"s, {5, 2}, 3, Token{"t1"s}},
+        MoveEvent{GameSession::Id{0u}, Dog::Id{0u}, Direction::EAST, {2.5, 0}},
+        TickEvent{100ms},
+        JoinEvent{GameSession::Id{1u}, MapId{"forest"s}, Dog::Id{0u}, "Rex"s, {0, 0}, 1, Token{"t2"s}},
+        MoveEvent{GameSession::Id{1u}, Dog::Id{0u}, Direction::SOUTH, {0, 1}},
+        TickEvent{250ms},
+        RetireEvent{GameSession::Id{0u}, Dog::Id{0u}},
+        MoveEvent{GameSession::Id{0u}, Dog::Id{1u}, Direction::WEST, {-1, 0}},
+        TickEvent{50ms},
+    };
+}
+
+void CheckEqual(const std::vector<GameSession>& expected, const std::vector<GameSession>& actual) {
+    REQUIRE(expected.size() == actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        CHECK(expected[i].GetId() == actual[i].GetId());
+        CHECK(expected[i].GetMapId() == actual[i].GetMapId());
+        REQUIRE(expected[i].GetDogs().size() == actual[i].GetDogs().size());
+        for (size_t j = 0; j < expected[i].GetDogs().size(); ++j) {
+            const auto& e = expected[i].GetDogs()[j];
+            const auto& a = actual[i].GetDogs()[j];
+            CHECK(e.GetId() == a.GetId());
+            CHECK(e.GetName() == a.GetName());
+            CHECK(e.GetPosition() == a.GetPosition());
+            CHECK(e.GetSpeed() == a.GetSpeed());
+            CHECK(e.GetDirection() == a.GetDirection());
+        }
+    }
+}
+
+void SaveSnapshotFile(const fs::path& path, const std::vector<GameSession>& sessions,
+                      const std::vector<Player>& players, uint64_t sequence) {
+    std::ofstream out{path, std::ios::binary};
+    SaveSnapshot(out, sessions, players, sequence);
+}
+
+// Ограничивает размер файлов, в которые пишет процесс: запись за пределом
+// завершается ошибкой EFBIG, как при нехватке места на диске
+class FileSizeLimit {
+public:
+    explicit FileSizeLimit(uintmax_t max_size) {
+        ::getrlimit(RLIMIT_FSIZE, &saved_);
+        previous_handler_ = std::signal(SIGXFSZ, SIG_IGN);
+        rlimit limit = saved_;
+        limit.rlim_cur = static_cast<rlim_t>(max_size);
+        ::setrlimit(RLIMIT_FSIZE, &limit);
+    }
+
+    FileSizeLimit(const FileSizeLimit&) = delete;
+    FileSizeLimit& operator=(const FileSizeLimit&) = delete;
+
+    ~FileSizeLimit() {
+        ::setrlimit(RLIMIT_FSIZE, &saved_);
+        std::signal(SIGXFSZ, previous_handler_);
+    }
+
+private:
+    rlimit saved_{};
+    void (*previous_handler_)(int) = SIG_DFL;
+};
+
+// Собаку Pluto увёл игрок, остались t1 и t2
+const std::vector<Player> EXPECTED_PLAYERS = {
+    {Token{"t1"s}, GameSession::Id{0u}, Dog::Id{1u}},
+    {Token{"t2"s}, GameSession::Id{1u}, Dog::Id{0u}},
+};
+
+}  // namespace
+
+SCENARIO("Write-ahead log") {
+    const fs::path dir = fs::temp_directory_path() / "write-ahead-log-tests";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const fs::path log_path = dir / "state.wal";
+    const fs::path snapshot_path = dir / "state.bin";
+    const auto events = MakeEvents();
+
+    GIVEN("events appended to the log") {
+        {
+            WriteAheadLog log{log_path, 0, false};
+            for (size_t i = 0; i < events.size(); ++i) {
+                CHECK(log.Append(events[i]) == i + 1);
+            }
+            log.Flush();
+            CHECK(log.GetDurableSequence() == events.size());
+        }
+
+        THEN("they are read back in order") {
+            std::vector<uint64_t> sequences;
+            size_t moves = 0;
+            const auto last = ReadLog(log_path, [&](uint64_t sequence, const LogEvent& event) {
+                sequences.push_back(sequence);
+                moves += std::holds_alternative<MoveEvent>(event);
+            });
+            CHECK(last == events.size());
+            CHECK(sequences.size() == events.size());
+            CHECK(moves == 3);
+        }
+
+        WHEN("the last record is torn") {
+            fs::resize_file(log_path, fs::file_size(log_path) - 3);
+            WriteAheadLog log{log_path, 0, false};
+
+            THEN("it is discarded and numbering continues after the last whole record") {
+                CHECK(log.GetLastSequence() == events.size() - 1);
+                CHECK(log.Append(TickEvent{10ms}) == events.size());
+                log.Flush();
+                CHECK(ReadLog(log_path, [](uint64_t, const LogEvent&) {}) == events.size());
+            }
+        }
+
+        WHEN("a record in the middle is corrupted") {
+            const auto size = fs::file_size(log_path);
+            {
+                std::fstream stream{log_path, std::ios::in | std::ios::out | std::ios::binary};
+                // Поле первой записи за её заголовком
+                stream.seekp(20);
+                stream.put('\x7f');
+            }
+            THEN("the log is reported as corrupted and left intact") {
+                CHECK_THROWS_AS(ReadLog(log_path, [](uint64_t, const LogEvent&) {}), std::runtime_error);
+                CHECK_THROWS_AS(WriteAheadLog(log_path, 0, false), std::runtime_error);
+                CHECK(fs::file_size(log_path) == size);
+            }
+        }
+
+        WHEN("the size of a record in the middle is corrupted") {
+            const auto size = fs::file_size(log_path);
+            {
+                std::fstream stream{log_path, std::ios::in | std::ios::out | std::ios::binary};
+                // Старший байт размера первой записи: запись выходит за конец файла
+                stream.seekp(7);
+                stream.put('\x40');
+            }
+            THEN("it is not mistaken for a torn tail") {
+                CHECK_THROWS_AS(ReadLog(log_path, [](uint64_t, const LogEvent&) {}), std::runtime_error);
+                CHECK_THROWS_AS(WriteAheadLog(log_path, 0, false), std::runtime_error);
+                CHECK(fs::file_size(log_path) == size);
+            }
+        }
+
+        WHEN("the log is reopened after a snapshot newer than all its records") {
+            {
+                WriteAheadLog log{log_path, 20, false};
+                CHECK(log.Append(TickEvent{10ms}) == 21);
+            }
+            THEN("the covered records are dropped and numbering stays contiguous") {
+                std::vector<uint64_t> sequences;
+                ReadLog(log_path, [&sequences](uint64_t sequence, const LogEvent&) {
+                    sequences.push_back(sequence);
+                });
+                CHECK(sequences == std::vector<uint64_t>{21});
+            }
+        }
+
+        WHEN("the state is recovered without a snapshot") {
+            std::vector<GameSession> live;
+            std::vector<Player> players;
+            EventApplier applier{live, players};
+            for (const auto& event : events) {
+                CHECK(applier.Apply(event));
+            }
+            const auto recovered = RecoverState(snapshot_path, log_path);
+
+            THEN("it matches the live state") {
+                CHECK(recovered.log_sequence == events.size());
+                CHECK(recovered.replayed_events == events.size());
+                CheckEqual(live, recovered.sessions);
+                CHECK(recovered.players == EXPECTED_PLAYERS);
+                CHECK(players == EXPECTED_PLAYERS);
+            }
+        }
+    }
+
+    GIVEN("a snapshot taken in the middle of the log") {
+        std::vector<GameSession> live;
+        std::vector<Player> players;
+        EventApplier applier{live, players};
+        {
+            WriteAheadLog log{log_path, 0, false};
+            for (size_t i = 0; i < events.size(); ++i) {
+                const auto sequence = log.Append(events[i]);
+                applier.Apply(events[i]);
+                if (i == 5) {
+                    SaveSnapshotFile(snapshot_path, live, players, sequence);
+                    log.DiscardUpTo(sequence);
+                }
+            }
+            log.Flush();
+        }
+
+        THEN("records covered by the snapshot are discarded from the log") {
+            uint64_t first = 0;
+            ReadLog(log_path, [&first](uint64_t sequence, const LogEvent&) {
+                first = first == 0 ? sequence : first;
+            });
+            CHECK(first == 6);
+        }
+
+        THEN("recovery replays only the log tail") {
+            const auto recovered = RecoverState(snapshot_path, log_path);
+            CHECK(recovered.log_sequence == events.size());
+            CHECK(recovered.replayed_events == events.size() - 6);
+            CheckEqual(live, recovered.sessions);
+            CHECK(recovered.players == EXPECTED_PLAYERS);
+        }
+
+        WHEN("the log is reopened with the snapshot position") {
+            WriteAheadLog log{log_path, 6, false};
+            THEN("numbering continues") {
+                CHECK(log.GetLastSequence() == events.size());
+            }
+        }
+    }
+
+    GIVEN("a log whose write fails in the middle of a record") {
+        WriteAheadLog log{log_path, 0, false};
+        log.Append(TickEvent{10ms});
+        log.Flush();
+        const auto size = fs::file_size(log_path);
+        {
+            FileSizeLimit limit{size + 10};
+            const auto sequence = log.Append(
+                JoinEvent{GameSession::Id{0u}, MapId{"town"s}, Dog::Id{0u}, std::string(200, 'x'), {0, 0}, 3, Token{"t0"s}});
+            CHECK_THROWS_AS(log.WaitDurable(sequence), std::runtime_error);
+        }
+
+        THEN("the torn record is cut off and the log stops accepting events") {
+            CHECK(fs::file_size(log_path) == size);
+            CHECK(log.GetDurableSequence() == 1);
+            CHECK_THROWS_AS(log.Append(TickEvent{10ms}), std::runtime_error);
+            CHECK_THROWS_AS(log.WaitDurable(2), std::runtime_error);
+            CHECK(ReadLog(log_path, [](uint64_t, const LogEvent&) {}) == 1);
+        }
+    }
+
+    GIVEN("an event for a missing dog") {
+        std::vector<GameSession> sessions;
+        std::vector<Player> players;
+        EventApplier applier{sessions, players};
+        THEN("it is not applied") {
+            CHECK_FALSE(applier.Apply(MoveEvent{GameSession::Id{0u}, Dog::Id{5u}, Direction::EAST, {1, 0}}));
+            CHECK_FALSE(applier.Apply(RetireEvent{GameSession::Id{0u}, Dog::Id{5u}}));
+        }
+    }
+
+    fs::remove_all(dir);
+}